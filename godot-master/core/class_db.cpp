@@ -263,6 +263,8 @@ ClassDB::ClassInfo::ClassInfo() {
 	api = API_NONE;
 	creation_func = NULL;
 	inherits_ptr = NULL;
+	flat_method_map = NULL;
+	flat_methods_version = 0;
 	disabled = false;
 	exposed = false;
 }
@@ -671,20 +673,104 @@ void ClassDB::get_method_list(StringName p_class, List<MethodInfo> *p_methods, b
 	}
 }
 
+void ClassDB::_flatten_methods(ClassInfo *p_class) {
+
+	uint32_t count = 0;
+	for (ClassInfo *type = p_class; type; type = type->inherits_ptr) {
+		count += type->method_map.size();
+	}
+
+	if (p_class->flat_method_map) {
+		memdelete(p_class->flat_method_map);
+	}
+	p_class->flat_method_map = memnew(FlatMethodMap(next_power_of_2(count + count / 2 + 1)));
+
+	// Walk from the class up, so overrides shadow the methods they replace.
+	for (ClassInfo *type = p_class; type; type = type->inherits_ptr) {
+
+		const StringName *K = NULL;
+		while ((K = type->method_map.next(K))) {
+			MethodBind *method = type->method_map[*K];
+			if (method && !p_class->flat_method_map->has(*K)) {
+				p_class->flat_method_map->insert(*K, method);
+			}
+		}
+	}
+
+	p_class->flat_methods_version = methods_version;
+}
+
 MethodBind *ClassDB::get_method(StringName p_class, StringName p_name) {
 
-	OBJTYPE_RLOCK;
+	{
+		OBJTYPE_RLOCK;
+
+		ClassInfo *type = classes.getptr(p_class);
+		if (!type)
+			return NULL;
+
+		if (type->flat_method_map && type->flat_methods_version == methods_version) {
+			MethodBind *method = NULL;
+			type->flat_method_map->lookup(p_name, method);
+			return method;
+		}
+	}
+
+	OBJTYPE_WLOCK;
 
 	ClassInfo *type = classes.getptr(p_class);
+	ERR_FAIL_COND_V(!type, NULL);
 
-	while (type) {
+	if (!type->flat_method_map || type->flat_methods_version != methods_version) {
+		_flatten_methods(type);
+	}
 
-		MethodBind **method = type->method_map.getptr(p_name);
-		if (method && *method)
-			return *method;
-		type = type->inherits_ptr;
+	MethodBind *method = NULL;
+	type->flat_method_map->lookup(p_name, method);
+	return method;
+}
+
+const ClassDB::MethodLookup *ClassDB::get_method_lookup(const StringName &p_class, const StringName &p_name) {
+
+	MethodBind *method = get_method(p_class, p_name);
+	if (!method)
+		return NULL;
+
+	{
+		OBJTYPE_RLOCK;
+
+		ClassInfo *type = classes.getptr(p_class);
+		if (!type)
+			return NULL;
+
+		MethodLookup **E = type->method_lookups.getptr(p_name);
+		if (E && (*E)->method == method && (*E)->version == methods_version) {
+			return *E;
+		}
+	}
+
+	OBJTYPE_WLOCK;
+
+	ClassInfo *type = classes.getptr(p_class);
+	ERR_FAIL_COND_V(!type, NULL);
+
+	MethodLookup **E = type->method_lookups.getptr(p_name);
+	if (E && (*E)->method == method && (*E)->version == methods_version) {
+		return *E;
+	}
+
+	// Call sites may still point to the old one, keep it around until cleanup.
+	if (E) {
+		retired_method_lookups.push_back(*E);
 	}
-	return NULL;
+
+	MethodLookup *lookup = memnew(MethodLookup);
+	lookup->class_name = p_class;
+	lookup->method = method;
+	lookup->version = methods_version;
+	type->method_lookups[p_name] = lookup;
+
+	return lookup;
 }
 
 void ClassDB::bind_integer_constant(const StringName &p_class, const StringName &p_enum, const StringName &p_name, int p_constant) {
@@ -1270,6 +1356,7 @@ MethodBind *ClassDB::bind_methodfi(uint32_t p_flags, MethodBind *p_bind, const c
 #endif
 
 	type->method_map[mdname] = p_bind;
+	methods_version++;
 
 	Vector<Variant> defvals;
 
@@ -1450,6 +1537,8 @@ Variant ClassDB::class_get_default_property_value(const StringName &p_class, con
 }
 
 RWLock *ClassDB::lock = NULL;
+std::atomic<uint32_t> ClassDB::methods_version(1);
+List<ClassDB::MethodLookup *> ClassDB::retired_method_lookups;
 
 void ClassDB::init() {
 
@@ -1477,8 +1566,23 @@ void ClassDB::cleanup() {
 
 			memdelete(ti.method_map[*m]);
 		}
+
+		if (ti.flat_method_map) {
+			memdelete(ti.flat_method_map);
+		}
+
+		m = NULL;
+		while ((m = ti.method_lookups.next(m))) {
+
+			memdelete(ti.method_lookups[*m]);
+		}
 	}
 	classes.clear();
+
+	while (retired_method_lookups.size()) {
+		memdelete(retired_method_lookups.front()->get());
+		retired_method_lookups.pop_front();
+	}
 	resource_base_extensions.clear();
 	compat_classes.clear();
 
@@ -32,9 +32,12 @@
 #define CLASS_DB_H
 
 #include "core/method_bind.h"
+#include "core/oa_hash_map.h"
 #include "core/object.h"
 #include "core/print_string.h"
 
+#include <atomic>
+
 /**	To bind more then 6 parameters include this:
  *  #include "core/method_bind_ext.gen.inc"
  */
@@ -110,12 +113,26 @@ public:
 		Variant::Type type;
 	};
 
+	typedef OAHashMap<StringName, MethodBind *> FlatMethodMap;
+
+	// Resolved method for one class. Never freed before cleanup(), so call
+	// sites can keep a pointer to it (see MethodCallCache).
+	struct MethodLookup {
+
+		StringName class_name;
+		MethodBind *method;
+		uint32_t version;
+	};
+
 	struct ClassInfo {
 
 		APIType api;
 		ClassInfo *inherits_ptr;
 		void *class_ptr;
 		HashMap<StringName, MethodBind *> method_map;
+		FlatMethodMap *flat_method_map; // own and inherited methods, built on first lookup
+		uint32_t flat_methods_version;
+		HashMap<StringName, MethodLookup *> method_lookups;
 		HashMap<StringName, int> constant_map;
 		HashMap<StringName, List<StringName> > enum_map;
 		HashMap<StringName, MethodInfo> signal_map;
@@ -145,6 +162,10 @@ public:
 
 	static RWLock *lock;
 	static HashMap<StringName, ClassInfo> classes;
+	static std::atomic<uint32_t> methods_version; // bumped under the write lock, read without it by call sites
+	static List<MethodLookup *> retired_method_lookups;
+
+	static void _flatten_methods(ClassInfo *p_class);
 	static HashMap<StringName, StringName> resource_base_extensions;
 	static HashMap<StringName, StringName> compat_classes;
 
@@ -363,6 +384,10 @@ public:
 
 	static void get_method_list(StringName p_class, List<MethodInfo> *p_methods, bool p_no_inheritance = false, bool p_exclude_from_properties = false);
 	static MethodBind *get_method(StringName p_class, StringName p_name);
+	static const MethodLookup *get_method_lookup(const StringName &p_class, const StringName &p_name);
+	_FORCE_INLINE_ static bool is_method_lookup_valid(const MethodLookup *p_lookup, const StringName &p_class) {
+		return p_lookup && p_lookup->class_name == p_class && p_lookup->version == methods_version.load(std::memory_order_acquire);
+	}
 
 	static void add_virtual_method(const StringName &p_class, const MethodInfo &p_method, bool p_virtual = true);
 	static void get_virtual_methods(const StringName &p_class, List<MethodInfo> *p_methods, bool p_no_inheritance = false);
@@ -397,6 +422,17 @@ public:
 	static void cleanup();
 };
 
+// Inline cache for a call site that keeps calling the same method name,
+// usually on objects of the same class. Used by Object::call_cached().
+struct MethodCallCache {
+
+	std::atomic<const ClassDB::MethodLookup *> lookup;
+
+	MethodCallCache() :
+			lookup(NULL) {
+	}
+};
+
 #ifdef DEBUG_METHODS_ENABLED
 
 #define BIND_CONSTANT(m_constant) \
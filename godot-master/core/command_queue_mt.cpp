@@ -32,18 +32,6 @@
 
 #include "core/os/os.h"
 
-void CommandQueueMT::lock() {
-
-	if (mutex)
-		mutex->lock();
-}
-
-void CommandQueueMT::unlock() {
-
-	if (mutex)
-		mutex->unlock();
-}
-
 void CommandQueueMT::wait_for_flush() {
 
 	// wait one millisecond for a flush to happen
@@ -52,61 +40,30 @@ void CommandQueueMT::wait_for_flush() {
 
 CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 
-	int idx = -1;
+	sync_count.fetch_add(1, std::memory_order_relaxed);
 
 	while (true) {
 
-		lock();
 		for (int i = 0; i < SYNC_SEMAPHORES; i++) {
 
-			if (!sync_sems[i].in_use) {
-				sync_sems[i].in_use = true;
-				idx = i;
-				break;
+			if (!sync_sems[i].in_use.load(std::memory_order_relaxed) && !sync_sems[i].in_use.exchange(true, std::memory_order_acquire)) {
+				return &sync_sems[i];
 			}
 		}
-		unlock();
 
-		if (idx == -1) {
-			wait_for_flush();
-		} else {
-			break;
-		}
+		wait_for_flush();
 	}
-
-	return &sync_sems[idx];
-}
-
-bool CommandQueueMT::dealloc_one() {
-tryagain:
-	if (dealloc_ptr == write_ptr) {
-		// The queue is empty
-		return false;
-	}
-
-	uint32_t size = *(uint32_t *)&command_mem[dealloc_ptr];
-
-	if (size == 0) {
-		// End of command buffer wrap down
-		dealloc_ptr = 0;
-		goto tryagain;
-	}
-
-	if (size & 1) {
-		// Still used, nothing can be deallocated
-		return false;
-	}
-
-	dealloc_ptr += (size >> 1) + 8;
-	return true;
 }
 
-CommandQueueMT::CommandQueueMT(bool p_sync) {
+CommandQueueMT::CommandQueueMT(bool p_sync) :
+		write_ptr(0),
+		sync_count(0),
+		dealloc_ptr(0),
+		consumer_waiting(false) {
 
+	write_pos = 0;
+	dealloc_cache = 0;
 	read_ptr = 0;
-	write_ptr = 0;
-	dealloc_ptr = 0;
-	mutex = Mutex::create();
 	command_mem = (uint8_t *)memalloc(COMMAND_MEM_SIZE);
 
 	for (int i = 0; i < SYNC_SEMAPHORES; i++) {
@@ -124,7 +81,6 @@ CommandQueueMT::~CommandQueueMT() {
 
 	if (sync)
 		memdelete(sync);
-	memdelete(mutex);
 	for (int i = 0; i < SYNC_SEMAPHORES; i++) {
 
 		memdelete(sync_sems[i].sem);
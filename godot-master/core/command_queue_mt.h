@@ -35,8 +35,11 @@
 #include "core/os/mutex.h"
 #include "core/os/semaphore.h"
 #include "core/simple_type.h"
+#include "core/spin_lock.h"
 #include "core/typedefs.h"
 
+#include <atomic>
+
 #define COMMA(N) _COMMA_##N
 #define _COMMA_0
 #define _COMMA_1 ,
@@ -252,8 +255,7 @@
 		cmd->instance = p_instance;                                          \
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
-		unlock();                                                            \
-		if (sync) sync->post();                                              \
+		commit_and_unlock();                                                 \
 	}
 
 #define CMD_RET_TYPE(N) CommandRet##N<T, M, COMMA_SEP_LIST(TYPE_ARG, N) COMMA(N) R>
@@ -268,8 +270,7 @@
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                                   \
 		cmd->ret = r_ret;                                                                      \
 		cmd->sync_sem = ss;                                                                    \
-		unlock();                                                                              \
-		if (sync) sync->post();                                                                \
+		commit_and_unlock();                                                                   \
 		ss->sem->wait();                                                                       \
 		ss->in_use = false;                                                                    \
 	}
@@ -285,8 +286,7 @@
 		cmd->method = p_method;                                                       \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
 		cmd->sync_sem = ss;                                                           \
-		unlock();                                                                     \
-		if (sync) sync->post();                                                       \
+		commit_and_unlock();                                                          \
 		ss->sem->wait();                                                              \
 		ss->in_use = false;                                                           \
 	}
@@ -298,7 +298,7 @@ class CommandQueueMT {
 	struct SyncSemaphore {
 
 		SemaphoreOld *sem;
-		bool in_use;
+		std::atomic<bool> in_use;
 	};
 
 	struct CommandBase {
@@ -333,17 +333,44 @@ class CommandQueueMT {
 	enum {
 		COMMAND_MEM_SIZE_KB = 256,
 		COMMAND_MEM_SIZE = COMMAND_MEM_SIZE_KB * 1024,
-		SYNC_SEMAPHORES = 8
+		SYNC_SEMAPHORES = 8,
+		CACHE_LINE_SIZE = 64
 	};
 
+	// Single consumer ring buffer. Producers are serialized by write_lock and
+	// never share a lock with the consumer: a command becomes visible when
+	// write_ptr is published, and its memory is handed back when the consumer
+	// publishes dealloc_ptr past it.
+
 	uint8_t *command_mem;
-	uint32_t read_ptr;
-	uint32_t write_ptr;
-	uint32_t dealloc_ptr;
 	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
-	Mutex *mutex;
 	SemaphoreOld *sync;
 
+	uint8_t _pad_producer[CACHE_LINE_SIZE];
+
+	SpinLock write_lock;
+	std::atomic<uint32_t> write_ptr;
+	uint32_t write_pos; // not yet published
+	uint32_t dealloc_cache; // last dealloc_ptr seen by the producers
+	std::atomic<uint64_t> sync_count;
+
+	uint8_t _pad_consumer[CACHE_LINE_SIZE];
+
+	std::atomic<uint32_t> dealloc_ptr;
+	std::atomic<bool> consumer_waiting;
+	uint32_t read_ptr;
+
+	uint8_t _pad_end[CACHE_LINE_SIZE];
+
+	_FORCE_INLINE_ bool _refresh_dealloc() {
+
+		uint32_t dealloc = dealloc_ptr.load(std::memory_order_acquire);
+		if (dealloc == dealloc_cache)
+			return false;
+		dealloc_cache = dealloc;
+		return true;
+	}
+
 	template <class T>
 	T *allocate() {
 
@@ -352,12 +379,12 @@ class CommandQueueMT {
 
 	tryagain:
 
-		if (write_ptr < dealloc_ptr) {
+		if (write_pos < dealloc_cache) {
 			// behind dealloc_ptr, check that there is room
-			if ((dealloc_ptr - write_ptr) <= alloc_size) {
+			if ((dealloc_cache - write_pos) <= alloc_size) {
 
-				// There is no more room, try to deallocate something
-				if (dealloc_one()) {
+				// There is no more room, see if the consumer released something
+				if (_refresh_dealloc()) {
 					goto tryagain;
 				}
 				return NULL;
@@ -365,38 +392,36 @@ class CommandQueueMT {
 		} else {
 			// ahead of dealloc_ptr, check that there is room
 
-			if ((COMMAND_MEM_SIZE - write_ptr) < alloc_size + sizeof(uint32_t)) {
+			if ((COMMAND_MEM_SIZE - write_pos) < alloc_size + sizeof(uint32_t)) {
 				// no room at the end, wrap down;
 
-				if (dealloc_ptr == 0) { // don't want write_ptr to become dealloc_ptr
+				if (dealloc_cache == 0) { // don't want write_ptr to become dealloc_ptr
 
-					// There is no more room, try to deallocate something
-					if (dealloc_one()) {
+					// There is no more room, see if the consumer released something
+					if (_refresh_dealloc()) {
 						goto tryagain;
 					}
 					return NULL;
 				}
 
 				// if this happens, it's a bug
-				ERR_FAIL_COND_V((COMMAND_MEM_SIZE - write_ptr) < 8, NULL);
+				ERR_FAIL_COND_V((COMMAND_MEM_SIZE - write_pos) < 8, NULL);
 				// zero means, wrap to beginning
 
-				uint32_t *p = (uint32_t *)&command_mem[write_ptr];
+				uint32_t *p = (uint32_t *)&command_mem[write_pos];
 				*p = 0;
-				write_ptr = 0;
+				write_pos = 0;
 				goto tryagain;
 			}
 		}
-		// Allocate the size and the 'in use' bit.
-		// First bit used to mark if command is still in use (1)
-		// or if it has been destroyed and can be deallocated (0).
+		// Allocate the size, a zero size marks the wrap.
 		uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
-		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-		*p = (size << 1) | 1;
-		write_ptr += 8;
+		uint32_t *p = (uint32_t *)&command_mem[write_pos];
+		*p = size;
+		write_pos += 8;
 		// allocate the command
-		T *cmd = memnew_placement(&command_mem[write_ptr], T);
-		write_ptr += size;
+		T *cmd = memnew_placement(&command_mem[write_pos], T);
+		write_pos += size;
 		return cmd;
 	}
 
@@ -417,18 +442,28 @@ class CommandQueueMT {
 		return ret;
 	}
 
-	bool flush_one(bool p_lock = true) {
-		if (p_lock) lock();
+	_FORCE_INLINE_ void commit_and_unlock() {
+
+		write_ptr.store(write_pos, std::memory_order_release);
+		unlock();
+
+		// Only wake the consumer when it went to sleep, so a burst of pushes
+		// costs a single post.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sync && consumer_waiting.load(std::memory_order_relaxed) && consumer_waiting.exchange(false, std::memory_order_relaxed)) {
+			sync->post();
+		}
+	}
+
+	bool flush_one() {
 	tryagain:
 
 		// tried to read an empty queue
-		if (read_ptr == write_ptr) {
-			if (p_lock) unlock();
+		if (read_ptr == write_ptr.load(std::memory_order_acquire)) {
 			return false;
 		}
 
-		uint32_t size_ptr = read_ptr;
-		uint32_t size = *(uint32_t *)&command_mem[read_ptr] >> 1;
+		uint32_t size = *(uint32_t *)&command_mem[read_ptr];
 
 		if (size == 0) {
 			//end of ringbuffer, wrap
@@ -442,23 +477,19 @@ class CommandQueueMT {
 
 		read_ptr += size;
 
-		if (p_lock) unlock();
 		cmd->call();
-		if (p_lock) lock();
-
 		cmd->post();
 		cmd->~CommandBase();
-		*(uint32_t *)&command_mem[size_ptr] &= ~1;
 
-		if (p_lock) unlock();
+		// give the memory back to the producers
+		dealloc_ptr.store(read_ptr, std::memory_order_release);
 		return true;
 	}
 
-	void lock();
-	void unlock();
+	_FORCE_INLINE_ void lock() { write_lock.lock(); }
+	_FORCE_INLINE_ void unlock() { write_lock.unlock(); }
 	void wait_for_flush();
 	SyncSemaphore *_alloc_sync_sem();
-	bool dealloc_one();
 
 public:
 	/* NORMAL PUSH COMMANDS */
@@ -473,19 +504,37 @@ public:
 	DECL_PUSH_AND_SYNC(0)
 	SPACE_SEP_LIST(DECL_PUSH_AND_SYNC, 15)
 
-	void wait_and_flush_one() {
+	// Waits until commands are pushed, then runs everything that is pending.
+	// Must only be called from the consumer thread.
+	void wait_and_flush() {
 		ERR_FAIL_COND(!sync);
-		sync->wait();
-		flush_one();
+
+		if (flush_one()) {
+			while (flush_one())
+				;
+			return;
+		}
+
+		consumer_waiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (read_ptr == write_ptr.load(std::memory_order_relaxed)) {
+			sync->wait();
+		}
+		consumer_waiting.store(false, std::memory_order_relaxed);
+
+		while (flush_one())
+			;
 	}
 
 	void flush_all() {
 
-		//ERR_FAIL_COND(sync);
-		lock();
-		while (flush_one(false))
+		while (flush_one())
 			;
-		unlock();
+	}
+
+	// Number of push_and_ret() and push_and_sync() round trips so far.
+	uint64_t get_sync_count() const {
+		return sync_count.load(std::memory_order_relaxed);
 	}
 
 	CommandQueueMT(bool p_sync);
@@ -30,23 +30,269 @@
 
 #include "message_queue.h"
 
+#include "core/os/os.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
 
 MessageQueue *MessageQueue::singleton = NULL;
 
+thread_local MessageQueue::ThreadBuffer MessageQueue::thread_buffer;
+thread_local bool MessageQueue::thread_buffer_dead = false;
+uint32_t MessageQueue::generation = 0;
+
+MessageQueue::ThreadBuffer::~ThreadBuffer() {
+
+	// The thread is exiting, let flush() free its buffer once it is drained.
+	if (buffer && singleton && generation == MessageQueue::generation)
+		buffer->orphaned.store(true, std::memory_order_release);
+
+	// Other thread_local destructors may still push from this thread, they
+	// must not touch the orphaned buffer, flush() may free it at any time.
+	buffer = NULL;
+	thread_buffer_dead = true;
+}
+
 MessageQueue *MessageQueue::get_singleton() {
 
 	return singleton;
 }
 
-Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
+MessageQueue::Buffer *MessageQueue::_get_thread_buffer() {
+
+	if (likely(thread_buffer.buffer && thread_buffer.generation == generation))
+		return thread_buffer.buffer;
+
+	if (unlikely(thread_buffer_dead))
+		return shared_buffer;
+
+	// First push from this thread, register its buffer. New buffers are only
+	// added at the head and only flush() unlinks them, so it can walk the list
+	// without locking.
+	Buffer *buffer = memnew(Buffer);
+
+	_THREAD_SAFE_LOCK_
+	buffer->next = buffers.load(std::memory_order_relaxed);
+	buffers.store(buffer, std::memory_order_release);
+	_THREAD_SAFE_UNLOCK_
+
+	thread_buffer.buffer = buffer;
+	thread_buffer.generation = generation;
+	return buffer;
+}
+
+void MessageQueue::_unlink_buffer(Buffer *p_buffer) {
 
 	_THREAD_SAFE_METHOD_
 
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+	Buffer *prev = NULL;
+	Buffer *buffer = buffers.load(std::memory_order_relaxed);
+	while (buffer != p_buffer) {
+		prev = buffer;
+		buffer = buffer->next;
+	}
+
+	if (prev)
+		prev->next = p_buffer->next;
+	else
+		buffers.store(p_buffer->next, std::memory_order_release);
+}
+
+MessageQueue::Chunk *MessageQueue::_alloc_chunk(uint32_t p_min_size) {
+
+	_THREAD_SAFE_METHOD_
+
+	uint32_t size = MAX(chunk_size, p_min_size);
+	if (chunk_bytes_used + size > buffer_size)
+		return NULL;
+
+	chunk_bytes_used += size;
+
+	Chunk *chunk;
+	if (size == chunk_size && free_chunks) {
+		chunk = free_chunks;
+		free_chunks = chunk->next.load(std::memory_order_relaxed);
+	} else {
+		chunk = (Chunk *)memalloc(((sizeof(Chunk) + 15) & ~15) + size);
+		ERR_FAIL_COND_V(!chunk, NULL);
+	}
+
+	memnew_placement(chunk, Chunk);
+	chunk->size = size;
+	return chunk;
+}
+
+void MessageQueue::_free_chunk(Chunk *p_chunk) {
+
+	_THREAD_SAFE_METHOD_
+
+	chunk_bytes_used -= p_chunk->size;
+
+	if (p_chunk->size == chunk_size) {
+		p_chunk->next.store(free_chunks, std::memory_order_relaxed);
+		free_chunks = p_chunk;
+	} else {
+		p_chunk->~Chunk();
+		memfree(p_chunk);
+	}
+}
+
+bool MessageQueue::_release_chunks(Buffer *p_buffer) {
+
+	p_buffer->lock.lock();
+
+	Chunk *chunk = p_buffer->read_chunk.load(std::memory_order_relaxed);
+	for (Chunk *c = chunk; c; c = c->next.load(std::memory_order_relaxed)) {
+		if (c->read_pos < c->end.load(std::memory_order_relaxed)) {
+			// Pushed to since it was found empty.
+			p_buffer->lock.unlock();
+			return false;
+		}
+	}
+
+	p_buffer->read_chunk.store(NULL, std::memory_order_relaxed);
+	p_buffer->write_chunk = NULL;
+	p_buffer->lock.unlock();
+
+	while (chunk) {
+		Chunk *next = chunk->next.load(std::memory_order_relaxed);
+		_free_chunk(chunk);
+		chunk = next;
+	}
+
+	return true;
+}
+
+MessageQueue::Message *MessageQueue::_begin_message(uint32_t p_size, Buffer *&r_buffer, Chunk *&r_chunk) {
+
+	Buffer *buffer = _get_thread_buffer();
+	buffer->lock.lock();
+
+	Chunk *chunk = buffer->write_chunk;
+
+	if (!chunk || chunk->end.load(std::memory_order_relaxed) + p_size > chunk->size) {
+
+		Chunk *new_chunk = _alloc_chunk(p_size);
+		if (!new_chunk) {
+			buffer->lock.unlock();
+			return NULL;
+		}
+
+		// Once the next chunk is linked, flush() may retire this one as soon as it is read.
+		if (chunk)
+			chunk->next.store(new_chunk, std::memory_order_release);
+		else
+			buffer->read_chunk.store(new_chunk, std::memory_order_release);
+
+		buffer->write_chunk = new_chunk;
+		chunk = new_chunk;
+	}
+
+	r_buffer = buffer;
+	r_chunk = chunk;
+	Message *msg = memnew_placement(chunk->data() + chunk->end.load(std::memory_order_relaxed), Message);
+	msg->sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+	return msg;
+}
+
+MessageQueue::Message *MessageQueue::_peek(Buffer *p_buffer) {
+
+	Chunk *chunk = p_buffer->read_chunk.load(std::memory_order_acquire);
+
+	while (chunk) {
+
+		if (chunk->read_pos < chunk->end.load(std::memory_order_acquire))
+			return (Message *)(chunk->data() + chunk->read_pos);
+
+		Chunk *next = chunk->next.load(std::memory_order_acquire);
+		if (!next && chunk->read_pos == 0)
+			return NULL;
+
+		// Everything in this chunk was dispatched and destroyed already. Take the
+		// buffer lock so the producer is not writing to it while it is recycled.
+		p_buffer->lock.lock();
+
+		if (chunk->read_pos < chunk->end.load(std::memory_order_relaxed)) {
+			p_buffer->lock.unlock();
+			return (Message *)(chunk->data() + chunk->read_pos);
+		}
+
+		next = chunk->next.load(std::memory_order_relaxed);
+		if (!next) {
+			// Last chunk, rewind it in place so the producer keeps reusing it.
+			// The global lock keeps statistics() from walking it meanwhile.
+			_THREAD_SAFE_LOCK_
+			chunk->read_pos = 0;
+			chunk->end.store(0, std::memory_order_relaxed);
+			_THREAD_SAFE_UNLOCK_
+			p_buffer->lock.unlock();
+			return NULL;
+		}
+
+		p_buffer->read_chunk.store(next, std::memory_order_relaxed);
+		p_buffer->lock.unlock();
+		_free_chunk(chunk);
+		chunk = next;
+	}
+
+	return NULL;
+}
+
+void MessageQueue::_dispatch(Message *p_message) {
+
+	Object *target = ObjectDB::get_instance(p_message->instance_id);
+
+	if (target != NULL) {
+
+		switch (p_message->type & FLAG_MASK) {
+			case TYPE_CALL: {
+
+				Variant *args = (Variant *)(p_message + 1);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+				// messages don't expect a return value
+
+				_call_function(target, p_message->target, args, p_message->args, p_message->type & FLAG_SHOW_ERROR);
+
+			} break;
+			case TYPE_NOTIFICATION: {
+
+				// messages don't expect a return value
+				target->notification(p_message->notification);
+
+			} break;
+			case TYPE_SET: {
+
+				Variant *arg = (Variant *)(p_message + 1);
+				// messages don't expect a return value
+				target->set(p_message->target, *arg);
+
+			} break;
+		}
+	}
+
+	_destroy_message(p_message);
+}
+
+void MessageQueue::_destroy_message(Message *p_message) {
+
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
+	}
+
+	p_message->~Message();
+}
+
+Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
+
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+
+	Buffer *buffer;
+	Chunk *chunk;
+	Message *msg = _begin_message(room_needed, buffer, chunk);
+
+	if (!msg) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
@@ -55,7 +301,6 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const V
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
 	msg->args = p_argcount;
 	msg->instance_id = p_id;
 	msg->target = p_method;
@@ -63,15 +308,15 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const V
 	if (p_show_error)
 		msg->type |= FLAG_SHOW_ERROR;
 
-	buffer_end += sizeof(Message);
-
+	Variant *args = (Variant *)(msg + 1);
 	for (int i = 0; i < p_argcount; i++) {
 
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
+		Variant *v = memnew_placement(&args[i], Variant);
 		*v = *p_args[i];
 	}
 
+	_end_message(buffer, chunk, room_needed);
+
 	return OK;
 }
 
@@ -92,11 +337,13 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
 
-	_THREAD_SAFE_METHOD_
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant);
 
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
+	Buffer *buffer;
+	Chunk *chunk;
+	Message *msg = _begin_message(room_needed, buffer, chunk);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	if (!msg) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
@@ -105,43 +352,41 @@ Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Vari
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
 	msg->args = 1;
 	msg->instance_id = p_id;
 	msg->target = p_prop;
 	msg->type = TYPE_SET;
 
-	buffer_end += sizeof(Message);
-
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
+	Variant *v = memnew_placement(msg + 1, Variant);
 	*v = p_value;
 
+	_end_message(buffer, chunk, room_needed);
+
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
 
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
+	uint32_t room_needed = sizeof(Message);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	Buffer *buffer;
+	Chunk *chunk;
+	Message *msg = _begin_message(room_needed, buffer, chunk);
+
+	if (!msg) {
 		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
 		statistics();
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
-
 	msg->type = TYPE_NOTIFICATION;
 	msg->instance_id = p_id;
 	//msg->target;
 	msg->notification = p_notification;
 
-	buffer_end += sizeof(Message);
+	_end_message(buffer, chunk, room_needed);
 
 	return OK;
 }
@@ -167,55 +412,69 @@ void MessageQueue::statistics() {
 	Map<StringName, int> call_count;
 	int null_count = 0;
 
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
+	uint32_t total_bytes = 0;
 
-		Object *target = ObjectDB::get_instance(message->instance_id);
+	// Holding the lock keeps flush() from recycling chunks or freeing buffers while they are walked.
+	_THREAD_SAFE_LOCK_
 
-		if (target != NULL) {
+	for (Buffer *buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
 
-			switch (message->type & FLAG_MASK) {
+		for (Chunk *chunk = buffer->read_chunk.load(std::memory_order_acquire); chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
 
-				case TYPE_CALL: {
+			uint32_t read_pos = chunk->read_pos;
+			uint32_t end = chunk->end.load(std::memory_order_acquire);
+			total_bytes += end - read_pos;
 
-					if (!call_count.has(message->target))
-						call_count[message->target] = 0;
+			while (read_pos < end) {
+				Message *message = (Message *)(chunk->data() + read_pos);
 
-					call_count[message->target]++;
+				Object *target = ObjectDB::get_instance(message->instance_id);
 
-				} break;
-				case TYPE_NOTIFICATION: {
+				if (target != NULL) {
 
-					if (!notify_count.has(message->notification))
-						notify_count[message->notification] = 0;
+					switch (message->type & FLAG_MASK) {
 
-					notify_count[message->notification]++;
+						case TYPE_CALL: {
 
-				} break;
-				case TYPE_SET: {
+							if (!call_count.has(message->target))
+								call_count[message->target] = 0;
 
-					if (!set_count.has(message->target))
-						set_count[message->target] = 0;
+							call_count[message->target]++;
 
-					set_count[message->target]++;
+						} break;
+						case TYPE_NOTIFICATION: {
 
-				} break;
-			}
+							if (!notify_count.has(message->notification))
+								notify_count[message->notification] = 0;
 
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
+							notify_count[message->notification]++;
 
-			null_count++;
-		}
+						} break;
+						case TYPE_SET: {
+
+							if (!set_count.has(message->target))
+								set_count[message->target] = 0;
+
+							set_count[message->target]++;
+
+						} break;
+					}
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+				} else {
+					//object was deleted
+					print_line("Object was deleted while awaiting a callback");
+
+					null_count++;
+				}
+
+				read_pos += _get_message_size(message);
+			}
+		}
 	}
 
-	print_line("TOTAL BYTES: " + itos(buffer_end));
+	_THREAD_SAFE_UNLOCK_
+
+	print_line("TOTAL BYTES: " + itos(total_bytes));
 	print_line("NULL count: " + itos(null_count));
 
 	for (Map<StringName, int>::Element *E = set_count.front(); E; E = E->next()) {
@@ -236,6 +495,11 @@ int MessageQueue::get_max_buffer_usage() const {
 	return buffer_max_used;
 }
 
+uint64_t MessageQueue::get_last_flush_time_usec() const {
+
+	return last_flush_usec;
+}
+
 void MessageQueue::_call_function(Object *p_target, const StringName &p_func, const Variant *p_args, int p_argcount, bool p_show_error) {
 
 	const Variant **argptrs = NULL;
@@ -256,119 +520,165 @@ void MessageQueue::_call_function(Object *p_target, const StringName &p_func, co
 
 void MessageQueue::flush() {
 
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
-	}
-
-	uint32_t read_pos = 0;
-
-	//using reverse locking strategy
 	_THREAD_SAFE_LOCK_
+	bool already_flushing = flushing.load(std::memory_order_relaxed);
+	flushing.store(true, std::memory_order_relaxed);
+	_THREAD_SAFE_UNLOCK_
 
-	ERR_FAIL_COND(flushing); //already flushing, you did something odd
-	flushing = true;
-
-	while (read_pos < buffer_end) {
-
-		//lock on each iteration, so a call can re-add itself to the message queue
+	ERR_FAIL_COND(already_flushing); //already flushing, you did something odd
 
-		Message *message = (Message *)&buffer[read_pos];
+	uint64_t flush_begin = OS::get_singleton()->get_ticks_usec();
 
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			advance += sizeof(Variant) * message->args;
+	uint32_t pending = 0;
+	Buffer *buffer = buffers.load(std::memory_order_acquire);
+	while (buffer) {
 
-		//pre-advance so this function is reentrant
-		read_pos += advance;
+		Buffer *next = buffer->next;
 
-		_THREAD_SAFE_UNLOCK_
+		// Checked first, everything the thread pushed before exiting is visible after it.
+		bool orphaned = buffer->orphaned.load(std::memory_order_acquire);
 
-		Object *target = ObjectDB::get_instance(message->instance_id);
+		uint32_t buffer_pending = 0;
+		for (Chunk *chunk = buffer->read_chunk.load(std::memory_order_acquire); chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+			buffer_pending += chunk->end.load(std::memory_order_acquire) - chunk->read_pos;
+		}
+		pending += buffer_pending;
+
+		if (buffer_pending) {
+			buffer->idle = false;
+		} else if (orphaned) {
+			_unlink_buffer(buffer);
+			_release_chunks(buffer);
+			memdelete(buffer);
+		} else if (buffer->idle) {
+			// Nothing pushed since the previous flush either, don't keep chunks for it.
+			_release_chunks(buffer);
+		} else {
+			buffer->idle = true;
+		}
 
-		if (target != NULL) {
+		buffer = next;
+	}
 
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
+	if (pending > buffer_max_used) {
+		buffer_max_used = pending;
+	}
 
-					Variant *args = (Variant *)(message + 1);
+	Vector<Buffer *> active;
 
-					// messages don't expect a return value
+	while (true) {
 
-					_call_function(target, message->target, args, message->args, message->type & FLAG_SHOW_ERROR);
+		// Only the buffers holding messages take part in the merge. A buffer
+		// that was empty here only gets messages pushed after the ones being
+		// merged, so it joins in the next round.
+		active.clear();
+		for (buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+			if (_peek(buffer))
+				active.push_back(buffer);
+		}
 
-				} break;
-				case TYPE_NOTIFICATION: {
+		if (active.empty())
+			break;
 
-					// messages don't expect a return value
-					target->notification(message->notification);
+		while (true) {
 
-				} break;
-				case TYPE_SET: {
+			// Merge the active buffers in push order. Messages pushed to them while
+			// flushing (including by the calls below) are picked up in this same round.
+			Buffer *message_buffer = NULL;
+			Message *message = NULL;
 
-					Variant *arg = (Variant *)(message + 1);
-					// messages don't expect a return value
-					target->set(message->target, *arg);
+			for (int i = 0; i < active.size(); i++) {
 
-				} break;
+				Message *m = _peek(active[i]);
+				if (m && (!message || m->sequence < message->sequence)) {
+					message = m;
+					message_buffer = active[i];
+				}
 			}
-		}
 
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
-			}
-		}
+			if (!message)
+				break;
 
-		message->~Message();
+			//pre-advance so this function is reentrant
+			message_buffer->read_chunk.load(std::memory_order_relaxed)->read_pos += _get_message_size(message);
 
-		_THREAD_SAFE_LOCK_
+			_dispatch(message);
+		}
 	}
 
-	buffer_end = 0; // reset buffer
-	flushing = false;
+	last_flush_usec = OS::get_singleton()->get_ticks_usec() - flush_begin;
+
+	_THREAD_SAFE_LOCK_
+	flushing.store(false, std::memory_order_relaxed);
 	_THREAD_SAFE_UNLOCK_
 }
 
 bool MessageQueue::is_flushing() const {
 
-	return flushing;
+	return flushing.load(std::memory_order_relaxed);
 }
 
-MessageQueue::MessageQueue() {
+MessageQueue::MessageQueue() :
+		buffers(NULL),
+		sequence(0),
+		flushing(false) {
 
 	ERR_FAIL_COND_MSG(singleton != NULL, "MessageQueue singleton already exist.");
 	singleton = this;
-	flushing = false;
 
-	buffer_end = 0;
+	// Invalidates thread buffers left over from a previous queue.
+	generation++;
+
+	shared_buffer = memnew(Buffer);
+	buffers.store(shared_buffer, std::memory_order_release);
+
+	free_chunks = NULL;
+	chunk_bytes_used = 0;
 	buffer_max_used = 0;
+	last_flush_usec = 0;
 	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "0,2048,1,or_greater"));
 	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
+	// Small limits still get at least one chunk per producing thread.
+	chunk_size = MIN((uint32_t)CHUNK_SIZE, buffer_size);
 }
 
 MessageQueue::~MessageQueue() {
 
-	uint32_t read_pos = 0;
+	Buffer *buffer = buffers.load(std::memory_order_acquire);
+
+	while (buffer) {
 
-	while (read_pos < buffer_end) {
+		Chunk *chunk = buffer->read_chunk.load(std::memory_order_acquire);
+		while (chunk) {
 
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++)
-				args[i].~Variant();
+			uint32_t read_pos = chunk->read_pos;
+			uint32_t end = chunk->end.load(std::memory_order_acquire);
+			while (read_pos < end) {
+
+				Message *message = (Message *)(chunk->data() + read_pos);
+				read_pos += _get_message_size(message);
+				_destroy_message(message);
+			}
+
+			Chunk *next = chunk->next.load(std::memory_order_acquire);
+			chunk->~Chunk();
+			memfree(chunk);
+			chunk = next;
 		}
-		message->~Message();
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+		Buffer *next = buffer->next;
+		memdelete(buffer);
+		buffer = next;
+	}
+
+	while (free_chunks) {
+
+		Chunk *next = free_chunks->next.load(std::memory_order_relaxed);
+		free_chunks->~Chunk();
+		memfree(free_chunks);
+		free_chunks = next;
 	}
 
 	singleton = NULL;
-	memdelete_arr(buffer);
 }
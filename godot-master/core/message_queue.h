@@ -33,6 +33,9 @@
 
 #include "core/object.h"
 #include "core/os/thread_safe.h"
+#include "core/spin_lock.h"
+
+#include <atomic>
 
 class MessageQueue {
 
@@ -40,7 +43,8 @@ class MessageQueue {
 
 	enum {
 
-		DEFAULT_QUEUE_SIZE_KB = 1024
+		DEFAULT_QUEUE_SIZE_KB = 1024,
+		CHUNK_SIZE = 16 * 1024
 	};
 
 	enum {
@@ -54,6 +58,7 @@ class MessageQueue {
 
 	struct Message {
 
+		uint64_t sequence;
 		ObjectID instance_id;
 		StringName target;
 		int16_t type;
@@ -63,16 +68,96 @@ class MessageQueue {
 		};
 	};
 
-	uint8_t *buffer;
-	uint32_t buffer_end;
+	// Messages are appended to a chunk until it is full, then the producer links
+	// a new one. flush() rewinds the last chunk once everything in it was read.
+	struct Chunk {
+
+		std::atomic<Chunk *> next;
+		std::atomic<uint32_t> end; // published bytes
+		uint32_t size;
+		uint32_t read_pos; // only used by flush()
+
+		_FORCE_INLINE_ uint8_t *data() { return (uint8_t *)this + ((sizeof(Chunk) + 15) & ~15); }
+
+		Chunk() :
+				next(NULL),
+				end(0),
+				size(0),
+				read_pos(0) {
+		}
+	};
+
+	// One per producing thread, so pushing never waits on other threads.
+	// Only the owning thread writes to it and only flush() reads from it.
+	// The lock is held while pushing, and by flush() only to rewind or
+	// release the chunks, so it is practically never contended.
+	struct Buffer {
+
+		SpinLock lock;
+		Chunk *write_chunk;
+		std::atomic<Chunk *> read_chunk;
+		std::atomic<bool> orphaned; // owning thread exited, flush() frees it once drained
+		bool idle; // was empty at the previous flush, only used by flush()
+		Buffer *next;
+
+		Buffer() :
+				write_chunk(NULL),
+				read_chunk(NULL),
+				orphaned(false),
+				idle(false),
+				next(NULL) {
+		}
+	};
+
+	// Marks the buffer orphaned when its thread exits.
+	struct ThreadBuffer {
+
+		Buffer *buffer;
+		uint32_t generation;
+
+		~ThreadBuffer();
+	};
+
+	static thread_local ThreadBuffer thread_buffer;
+	static thread_local bool thread_buffer_dead; // set by ~ThreadBuffer, trivially destructible so it stays readable
+	static uint32_t generation;
+
+	std::atomic<Buffer *> buffers;
+	Buffer *shared_buffer; // used by threads pushing after their ThreadBuffer was destroyed, the buffer lock serializes them
+	std::atomic<uint64_t> sequence;
+	Chunk *free_chunks;
+	uint32_t chunk_bytes_used; // only chunks given to buffers count against buffer_size
+	uint32_t chunk_size;
+
 	uint32_t buffer_max_used;
 	uint32_t buffer_size;
+	uint64_t last_flush_usec;
+
+	Buffer *_get_thread_buffer();
+	void _unlink_buffer(Buffer *p_buffer);
+	Chunk *_alloc_chunk(uint32_t p_min_size);
+	void _free_chunk(Chunk *p_chunk);
+	bool _release_chunks(Buffer *p_buffer);
+	Message *_begin_message(uint32_t p_size, Buffer *&r_buffer, Chunk *&r_chunk);
+	_FORCE_INLINE_ void _end_message(Buffer *p_buffer, Chunk *p_chunk, uint32_t p_size) {
+		p_chunk->end.store(p_chunk->end.load(std::memory_order_relaxed) + p_size, std::memory_order_release);
+		p_buffer->lock.unlock();
+	}
+	Message *_peek(Buffer *p_buffer);
+	void _dispatch(Message *p_message);
+	_FORCE_INLINE_ static uint32_t _get_message_size(const Message *p_message) {
+		uint32_t size = sizeof(Message);
+		if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION)
+			size += sizeof(Variant) * p_message->args;
+		return size;
+	}
+	static void _destroy_message(Message *p_message);
 
 	void _call_function(Object *p_target, const StringName &p_func, const Variant *p_args, int p_argcount, bool p_show_error);
 
 	static MessageQueue *singleton;
 
-	bool flushing;
+	std::atomic<bool> flushing;
 
 public:
 	static MessageQueue *get_singleton();
@@ -92,6 +177,7 @@ public:
 	bool is_flushing() const;
 
 	int get_max_buffer_usage() const;
+	uint64_t get_last_flush_time_usec() const;
 
 	MessageQueue();
 	~MessageQueue();
@@ -37,8 +37,11 @@
 #include "core/print_string.h"
 #include "core/resource.h"
 #include "core/script_language.h"
+#include "core/spin_lock.h"
 #include "core/translation.h"
 
+#include <atomic>
+
 #ifdef DEBUG_ENABLED
 
 struct _ObjectDebugLock {
@@ -926,6 +929,34 @@ Variant Object::call(const StringName &p_method, const Variant **p_args, int p_a
 	return ret;
 }
 
+Variant Object::call_cached(const StringName &p_method, MethodCallCache &r_cache, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+
+	if (script_instance || p_method == CoreStringNames::get_singleton()->_free) {
+		return call(p_method, p_args, p_argcount, r_error);
+	}
+
+	const StringName &class_name = get_class_name();
+	const ClassDB::MethodLookup *lookup = r_cache.lookup.load(std::memory_order_acquire);
+
+	if (unlikely(!ClassDB::is_method_lookup_valid(lookup, class_name))) {
+
+		if (_has_custom_call()) {
+			return call(p_method, p_args, p_argcount, r_error);
+		}
+
+		lookup = ClassDB::get_method_lookup(class_name, p_method);
+		if (!lookup) {
+			r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
+			return Variant();
+		}
+		r_cache.lookup.store(lookup, std::memory_order_release);
+	}
+
+	OBJ_DEBUG_LOCK
+	r_error.error = Variant::CallError::CALL_OK;
+	return lookup->method->call(this, p_args, p_argcount, r_error);
+}
+
 void Object::notification(int p_notification, bool p_reversed) {
 
 	_notificationv(p_notification, p_reversed);
@@ -1177,13 +1208,25 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 	OBJ_DEBUG_LOCK
 
-	Vector<const Variant *> bind_mem;
+	// Room for the arguments plus the largest set of binds, on the stack.
+	int max_binds = 0;
+	for (int i = 0; i < ssize; i++) {
+		max_binds = MAX(max_binds, slot_map.getv(i).conn.binds.size());
+	}
+	const Variant **bind_mem = NULL;
+	if (max_binds) {
+		bind_mem = (const Variant **)alloca(sizeof(Variant *) * (p_argcount + max_binds));
+		for (int j = 0; j < p_argcount; j++) {
+			bind_mem[j] = p_args[j];
+		}
+	}
 
 	Error err = OK;
 
 	for (int i = 0; i < ssize; i++) {
 
-		const Connection &c = slot_map.getv(i).conn;
+		const Signal::Slot &slot = slot_map.getv(i);
+		const Connection &c = slot.conn;
 
 		Object *target = ObjectDB::get_instance(slot_map.getk(i)._id);
 		if (!target) {
@@ -1196,17 +1239,12 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
-
-			for (int j = 0; j < p_argcount; j++) {
-				bind_mem.write[j] = p_args[j];
-			}
 			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem.write[p_argcount + j] = &c.binds[j];
+				bind_mem[p_argcount + j] = &c.binds[j];
 			}
 
-			args = (const Variant **)bind_mem.ptr();
-			argc = bind_mem.size();
+			args = bind_mem;
+			argc = p_argcount + c.binds.size();
 		}
 
 		if (c.flags & CONNECT_DEFERRED) {
@@ -1214,7 +1252,16 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 		} else {
 			Variant::CallError ce;
 			_emitting = true;
-			target->call(c.method, args, argc, ce);
+			if (slot.method_bind && !target->script_instance) {
+				// Native target, skip the script and method name lookups of Object::call().
+#ifdef DEBUG_ENABLED
+				_ObjectDebugLock _target_debug_lock(target);
+#endif
+				ce.error = Variant::CallError::CALL_OK;
+				slot.method_bind->call(target, args, argc, ce);
+			} else {
+				target->call(c.method, args, argc, ce);
+			}
 			_emitting = false;
 
 			if (ce.error != Variant::CallError::CALL_OK) {
@@ -1476,6 +1523,8 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 	conn.binds = p_binds;
 	slot.conn = conn;
 	slot.cE = p_to_object->connections.push_back(conn);
+	// targets overriding call() must always go through it
+	slot.method_bind = p_to_object->_has_custom_call() ? NULL : ClassDB::get_method(p_to_object->get_class_name(), p_to_method);
 	if (p_flags & CONNECT_REFERENCE_COUNTED) {
 		slot.reference_count = 1;
 	}
@@ -1994,54 +2043,492 @@ void postinitialize_handler(Object *p_object) {
 	p_object->_postinitialize();
 }
 
-HashMap<ObjectID, Object *> ObjectDB::instances;
-ObjectID ObjectDB::instance_counter = 1;
-HashMap<Object *, ObjectID, ObjectDB::ObjectPtrHash> ObjectDB::instance_checks;
+// Instance IDs pack a slot index in the low bits and the generation of that
+// slot above them, so an ID kept after its object died never resolves to a
+// newer object reusing the slot. Slots live in fixed-size chunks that are
+// never moved, which lets get_instance() read them without a lock.
+
+#define OBJECTDB_SLOT_BITS 24
+#define OBJECTDB_SLOT_MASK ((uint64_t(1) << OBJECTDB_SLOT_BITS) - 1)
+#define OBJECTDB_GENERATION_MASK ((uint64_t(1) << 38) - 1)
+#define OBJECTDB_CHUNK_BITS 12
+#define OBJECTDB_CHUNK_SIZE (1 << OBJECTDB_CHUNK_BITS)
+#define OBJECTDB_CHUNK_MASK (OBJECTDB_CHUNK_SIZE - 1)
+#define OBJECTDB_CHUNK_COUNT (1 << (OBJECTDB_SLOT_BITS - OBJECTDB_CHUNK_BITS))
+#define OBJECTDB_SLOT_BATCH 64
+#define OBJECTDB_SHARD_BITS 4
+#define OBJECTDB_SHARD_COUNT (1 << OBJECTDB_SHARD_BITS)
+#define OBJECTDB_PTR_TOMBSTONE ((Object *)1)
+
+struct ObjectDBSlot {
+	std::atomic<uint64_t> validator; // generation while in use, zero while free
+	std::atomic<Object *> object;
+	uint64_t generation;
+	uint32_t next_free; // index + 1, zero ends the list
+
+	ObjectDBSlot() :
+			validator(0),
+			object(NULL),
+			generation(0),
+			next_free(0) {
+	}
+};
+
+static std::atomic<ObjectDBSlot *> objectdb_chunks[OBJECTDB_CHUNK_COUNT];
+static SpinLock objectdb_slot_lock;
+static uint32_t objectdb_slot_free_list = 0;
+static uint32_t objectdb_slot_max = 0;
+static uint32_t objectdb_object_count = 0;
+static bool objectdb_finalized = false;
+
+// Plain data so the fast path is a TLS load without an init guard.
+struct ObjectDBSlotCache {
+	uint32_t free_list;
+	uint32_t free_count;
+};
+
+static thread_local ObjectDBSlotCache objectdb_slot_cache;
+
+static _FORCE_INLINE_ ObjectDBSlot *_objectdb_get_slot(uint32_t p_index) {
+	ObjectDBSlot *chunk = objectdb_chunks[p_index >> OBJECTDB_CHUNK_BITS].load(std::memory_order_acquire);
+	return chunk ? &chunk[p_index & OBJECTDB_CHUNK_MASK] : NULL;
+}
+
+static void _objectdb_flush_slot_cache() {
+
+	ObjectDBSlotCache &cache = objectdb_slot_cache;
+	if (objectdb_finalized || !cache.free_list) {
+		return;
+	}
+
+	objectdb_slot_lock.lock();
+	while (cache.free_list) {
+		uint32_t index = cache.free_list - 1;
+		ObjectDBSlot *slot = _objectdb_get_slot(index);
+		cache.free_list = slot->next_free;
+		slot->next_free = objectdb_slot_free_list;
+		objectdb_slot_free_list = index + 1;
+	}
+	cache.free_count = 0;
+	objectdb_slot_lock.unlock();
+}
+
+struct ObjectDBSlotCacheFlusher {
+	bool armed;
+	~ObjectDBSlotCacheFlusher() {
+		_objectdb_flush_slot_cache();
+	}
+};
+
+static thread_local ObjectDBSlotCacheFlusher objectdb_slot_cache_flusher;
+
+static void _objectdb_refill_slot_cache(ObjectDBSlotCache &r_cache) {
+
+	// Make sure the slots go back to the shared list when this thread exits.
+	objectdb_slot_cache_flusher.armed = true;
+
+	objectdb_slot_lock.lock();
+
+	for (int i = 0; i < OBJECTDB_SLOT_BATCH; i++) {
+
+		uint32_t index;
+		if (objectdb_slot_free_list) {
+			index = objectdb_slot_free_list - 1;
+			objectdb_slot_free_list = _objectdb_get_slot(index)->next_free;
+		} else {
+			if (objectdb_slot_max == (1 << OBJECTDB_SLOT_BITS)) {
+				break;
+			}
+			index = objectdb_slot_max++;
+			if ((index & OBJECTDB_CHUNK_MASK) == 0) {
+				objectdb_chunks[index >> OBJECTDB_CHUNK_BITS].store(memnew_arr(ObjectDBSlot, OBJECTDB_CHUNK_SIZE), std::memory_order_release);
+			}
+		}
+
+		_objectdb_get_slot(index)->next_free = r_cache.free_list;
+		r_cache.free_list = index + 1;
+		r_cache.free_count++;
+	}
+
+	objectdb_slot_lock.unlock();
+}
+
+// Pointer set for instance_validate(). Each shard is an open addressing table
+// written under the shard lock and read without one. A table replaced by a
+// rehash is retired with the current epoch, and freed once no lookup that
+// started before that epoch is still running (epoch based reclamation).
+
+struct ObjectDBPtrTable {
+	uint32_t capacity;
+	uint32_t used; // live entries and tombstones
+	uint32_t live;
+	std::atomic<Object *> *entries;
+	uint64_t retire_epoch;
+	ObjectDBPtrTable *retired;
+};
+
+struct ObjectDBPtrShard {
+	SpinLock lock;
+	std::atomic<ObjectDBPtrTable *> table;
+	ObjectDBPtrTable *retired;
+};
+
+// One per thread that validates pointers, reused after the thread exits. The
+// epoch is the one seen when the current lookup started, or zero between
+// lookups. Only the owning thread writes it, so lookups never contend.
+struct ObjectDBPtrReader {
+	std::atomic<uint64_t> epoch;
+	std::atomic<bool> in_use;
+	ObjectDBPtrReader *next;
+
+	ObjectDBPtrReader() :
+			epoch(0),
+			in_use(true),
+			next(NULL) {
+	}
+};
+
+static ObjectDBPtrShard objectdb_ptr_shards[OBJECTDB_SHARD_COUNT];
+static std::atomic<uint64_t> objectdb_ptr_epoch(1);
+static std::atomic<ObjectDBPtrReader *> objectdb_ptr_readers(NULL);
+static thread_local ObjectDBPtrReader *objectdb_ptr_reader = NULL;
+
+struct ObjectDBPtrReaderRelease {
+	bool armed;
+	~ObjectDBPtrReaderRelease() {
+		if (!objectdb_finalized && objectdb_ptr_reader) {
+			objectdb_ptr_reader->in_use.store(false, std::memory_order_release);
+		}
+	}
+};
+
+static thread_local ObjectDBPtrReaderRelease objectdb_ptr_reader_release;
+
+static ObjectDBPtrReader *_objectdb_ptr_get_reader() {
+
+	ObjectDBPtrReader *reader = objectdb_ptr_reader;
+	if (likely(reader)) {
+		return reader;
+	}
+
+	// Make sure the record can be reused when this thread exits.
+	objectdb_ptr_reader_release.armed = true;
+
+	for (reader = objectdb_ptr_readers.load(std::memory_order_acquire); reader; reader = reader->next) {
+		bool in_use = false;
+		if (!reader->in_use.load(std::memory_order_relaxed) && reader->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+			break;
+		}
+	}
+
+	if (!reader) {
+		reader = memnew(ObjectDBPtrReader);
+		reader->next = objectdb_ptr_readers.load(std::memory_order_relaxed);
+		while (!objectdb_ptr_readers.compare_exchange_weak(reader->next, reader, std::memory_order_release)) {
+		}
+	}
+
+	objectdb_ptr_reader = reader;
+	return reader;
+}
+
+static _FORCE_INLINE_ uint32_t _objectdb_ptr_hash(const Object *p_object) {
+	return HashMapHasherDefault::hash((uint64_t)p_object);
+}
+
+static ObjectDBPtrTable *_objectdb_ptr_table_create(uint32_t p_capacity) {
+
+	ObjectDBPtrTable *table = memnew(ObjectDBPtrTable);
+	table->capacity = p_capacity;
+	table->used = 0;
+	table->live = 0;
+	table->entries = memnew_arr(std::atomic<Object *>, p_capacity);
+	for (uint32_t i = 0; i < p_capacity; i++) {
+		table->entries[i].store(NULL, std::memory_order_relaxed);
+	}
+	table->retire_epoch = 0;
+	table->retired = NULL;
+	return table;
+}
+
+static void _objectdb_ptr_table_free(ObjectDBPtrTable *p_table) {
+
+	memdelete_arr(p_table->entries);
+	memdelete(p_table);
+}
+
+// Called with the shard lock held.
+static void _objectdb_ptr_reclaim(ObjectDBPtrShard &p_shard) {
+
+	// Pairs with the fence in instance_validate(), either the lookup shows up
+	// here or it already loaded the newer table.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	uint64_t oldest = UINT64_MAX;
+	for (ObjectDBPtrReader *reader = objectdb_ptr_readers.load(std::memory_order_acquire); reader; reader = reader->next) {
+		uint64_t epoch = reader->epoch.load(std::memory_order_acquire);
+		if (epoch && epoch < oldest) {
+			oldest = epoch;
+		}
+	}
+
+	ObjectDBPtrTable **prev = &p_shard.retired;
+	while (*prev) {
+		ObjectDBPtrTable *table = *prev;
+		if (table->retire_epoch < oldest) {
+			*prev = table->retired;
+			_objectdb_ptr_table_free(table);
+		} else {
+			prev = &table->retired;
+		}
+	}
+}
+
+static void _objectdb_ptr_table_place(ObjectDBPtrTable *p_table, Object *p_object, uint32_t p_hash) {
+
+	uint32_t mask = p_table->capacity - 1;
+	uint32_t pos = (p_hash >> OBJECTDB_SHARD_BITS) & mask;
+
+	while (true) {
+		Object *entry = p_table->entries[pos].load(std::memory_order_relaxed);
+		if (entry == NULL || entry == OBJECTDB_PTR_TOMBSTONE) {
+			p_table->entries[pos].store(p_object, std::memory_order_release);
+			if (entry == NULL) {
+				p_table->used++;
+			}
+			p_table->live++;
+			return;
+		}
+		pos = (pos + 1) & mask;
+	}
+}
+
+static void _objectdb_ptr_insert(Object *p_object) {
+
+	uint32_t hash = _objectdb_ptr_hash(p_object);
+	ObjectDBPtrShard &shard = objectdb_ptr_shards[hash & (OBJECTDB_SHARD_COUNT - 1)];
+
+	shard.lock.lock();
+
+	ObjectDBPtrTable *table = shard.table.load(std::memory_order_relaxed);
+
+	if (!table || (table->used + 1) * 4 > table->capacity * 3) {
+
+		// Grow when mostly live, otherwise rebuild at the same size to drop tombstones.
+		uint32_t capacity = 64;
+		if (table) {
+			capacity = (table->live + 1) * 2 > table->capacity ? table->capacity * 2 : table->capacity;
+		}
+
+		ObjectDBPtrTable *new_table = _objectdb_ptr_table_create(capacity);
+		if (table) {
+			for (uint32_t i = 0; i < table->capacity; i++) {
+				Object *entry = table->entries[i].load(std::memory_order_relaxed);
+				if (entry != NULL && entry != OBJECTDB_PTR_TOMBSTONE) {
+					_objectdb_ptr_table_place(new_table, entry, _objectdb_ptr_hash(entry));
+				}
+			}
+		}
+		shard.table.store(new_table, std::memory_order_release);
+
+		if (table) {
+			// Lookups that see this epoch or a later one only find the new table.
+			table->retire_epoch = objectdb_ptr_epoch.fetch_add(1);
+			table->retired = shard.retired;
+			shard.retired = table;
+		}
+
+		table = new_table;
+	}
+
+	_objectdb_ptr_table_place(table, p_object, hash);
+
+	if (shard.retired) {
+		_objectdb_ptr_reclaim(shard);
+	}
+
+	shard.lock.unlock();
+}
+
+static void _objectdb_ptr_erase(Object *p_object) {
+
+	uint32_t hash = _objectdb_ptr_hash(p_object);
+	ObjectDBPtrShard &shard = objectdb_ptr_shards[hash & (OBJECTDB_SHARD_COUNT - 1)];
+
+	shard.lock.lock();
+
+	// Every registered object was inserted, so the table exists.
+	ObjectDBPtrTable *table = shard.table.load(std::memory_order_relaxed);
+
+	uint32_t mask = table->capacity - 1;
+	uint32_t pos = (hash >> OBJECTDB_SHARD_BITS) & mask;
+
+	for (uint32_t i = 0; i < table->capacity; i++) {
+		Object *entry = table->entries[pos].load(std::memory_order_relaxed);
+		if (entry == p_object) {
+			table->entries[pos].store(OBJECTDB_PTR_TOMBSTONE, std::memory_order_release);
+			table->live--;
+			break;
+		}
+		if (entry == NULL) {
+			break;
+		}
+		pos = (pos + 1) & mask;
+	}
+
+	if (shard.retired) {
+		_objectdb_ptr_reclaim(shard);
+	}
+
+	shard.lock.unlock();
+}
+
+bool ObjectDB::instance_validate(Object *p_ptr) {
+
+	if (!p_ptr) {
+		return false;
+	}
+
+	uint32_t hash = _objectdb_ptr_hash(p_ptr);
+	ObjectDBPtrShard &shard = objectdb_ptr_shards[hash & (OBJECTDB_SHARD_COUNT - 1)];
+
+	// Announce the lookup so the table can't be freed under it, only this
+	// thread's own record is written.
+	ObjectDBPtrReader *reader = _objectdb_ptr_get_reader();
+	reader->epoch.store(objectdb_ptr_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	bool exists = false;
+	ObjectDBPtrTable *table = shard.table.load(std::memory_order_acquire);
+	if (table) {
+		uint32_t mask = table->capacity - 1;
+		uint32_t pos = (hash >> OBJECTDB_SHARD_BITS) & mask;
+		for (uint32_t i = 0; i < table->capacity; i++) {
+			Object *entry = table->entries[pos].load(std::memory_order_acquire);
+			if (entry == p_ptr) {
+				exists = true;
+				break;
+			}
+			if (entry == NULL) {
+				break;
+			}
+			pos = (pos + 1) & mask;
+		}
+	}
+
+	reader->epoch.store(0, std::memory_order_release);
+
+	return exists;
+}
+
 ObjectID ObjectDB::add_instance(Object *p_object) {
 
 	ERR_FAIL_COND_V(p_object->get_instance_id() != 0, 0);
 
-	rw_lock->write_lock();
-	ObjectID instance_id = ++instance_counter;
-	instances[instance_id] = p_object;
-	instance_checks[p_object] = instance_id;
+	ObjectDBSlotCache &cache = objectdb_slot_cache;
+	if (unlikely(!cache.free_list)) {
+		_objectdb_refill_slot_cache(cache);
+		ERR_FAIL_COND_V_MSG(!cache.free_list, 0, "ObjectDB is full, too many objects in use.");
+	}
+
+	uint32_t index = cache.free_list - 1;
+	ObjectDBSlot *slot = _objectdb_get_slot(index);
+	cache.free_list = slot->next_free;
+	cache.free_count--;
+
+	slot->generation = (slot->generation + 1) & OBJECTDB_GENERATION_MASK;
+	if (slot->generation == 0) {
+		slot->generation = 1;
+	}
+
+	slot->object.store(p_object, std::memory_order_relaxed);
+	slot->validator.store(slot->generation, std::memory_order_release);
 
-	rw_lock->write_unlock();
+	_objectdb_ptr_insert(p_object);
+	atomic_increment(&objectdb_object_count);
 
-	return instance_id;
+	return (slot->generation << OBJECTDB_SLOT_BITS) | index;
 }
 
 void ObjectDB::remove_instance(Object *p_object) {
 
-	rw_lock->write_lock();
+	ObjectID id = p_object->get_instance_id();
+	uint32_t index = id & OBJECTDB_SLOT_MASK;
+	ObjectDBSlot *slot = _objectdb_get_slot(index);
+
+	ERR_FAIL_COND(!slot || slot->validator.load(std::memory_order_relaxed) != (id >> OBJECTDB_SLOT_BITS));
+
+	_objectdb_ptr_erase(p_object);
+	atomic_decrement(&objectdb_object_count);
+
+	slot->validator.store(0, std::memory_order_release);
+	slot->object.store(NULL, std::memory_order_relaxed);
 
-	instances.erase(p_object->get_instance_id());
-	instance_checks.erase(p_object);
+	ObjectDBSlotCache &cache = objectdb_slot_cache;
+	slot->next_free = cache.free_list;
+	cache.free_list = index + 1;
+	cache.free_count++;
 
-	rw_lock->write_unlock();
+	if (unlikely(cache.free_count > OBJECTDB_SLOT_BATCH * 2)) {
+		// Hand a batch back so threads that only create objects keep getting slots.
+		objectdb_slot_lock.lock();
+		for (int i = 0; i < OBJECTDB_SLOT_BATCH; i++) {
+			uint32_t free_index = cache.free_list - 1;
+			ObjectDBSlot *free_slot = _objectdb_get_slot(free_index);
+			cache.free_list = free_slot->next_free;
+			free_slot->next_free = objectdb_slot_free_list;
+			objectdb_slot_free_list = free_index + 1;
+		}
+		objectdb_slot_lock.unlock();
+		cache.free_count -= OBJECTDB_SLOT_BATCH;
+	}
 }
+
 Object *ObjectDB::get_instance(ObjectID p_instance_id) {
 
-	rw_lock->read_lock();
-	Object **obj = instances.getptr(p_instance_id);
-	rw_lock->read_unlock();
+	uint64_t generation = p_instance_id >> OBJECTDB_SLOT_BITS;
+	if (generation == 0) {
+		return NULL;
+	}
+
+	ObjectDBSlot *slot = _objectdb_get_slot(p_instance_id & OBJECTDB_SLOT_MASK);
+	if (!slot || slot->validator.load(std::memory_order_acquire) != generation) {
+		return NULL;
+	}
+
+	Object *object = slot->object.load(std::memory_order_acquire);
 
-	if (!obj)
+	// The slot may have been freed and reused while reading it.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (slot->validator.load(std::memory_order_relaxed) != generation) {
 		return NULL;
-	return *obj;
+	}
+
+	return object;
+}
+
+static uint32_t _objectdb_get_slot_max() {
+
+	objectdb_slot_lock.lock();
+	uint32_t slot_max = objectdb_slot_max;
+	objectdb_slot_lock.unlock();
+	return slot_max;
 }
 
 void ObjectDB::debug_objects(DebugFunc p_func) {
 
-	rw_lock->read_lock();
+	uint32_t slot_max = _objectdb_get_slot_max();
 
-	const ObjectID *K = NULL;
-	while ((K = instances.next(K))) {
+	for (uint32_t i = 0; i < slot_max; i++) {
 
-		p_func(instances[*K]);
+		ObjectDBSlot *slot = _objectdb_get_slot(i);
+		if (slot && slot->validator.load(std::memory_order_acquire)) {
+			Object *object = slot->object.load(std::memory_order_acquire);
+			if (object) {
+				p_func(object);
+			}
+		}
 	}
-
-	rw_lock->read_unlock();
 }
 
 void Object::get_argument_options(const StringName &p_function, int p_idx, List<String> *r_options) const {
@@ -2049,41 +2536,75 @@ void Object::get_argument_options(const StringName &p_function, int p_idx, List<
 
 int ObjectDB::get_object_count() {
 
-	rw_lock->read_lock();
-	int count = instances.size();
-	rw_lock->read_unlock();
-
-	return count;
+	return objectdb_object_count;
 }
 
-RWLock *ObjectDB::rw_lock = NULL;
-
 void ObjectDB::setup() {
 
-	rw_lock = RWLock::create();
+	objectdb_finalized = false;
 }
 
 void ObjectDB::cleanup() {
 
-	rw_lock->write_lock();
-	if (instances.size()) {
+	if (objectdb_object_count) {
 
 		WARN_PRINT("ObjectDB Instances still exist!");
 		if (OS::get_singleton()->is_stdout_verbose()) {
-			const ObjectID *K = NULL;
-			while ((K = instances.next(K))) {
+			uint32_t slot_max = _objectdb_get_slot_max();
+			for (uint32_t i = 0; i < slot_max; i++) {
 
+				ObjectDBSlot *slot = _objectdb_get_slot(i);
+				if (!slot || !slot->validator.load()) {
+					continue;
+				}
+
+				Object *object = slot->object.load();
 				String node_name;
-				if (instances[*K]->is_class("Node"))
-					node_name = " - Node name: " + String(instances[*K]->call("get_name"));
-				if (instances[*K]->is_class("Resource"))
-					node_name = " - Resource name: " + String(instances[*K]->call("get_name")) + " Path: " + String(instances[*K]->call("get_path"));
-				print_line("Leaked instance: " + String(instances[*K]->get_class()) + ":" + itos(*K) + node_name);
+				if (object->is_class("Node"))
+					node_name = " - Node name: " + String(object->call("get_name"));
+				if (object->is_class("Resource"))
+					node_name = " - Resource name: " + String(object->call("get_name")) + " Path: " + String(object->call("get_path"));
+				print_line("Leaked instance: " + String(object->get_class()) + ":" + itos(object->get_instance_id()) + node_name);
 			}
 		}
 	}
-	instances.clear();
-	instance_checks.clear();
-	rw_lock->write_unlock();
-	memdelete(rw_lock);
+
+	objectdb_finalized = true;
+
+	for (int i = 0; i < OBJECTDB_SHARD_COUNT; i++) {
+		ObjectDBPtrShard &shard = objectdb_ptr_shards[i];
+		ObjectDBPtrTable *table = shard.table.load();
+		if (table) {
+			_objectdb_ptr_table_free(table);
+			shard.table.store(NULL);
+		}
+		while (shard.retired) {
+			table = shard.retired;
+			shard.retired = table->retired;
+			_objectdb_ptr_table_free(table);
+		}
+	}
+
+	ObjectDBPtrReader *reader = objectdb_ptr_readers.load();
+	while (reader) {
+		ObjectDBPtrReader *next = reader->next;
+		memdelete(reader);
+		reader = next;
+	}
+	objectdb_ptr_readers.store(NULL);
+	objectdb_ptr_reader = NULL;
+
+	for (int i = 0; i < OBJECTDB_CHUNK_COUNT; i++) {
+		ObjectDBSlot *chunk = objectdb_chunks[i].load();
+		if (chunk) {
+			memdelete_arr(chunk);
+			objectdb_chunks[i].store(NULL);
+		}
+	}
+
+	objectdb_slot_free_list = 0;
+	objectdb_slot_max = 0;
+	objectdb_object_count = 0;
+	objectdb_slot_cache.free_list = 0;
+	objectdb_slot_cache.free_count = 0;
 }
@@ -39,6 +39,8 @@
 #include "core/variant.h"
 #include "core/vmap.h"
 
+#include <type_traits>
+
 #define VARIANT_ARG_LIST const Variant &p_arg1 = Variant(), const Variant &p_arg2 = Variant(), const Variant &p_arg3 = Variant(), const Variant &p_arg4 = Variant(), const Variant &p_arg5 = Variant()
 #define VARIANT_ARG_PASS p_arg1, p_arg2, p_arg3, p_arg4, p_arg5
 #define VARIANT_ARG_DECLARE const Variant &p_arg1, const Variant &p_arg2, const Variant &p_arg3, const Variant &p_arg4, const Variant &p_arg5
@@ -256,6 +258,10 @@ public:                                                             \
                                                                     \
 private:
 
+// Only used through decltype() by GDCLASS, deduces the class that declares the call() a class uses.
+template <class T>
+T *_get_call_owner(Variant (T::*p_call)(const StringName &, const Variant **, int, Variant::CallError &));
+
 #define GDCLASS(m_class, m_inherits)                                                                                                    \
 private:                                                                                                                                \
 	void operator=(const m_class &p_rval) {}                                                                                            \
@@ -266,6 +272,9 @@ public:
 	virtual String get_class() const {                                                                                                  \
 		return String(#m_class);                                                                                                        \
 	}                                                                                                                                   \
+	virtual bool _has_custom_call() const {                                                                                             \
+		return !std::is_same<decltype(_get_call_owner(&m_class::call)), Object *>::value;                                               \
+	}                                                                                                                                   \
 	virtual const StringName *_get_class_namev() const {                                                                                \
 		if (!_class_name)                                                                                                               \
 			_class_name = get_class_static();                                                                                           \
@@ -397,6 +406,8 @@ public:                                                        \
 private:
 
 class ScriptInstance;
+class MethodBind;
+struct MethodCallCache;
 typedef uint64_t ObjectID;
 
 class Object {
@@ -460,7 +471,11 @@ private:
 			int reference_count;
 			Connection conn;
 			List<Connection>::Element *cE;
-			Slot() { reference_count = 0; }
+			MethodBind *method_bind; // resolved on connect, used when the target has no script and doesn't override call()
+			Slot() {
+				reference_count = 0;
+				method_bind = NULL;
+			}
 		};
 
 		MethodInfo user;
@@ -665,6 +680,8 @@ public:
 	void get_method_list(List<MethodInfo> *p_list) const;
 	Variant callv(const StringName &p_method, const Array &p_args);
 	virtual Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error);
+	Variant call_cached(const StringName &p_method, MethodCallCache &r_cache, const Variant **p_args, int p_argcount, Variant::CallError &r_error);
+	virtual bool _has_custom_call() const { return false; } // GDCLASS makes it return true when the class or a parent overrides call()
 	virtual void call_multilevel(const StringName &p_method, const Variant **p_args, int p_argcount);
 	virtual void call_multilevel_reversed(const StringName &p_method, const Variant **p_args, int p_argcount);
 	Variant call(const StringName &p_name, VARIANT_ARG_LIST); // C++ helper
@@ -757,29 +774,14 @@ public:
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
+// ObjectIDs are (generation << 24) | slot index. At most 2^24 (about 16.7
+// million) objects can be alive at once, and IDs are not sequential: a freed
+// slot is reused with the next generation, so stale IDs resolve to NULL.
 class ObjectDB {
 
-	struct ObjectPtrHash {
-
-		static _FORCE_INLINE_ uint32_t hash(const Object *p_obj) {
-
-			union {
-				const Object *p;
-				unsigned long i;
-			} u;
-			u.p = p_obj;
-			return HashMapHasherDefault::hash((uint64_t)u.i);
-		}
-	};
-
-	static HashMap<ObjectID, Object *> instances;
-	static HashMap<Object *, ObjectID, ObjectPtrHash> instance_checks;
-
-	static ObjectID instance_counter;
 	friend class Object;
 	friend void unregister_core_types();
 
-	static RWLock *rw_lock;
 	static void cleanup();
 	static ObjectID add_instance(Object *p_object);
 	static void remove_instance(Object *p_object);
@@ -793,15 +795,7 @@ public:
 	static void debug_objects(DebugFunc p_func);
 	static int get_object_count();
 
-	_FORCE_INLINE_ static bool instance_validate(Object *p_ptr) {
-		rw_lock->read_lock();
-
-		bool exists = instance_checks.has(p_ptr);
-
-		rw_lock->read_unlock();
-
-		return exists;
-	}
+	static bool instance_validate(Object *p_ptr);
 };
 
 //needed by macros
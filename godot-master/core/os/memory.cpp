@@ -33,6 +33,7 @@
 #include "core/error_macros.h"
 #include "core/os/copymem.h"
 #include "core/safe_refcount.h"
+#include "core/spin_lock.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -71,15 +72,244 @@ uint64_t Memory::max_usage = 0;
 
 uint64_t Memory::alloc_count = 0;
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+
+// Small blocks are carved out of large slabs and recycled through per-thread
+// free lists, so the common case never takes a lock nor calls malloc.
+// Block sizes include the PAD_ALIGN header, which is always present in this
+// mode so free_static() can find the size class of any pointer.
+// Slabs are never returned to the system.
+
+#define SMALL_OBJECT_CLASS_COUNT 12
+#define SMALL_OBJECT_BLOCK_MAX 512
+#define SMALL_OBJECT_SLAB_SIZE 65536
+#define SMALL_OBJECT_BATCH_BYTES 8192
+
+static const uint32_t small_object_block_sizes[SMALL_OBJECT_CLASS_COUNT] = { 32, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512 };
+
+struct SmallObjectBlock {
+	SmallObjectBlock *next;
+};
+
+struct SmallObjectDepot {
+	SpinLock lock;
+	SmallObjectBlock *free_list;
+	uint64_t free_count;
+	uint64_t reserved_blocks;
+	uint64_t alloc_count;
+};
+
+static SmallObjectDepot small_object_depots[SMALL_OBJECT_CLASS_COUNT];
+
+// Plain data, so accessing it compiles to a TLS load without any init guard.
+struct SmallObjectThreadCache {
+	SmallObjectBlock *free_list[SMALL_OBJECT_CLASS_COUNT];
+	uint32_t free_count[SMALL_OBJECT_CLASS_COUNT];
+	uint32_t alloc_count[SMALL_OBJECT_CLASS_COUNT];
+	bool flushed;
+};
+
+static thread_local SmallObjectThreadCache small_object_cache;
+
+static _FORCE_INLINE_ uint32_t _small_object_batch(int p_class) {
+	uint32_t batch = SMALL_OBJECT_BATCH_BYTES / small_object_block_sizes[p_class];
+	return batch < 8 ? 8 : batch;
+}
+
+static _FORCE_INLINE_ int _small_object_class(size_t p_size) {
+	int c = 0;
+	while (small_object_block_sizes[c] < p_size) {
+		c++;
+	}
+	return c;
+}
+
+// Moves up to p_count blocks from the depot into r_list. The depot must be locked.
+static uint32_t _small_object_take(SmallObjectDepot &p_depot, int p_class, uint32_t p_count, SmallObjectBlock *&r_list) {
+
+	if (p_depot.free_count == 0) {
+
+		uint8_t *slab = (uint8_t *)malloc(SMALL_OBJECT_SLAB_SIZE);
+		if (!slab) {
+			return 0;
+		}
+
+		uint32_t block_size = small_object_block_sizes[p_class];
+		uint32_t block_count = SMALL_OBJECT_SLAB_SIZE / block_size;
+
+		for (uint32_t i = 0; i < block_count; i++) {
+			SmallObjectBlock *block = (SmallObjectBlock *)(slab + i * block_size);
+			block->next = p_depot.free_list;
+			p_depot.free_list = block;
+		}
+
+		p_depot.free_count += block_count;
+		p_depot.reserved_blocks += block_count;
+	}
+
+	uint32_t taken = 0;
+	while (taken < p_count && p_depot.free_list) {
+		SmallObjectBlock *block = p_depot.free_list;
+		p_depot.free_list = block->next;
+		block->next = r_list;
+		r_list = block;
+		taken++;
+	}
+
+	p_depot.free_count -= taken;
+	return taken;
+}
+
+static void _small_object_flush_thread_cache();
+
+struct SmallObjectThreadCacheFlusher {
+	bool armed;
+	~SmallObjectThreadCacheFlusher() {
+		_small_object_flush_thread_cache();
+	}
+};
+
+static thread_local SmallObjectThreadCacheFlusher small_object_cache_flusher;
+
+static void _small_object_flush_thread_cache() {
+
+	SmallObjectThreadCache &cache = small_object_cache;
+
+	for (int c = 0; c < SMALL_OBJECT_CLASS_COUNT; c++) {
+
+		SmallObjectDepot &depot = small_object_depots[c];
+		depot.lock.lock();
+		while (cache.free_list[c]) {
+			SmallObjectBlock *block = cache.free_list[c];
+			cache.free_list[c] = block->next;
+			block->next = depot.free_list;
+			depot.free_list = block;
+		}
+		depot.free_count += cache.free_count[c];
+		depot.alloc_count += cache.alloc_count[c];
+		depot.lock.unlock();
+
+		cache.free_count[c] = 0;
+		cache.alloc_count[c] = 0;
+	}
+
+	// Allocations made after the thread-local destructors ran go straight to the depots.
+	cache.flushed = true;
+}
+
+static void *_small_object_alloc(int p_class) {
+
+	SmallObjectThreadCache &cache = small_object_cache;
+
+	if (unlikely(!cache.free_list[p_class])) {
+
+		SmallObjectDepot &depot = small_object_depots[p_class];
+
+		if (unlikely(cache.flushed)) {
+			SmallObjectBlock *block = NULL;
+			depot.lock.lock();
+			_small_object_take(depot, p_class, 1, block);
+			depot.alloc_count++;
+			depot.lock.unlock();
+			return block;
+		}
+
+		// Make sure this thread returns its blocks when it exits.
+		small_object_cache_flusher.armed = true;
+
+		depot.lock.lock();
+		cache.free_count[p_class] += _small_object_take(depot, p_class, _small_object_batch(p_class), cache.free_list[p_class]);
+		depot.alloc_count += cache.alloc_count[p_class];
+		depot.lock.unlock();
+
+		cache.alloc_count[p_class] = 0;
+
+		if (!cache.free_list[p_class]) {
+			return NULL;
+		}
+	}
+
+	SmallObjectBlock *block = cache.free_list[p_class];
+	cache.free_list[p_class] = block->next;
+	cache.free_count[p_class]--;
+	cache.alloc_count[p_class]++;
+
+	return block;
+}
+
+static void _small_object_free(void *p_block, int p_class) {
+
+	SmallObjectThreadCache &cache = small_object_cache;
+	SmallObjectBlock *block = (SmallObjectBlock *)p_block;
+	SmallObjectDepot &depot = small_object_depots[p_class];
+
+	if (unlikely(cache.flushed)) {
+		depot.lock.lock();
+		block->next = depot.free_list;
+		depot.free_list = block;
+		depot.free_count++;
+		depot.lock.unlock();
+		return;
+	}
+
+	if (unlikely(!cache.free_list[p_class])) {
+		// Threads that only free blocks allocated elsewhere must return them on exit too.
+		small_object_cache_flusher.armed = true;
+	}
+
+	block->next = cache.free_list[p_class];
+	cache.free_list[p_class] = block;
+	cache.free_count[p_class]++;
+
+	uint32_t batch = _small_object_batch(p_class);
+	if (unlikely(cache.free_count[p_class] > batch * 2)) {
+		// Hand a batch back so blocks freed on other threads can be reused.
+		depot.lock.lock();
+		for (uint32_t i = 0; i < batch; i++) {
+			SmallObjectBlock *b = cache.free_list[p_class];
+			cache.free_list[p_class] = b->next;
+			b->next = depot.free_list;
+			depot.free_list = b;
+		}
+		depot.free_count += batch;
+		depot.alloc_count += cache.alloc_count[p_class];
+		depot.lock.unlock();
+
+		cache.free_count[p_class] -= batch;
+		cache.alloc_count[p_class] = 0;
+	}
+}
+
+static _FORCE_INLINE_ void *_block_alloc(size_t p_size) {
+	if (p_size <= SMALL_OBJECT_BLOCK_MAX) {
+		return _small_object_alloc(_small_object_class(p_size));
+	}
+	return malloc(p_size);
+}
+
+static _FORCE_INLINE_ void _block_free(void *p_block, size_t p_size) {
+	if (p_size <= SMALL_OBJECT_BLOCK_MAX) {
+		_small_object_free(p_block, _small_object_class(p_size));
+	} else {
+		free(p_block);
+	}
+}
+
+#endif
+
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
 #endif
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	void *mem = _block_alloc(p_bytes + PAD_ALIGN);
+#else
 	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
+#endif
 
 	ERR_FAIL_COND_V(!mem, NULL);
 
@@ -109,7 +339,7 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_memory;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
@@ -119,6 +349,33 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 		mem -= PAD_ALIGN;
 		uint64_t *s = (uint64_t *)mem;
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+		size_t old_size = *s + PAD_ALIGN;
+		size_t new_size = p_bytes + PAD_ALIGN;
+		if (p_bytes != 0 && (old_size <= SMALL_OBJECT_BLOCK_MAX || new_size <= SMALL_OBJECT_BLOCK_MAX)) {
+
+			if (old_size <= SMALL_OBJECT_BLOCK_MAX && new_size <= SMALL_OBJECT_BLOCK_MAX && _small_object_class(old_size) == _small_object_class(new_size)) {
+#ifdef DEBUG_ENABLED
+				if (p_bytes > *s) {
+					atomic_add(&mem_usage, p_bytes - *s);
+					atomic_exchange_if_greater(&max_usage, mem_usage);
+				} else {
+					atomic_sub(&mem_usage, *s - p_bytes);
+				}
+#endif
+				*s = p_bytes;
+				return mem + PAD_ALIGN;
+			}
+
+			// Moving between a slab and the system heap, or between size classes.
+			uint8_t *new_mem = (uint8_t *)alloc_static(p_bytes, p_pad_align);
+			ERR_FAIL_COND_V(!new_mem, NULL);
+			copymem(new_mem, p_memory, MIN(*s, (uint64_t)p_bytes));
+			free_static(p_memory, p_pad_align);
+			return new_mem;
+		}
+#endif
+
 #ifdef DEBUG_ENABLED
 		if (p_bytes > *s) {
 			atomic_add(&mem_usage, p_bytes - *s);
@@ -129,7 +386,11 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 #endif
 
 		if (p_bytes == 0) {
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+			_block_free(mem, *s + PAD_ALIGN);
+#else
 			free(mem);
+#endif
 			return NULL;
 		} else {
 			*s = p_bytes;
@@ -159,7 +420,7 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_ptr;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
@@ -170,12 +431,18 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 	if (prepad) {
 		mem -= PAD_ALIGN;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
 		uint64_t *s = (uint64_t *)mem;
+#endif
+#ifdef DEBUG_ENABLED
 		atomic_sub(&mem_usage, *s);
 #endif
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+		_block_free(mem, *s + PAD_ALIGN);
+#else
 		free(mem);
+#endif
 	} else {
 
 		free(mem);
@@ -203,6 +470,32 @@ uint64_t Memory::get_mem_max_usage() {
 #endif
 }
 
+int Memory::get_size_class_count() {
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	return SMALL_OBJECT_CLASS_COUNT;
+#else
+	return 0;
+#endif
+}
+
+Memory::SizeClassStats Memory::get_size_class_stats(int p_class) {
+
+	SizeClassStats stats;
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	ERR_FAIL_INDEX_V(p_class, SMALL_OBJECT_CLASS_COUNT, stats);
+
+	SmallObjectDepot &depot = small_object_depots[p_class];
+	depot.lock.lock();
+	stats.block_size = small_object_block_sizes[p_class];
+	stats.reserved_blocks = depot.reserved_blocks;
+	// Blocks sitting in thread caches are counted as used.
+	stats.used_blocks = depot.reserved_blocks - depot.free_count;
+	stats.alloc_count = depot.alloc_count;
+	depot.lock.unlock();
+#endif
+	return stats;
+}
+
 _GlobalNil::_GlobalNil() {
 
 	color = 1;
@@ -58,6 +58,24 @@ public:
 	static uint64_t get_mem_available();
 	static uint64_t get_mem_usage();
 	static uint64_t get_mem_max_usage();
+
+	struct SizeClassStats {
+		uint32_t block_size;
+		uint64_t reserved_blocks;
+		uint64_t used_blocks;
+		uint64_t alloc_count; // updated when blocks move between thread caches and the shared pool
+
+		SizeClassStats() {
+			block_size = 0;
+			reserved_blocks = 0;
+			used_blocks = 0;
+			alloc_count = 0;
+		}
+	};
+
+	// Only non-zero when built with small_object_allocator=yes.
+	static int get_size_class_count();
+	static SizeClassStats get_size_class_stats(int p_class);
 };
 
 class DefaultAllocator {
@@ -30,6 +30,8 @@
 
 #include "pool_vector.h"
 
+#include <atomic>
+
 Mutex *pool_vector_lock = NULL;
 
 PoolAllocator *MemoryPool::memory_pool = NULL;
@@ -37,14 +39,55 @@ uint8_t *MemoryPool::pool_memory = NULL;
 size_t *MemoryPool::pool_size = NULL;
 
 MemoryPool::Alloc *MemoryPool::allocs = NULL;
-MemoryPool::Alloc *MemoryPool::free_list = NULL;
 uint32_t MemoryPool::alloc_count = 0;
 uint32_t MemoryPool::allocs_used = 0;
-Mutex *MemoryPool::alloc_mutex = NULL;
 
 size_t MemoryPool::total_memory = 0;
 size_t MemoryPool::max_memory = 0;
 
+// Free list head. The low 32 bits hold the index of the first free alloc plus
+// one (zero when empty), the high 32 bits a tag bumped on every pop, so a
+// compare-exchange based on a stale head fails even if the same alloc came
+// back to the top in between.
+static std::atomic<uint64_t> free_list_head(0);
+
+MemoryPool::Alloc *MemoryPool::alloc_handle() {
+
+	uint64_t head = free_list_head.load(std::memory_order_acquire);
+
+	while (true) {
+
+		uint32_t index = head & 0xFFFFFFFF;
+		if (index == 0) {
+			return NULL;
+		}
+
+		Alloc *alloc = &allocs[index - 1];
+		// May be stale if another thread popped this alloc meanwhile, the tag makes the exchange fail then.
+		uint64_t next = alloc->free_list ? uint64_t(alloc->free_list - allocs) + 1 : 0;
+		uint64_t new_head = ((head >> 32) + 1) << 32 | next;
+
+		if (free_list_head.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire)) {
+			atomic_increment(&allocs_used);
+			return alloc;
+		}
+	}
+}
+
+void MemoryPool::free_handle(Alloc *p_alloc) {
+
+	uint64_t head = free_list_head.load(std::memory_order_relaxed);
+	uint64_t new_head;
+
+	do {
+		uint32_t index = head & 0xFFFFFFFF;
+		p_alloc->free_list = index ? &allocs[index - 1] : NULL;
+		new_head = (head & 0xFFFFFFFF00000000) | (uint64_t(p_alloc - allocs) + 1);
+	} while (!free_list_head.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+
+	atomic_decrement(&allocs_used);
+}
+
 void MemoryPool::setup(uint32_t p_max_allocs) {
 
 	allocs = memnew_arr(Alloc, p_max_allocs);
@@ -56,15 +99,12 @@ void MemoryPool::setup(uint32_t p_max_allocs) {
 		allocs[i].free_list = &allocs[i + 1];
 	}
 
-	free_list = &allocs[0];
-
-	alloc_mutex = Mutex::create();
+	free_list_head.store(1, std::memory_order_release);
 }
 
 void MemoryPool::cleanup() {
 
 	memdelete_arr(allocs);
-	memdelete(alloc_mutex);
 
 	ERR_FAIL_COND_MSG(allocs_used > 0, "There are still MemoryPool allocs in use at exit!");
 }
@@ -66,13 +66,15 @@ struct MemoryPool {
 	};
 
 	static Alloc *allocs;
-	static Alloc *free_list;
 	static uint32_t alloc_count;
 	static uint32_t allocs_used;
-	static Mutex *alloc_mutex;
 	static size_t total_memory;
 	static size_t max_memory;
 
+	// Lock-free, safe to call from any thread. Returns NULL when all allocs are in use.
+	static Alloc *alloc_handle();
+	static void free_handle(Alloc *p_alloc);
+
 	static void setup(uint32_t p_max_allocs = (1 << 16));
 	static void cleanup();
 };
@@ -95,19 +97,11 @@ class PoolVector {
 
 		//must allocate something
 
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
-			ERR_FAIL_MSG("All memory pool allocations are in use, can't COW.");
-		}
+		MemoryPool::Alloc *new_alloc = MemoryPool::alloc_handle();
+		ERR_FAIL_COND_MSG(!new_alloc, "All memory pool allocations are in use, can't COW.");
 
 		MemoryPool::Alloc *old_alloc = alloc;
-
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
+		alloc = new_alloc;
 
 		//copy the alloc data
 		alloc->size = old_alloc->size;
@@ -116,14 +110,10 @@ class PoolVector {
 		alloc->lock = 0;
 
 #ifdef DEBUG_ENABLED
-		MemoryPool::total_memory += alloc->size;
-		if (MemoryPool::total_memory > MemoryPool::max_memory) {
-			MemoryPool::max_memory = MemoryPool::total_memory;
-		}
+		atomic_add(&MemoryPool::total_memory, alloc->size);
+		atomic_exchange_if_greater(&MemoryPool::max_memory, MemoryPool::total_memory);
 #endif
 
-		MemoryPool::alloc_mutex->unlock();
-
 		if (MemoryPool::memory_pool) {
 
 		} else {
@@ -148,9 +138,7 @@ class PoolVector {
 			//this should never happen but..
 
 #ifdef DEBUG_ENABLED
-			MemoryPool::alloc_mutex->lock();
-			MemoryPool::total_memory -= old_alloc->size;
-			MemoryPool::alloc_mutex->unlock();
+			atomic_sub(&MemoryPool::total_memory, old_alloc->size);
 #endif
 
 			{
@@ -174,11 +162,7 @@ class PoolVector {
 				old_alloc->mem = NULL;
 				old_alloc->size = 0;
 
-				MemoryPool::alloc_mutex->lock();
-				old_alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = old_alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
+				MemoryPool::free_handle(old_alloc);
 			}
 		}
 	}
@@ -227,9 +211,7 @@ class PoolVector {
 		}
 
 #ifdef DEBUG_ENABLED
-		MemoryPool::alloc_mutex->lock();
-		MemoryPool::total_memory -= alloc->size;
-		MemoryPool::alloc_mutex->unlock();
+		atomic_sub(&MemoryPool::total_memory, alloc->size);
 #endif
 
 		if (MemoryPool::memory_pool) {
@@ -242,11 +224,7 @@ class PoolVector {
 			alloc->mem = NULL;
 			alloc->size = 0;
 
-			MemoryPool::alloc_mutex->lock();
-			alloc->free_list = MemoryPool::free_list;
-			MemoryPool::free_list = alloc;
-			MemoryPool::allocs_used--;
-			MemoryPool::alloc_mutex->unlock();
+			MemoryPool::free_handle(alloc);
 		}
 
 		alloc = NULL;
@@ -523,23 +501,13 @@ Error PoolVector<T>::resize(int p_size) {
 			return OK; //nothing to do here
 
 		//must allocate something
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
-			ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "All memory pool allocations are in use.");
-		}
-
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
+		alloc = MemoryPool::alloc_handle();
+		ERR_FAIL_COND_V_MSG(!alloc, ERR_OUT_OF_MEMORY, "All memory pool allocations are in use.");
 
 		//cleanup the alloc
 		alloc->size = 0;
 		alloc->refcount.init();
 		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		MemoryPool::alloc_mutex->unlock();
 
 	} else {
 
@@ -559,13 +527,9 @@ Error PoolVector<T>::resize(int p_size) {
 	_copy_on_write(); // make it unique
 
 #ifdef DEBUG_ENABLED
-	MemoryPool::alloc_mutex->lock();
-	MemoryPool::total_memory -= alloc->size;
-	MemoryPool::total_memory += new_size;
-	if (MemoryPool::total_memory > MemoryPool::max_memory) {
-		MemoryPool::max_memory = MemoryPool::total_memory;
-	}
-	MemoryPool::alloc_mutex->unlock();
+	atomic_sub(&MemoryPool::total_memory, alloc->size);
+	atomic_add(&MemoryPool::total_memory, new_size);
+	atomic_exchange_if_greater(&MemoryPool::max_memory, MemoryPool::total_memory);
 #endif
 
 	int cur_elements = alloc->size / sizeof(T);
@@ -615,11 +579,7 @@ Error PoolVector<T>::resize(int p_size) {
 				alloc->mem = NULL;
 				alloc->size = 0;
 
-				MemoryPool::alloc_mutex->lock();
-				alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
+				MemoryPool::free_handle(alloc);
 
 			} else {
 				alloc->mem = memrealloc(alloc->mem, new_size);
@@ -31,9 +31,11 @@
 #ifndef RID_OWNER_H
 #define RID_OWNER_H
 
+#include "core/os/thread.h"
 #include "core/print_string.h"
 #include "core/rid.h"
 #include "core/spin_lock.h"
+#include <atomic>
 #include <stdio.h>
 #include <typeinfo>
 
@@ -63,263 +65,324 @@ public:
 template <class T, bool THREAD_SAFE = false>
 class RID_Alloc : public RID_AllocBase {
 
-	T **chunks;
-	uint32_t **free_list_chunks;
-	uint32_t **validator_chunks;
+	enum {
+		INVALID_VALIDATOR = 0xFFFFFFFF,
+		FREE_LIST_SHARDS = 8, // thread safe allocators spread threads over these
+		FREE_LIST_SHARD_MAX = 64,
+		FREE_LIST_BATCH = 32, // moved at once between a shard and the shared list
+		CACHE_LINE_SIZE = 64
+	};
+
+	struct Chunk {
+		T *data;
+		std::atomic<uint32_t> *validators;
+	};
+
+	// Readers never lock: a table is only replaced by a bigger copy and the old
+	// one is kept until destruction, so any table a reader loaded stays valid.
+	struct ChunkTable {
+		Chunk *chunks;
+		uint32_t capacity;
+		ChunkTable *prev;
+	};
+
+	struct FreeListShard {
+		SpinLock lock;
+		uint32_t count;
+		uint32_t indices[FREE_LIST_SHARD_MAX];
+		uint8_t _pad[CACHE_LINE_SIZE];
+	};
+
+	std::atomic<ChunkTable *> chunk_table;
+	std::atomic<uint32_t> max_alloc;
+	std::atomic<uint32_t> alloc_count;
 
 	uint32_t elements_in_chunk;
-	uint32_t max_alloc;
-	uint32_t alloc_count;
+
+	// shared free list, also guards growing
+	SpinLock spin_lock;
+	uint32_t *free_list;
+	uint32_t free_count;
+
+	FreeListShard *shards;
 
 	const char *description;
 
-	SpinLock spin_lock;
+	void _grow() {
 
-public:
-	RID make_rid(const T &p_value) {
+		uint32_t chunk_count = max_alloc.load(std::memory_order_relaxed) / elements_in_chunk;
+		ChunkTable *table = chunk_table.load(std::memory_order_relaxed);
 
-		if (THREAD_SAFE) {
-			spin_lock.lock();
+		Chunk chunk;
+		chunk.data = (T *)memalloc(sizeof(T) * elements_in_chunk); //but don't initialize
+		chunk.validators = (std::atomic<uint32_t> *)memalloc(sizeof(std::atomic<uint32_t>) * elements_in_chunk);
+		for (uint32_t i = 0; i < elements_in_chunk; i++) {
+			memnew_placement(&chunk.validators[i], std::atomic<uint32_t>(INVALID_VALIDATOR));
 		}
 
-		if (alloc_count == max_alloc) {
-			//allocate a new chunk
-			uint32_t chunk_count = alloc_count == 0 ? 0 : (max_alloc / elements_in_chunk);
-
-			//grow chunks
-			chunks = (T **)memrealloc(chunks, sizeof(T *) * (chunk_count + 1));
-			chunks[chunk_count] = (T *)memalloc(sizeof(T) * elements_in_chunk); //but don't initialize
-
-			//grow validators
-			validator_chunks = (uint32_t **)memrealloc(validator_chunks, sizeof(uint32_t *) * (chunk_count + 1));
-			validator_chunks[chunk_count] = (uint32_t *)memalloc(sizeof(uint32_t) * elements_in_chunk);
-			//grow free lists
-			free_list_chunks = (uint32_t **)memrealloc(free_list_chunks, sizeof(uint32_t *) * (chunk_count + 1));
-			free_list_chunks[chunk_count] = (uint32_t *)memalloc(sizeof(uint32_t) * elements_in_chunk);
-
-			//initialize
-			for (uint32_t i = 0; i < elements_in_chunk; i++) {
-				//dont initialize chunk
-				validator_chunks[chunk_count][i] = 0xFFFFFFFF;
-				free_list_chunks[chunk_count][i] = alloc_count + i;
+		if (!table || chunk_count == table->capacity) {
+			ChunkTable *new_table = memnew(ChunkTable);
+			new_table->capacity = table ? table->capacity * 2 : 4;
+			new_table->chunks = (Chunk *)memalloc(sizeof(Chunk) * new_table->capacity);
+			for (uint32_t i = 0; i < chunk_count; i++) {
+				new_table->chunks[i] = table->chunks[i];
 			}
+			new_table->chunks[chunk_count] = chunk;
+			new_table->prev = table;
+			chunk_table.store(new_table, std::memory_order_release);
+		} else {
+			table->chunks[chunk_count] = chunk;
+		}
 
-			max_alloc += elements_in_chunk;
+		uint32_t from = chunk_count * elements_in_chunk;
+		free_list = (uint32_t *)memrealloc(free_list, sizeof(uint32_t) * (from + elements_in_chunk));
+		for (uint32_t i = 0; i < elements_in_chunk; i++) {
+			free_list[free_count++] = from + elements_in_chunk - 1 - i; // lowest index is handed out first
 		}
 
-		uint32_t free_index = free_list_chunks[alloc_count / elements_in_chunk][alloc_count % elements_in_chunk];
+		// publish after the table, readers check the index against this first
+		max_alloc.store(from + elements_in_chunk, std::memory_order_release);
+	}
 
-		uint32_t free_chunk = free_index / elements_in_chunk;
-		uint32_t free_element = free_index % elements_in_chunk;
+	uint32_t _alloc_index() {
 
-		T *ptr = &chunks[free_chunk][free_element];
-		memnew_placement(ptr, T(p_value));
-
-		uint32_t validator = (uint32_t)(_gen_id() & 0xFFFFFFFF);
-		uint64_t id = validator;
-		id <<= 32;
-		id |= free_index;
+		if (!THREAD_SAFE) {
+			if (free_count == 0) {
+				_grow();
+			}
+			return free_list[--free_count];
+		}
 
-		validator_chunks[free_chunk][free_element] = validator;
-		alloc_count++;
+		FreeListShard &shard = shards[_get_shard()];
+		shard.lock.lock();
 
-		if (THREAD_SAFE) {
+		if (shard.count == 0) {
+			spin_lock.lock();
+			if (free_count == 0) {
+				_grow();
+			}
+			while (free_count && shard.count < FREE_LIST_BATCH) {
+				shard.indices[shard.count++] = free_list[--free_count];
+			}
 			spin_lock.unlock();
 		}
 
-		return _make_from_id(id);
+		uint32_t index = shard.indices[--shard.count];
+		shard.lock.unlock();
+		return index;
 	}
 
-	_FORCE_INLINE_ T *getornull(const RID &p_rid) {
+	void _free_index(uint32_t p_index) {
 
-		if (THREAD_SAFE) {
-			spin_lock.lock();
+		if (!THREAD_SAFE) {
+			free_list[free_count++] = p_index;
+			return;
 		}
 
-		uint64_t id = p_rid.get_id();
-		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
+		FreeListShard &shard = shards[_get_shard()];
+		shard.lock.lock();
+
+		if (shard.count == FREE_LIST_SHARD_MAX) {
+			spin_lock.lock();
+			while (shard.count > FREE_LIST_SHARD_MAX - FREE_LIST_BATCH) {
+				free_list[free_count++] = shard.indices[--shard.count];
 			}
-			return NULL;
+			spin_lock.unlock();
 		}
 
-		uint32_t idx_chunk = idx / elements_in_chunk;
-		uint32_t idx_element = idx % elements_in_chunk;
+		shard.indices[shard.count++] = p_index;
+		shard.lock.unlock();
+	}
 
-		uint32_t validator = uint32_t(id >> 32);
-		if (unlikely(validator_chunks[idx_chunk][idx_element] != validator)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
+	_FORCE_INLINE_ static uint32_t _get_shard() {
+		uint64_t id = Thread::get_caller_id();
+		return uint32_t((id ^ (id >> 17) ^ (id >> 31)) % FREE_LIST_SHARDS);
+	}
+
+	// Owners that are not thread safe are only used from one thread, plain loads are enough.
+	_FORCE_INLINE_ static std::memory_order _read_order() {
+		return THREAD_SAFE ? std::memory_order_acquire : std::memory_order_relaxed;
+	}
+
+	_FORCE_INLINE_ const Chunk *_get_chunk(uint32_t p_idx) const {
+
+		if (unlikely(p_idx >= max_alloc.load(_read_order()))) {
 			return NULL;
 		}
+		return &chunk_table.load(_read_order())->chunks[p_idx / elements_in_chunk];
+	}
 
-		T *ptr = &chunks[idx_chunk][idx_element];
+public:
+	RID make_rid(const T &p_value) {
 
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
+		uint32_t free_index = _alloc_index();
 
-		return ptr;
-	}
+		const Chunk *chunk = _get_chunk(free_index);
+		uint32_t free_element = free_index % elements_in_chunk;
 
-	_FORCE_INLINE_ bool owns(const RID &p_rid) {
+		T *ptr = &chunk->data[free_element];
+		memnew_placement(ptr, T(p_value));
 
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
+		// ids come from a global counter, so they also act as the slot generation
+		uint32_t validator = (uint32_t)(_gen_id() & 0xFFFFFFFF);
+		uint64_t id = validator;
+		id <<= 32;
+		id |= free_index;
+
+		chunk->validators[free_element].store(validator, std::memory_order_release);
+		alloc_count.fetch_add(1, std::memory_order_relaxed);
+
+		return _make_from_id(id);
+	}
+
+	_FORCE_INLINE_ T *getornull(const RID &p_rid) {
 
 		uint64_t id = p_rid.get_id();
 		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
-			return false;
+		const Chunk *chunk = _get_chunk(idx);
+		if (unlikely(!chunk)) {
+			return NULL;
 		}
 
-		uint32_t idx_chunk = idx / elements_in_chunk;
 		uint32_t idx_element = idx % elements_in_chunk;
 
 		uint32_t validator = uint32_t(id >> 32);
+		if (unlikely(chunk->validators[idx_element].load(_read_order()) != validator)) {
+			return NULL;
+		}
 
-		bool owned = validator_chunks[idx_chunk][idx_element] == validator;
+		return &chunk->data[idx_element];
+	}
 
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
+	_FORCE_INLINE_ bool owns(const RID &p_rid) {
 
-		return owned;
+		return getornull(p_rid) != NULL;
 	}
 
 	_FORCE_INLINE_ void free(const RID &p_rid) {
 
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-
 		uint64_t id = p_rid.get_id();
 		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
-			ERR_FAIL();
-		}
+		const Chunk *chunk = _get_chunk(idx);
+		ERR_FAIL_COND(!chunk);
 
-		uint32_t idx_chunk = idx / elements_in_chunk;
 		uint32_t idx_element = idx % elements_in_chunk;
 
+		// go invalid first, so concurrent readers stop handing out the element
 		uint32_t validator = uint32_t(id >> 32);
-		if (unlikely(validator_chunks[idx_chunk][idx_element] != validator)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
-			ERR_FAIL();
-		}
+		ERR_FAIL_COND(!chunk->validators[idx_element].compare_exchange_strong(validator, INVALID_VALIDATOR, std::memory_order_acq_rel));
 
-		chunks[idx_chunk][idx_element].~T();
-		validator_chunks[idx_chunk][idx_element] = 0xFFFFFFFF; // go invalid
+		chunk->data[idx_element].~T();
 
-		alloc_count--;
-		free_list_chunks[alloc_count / elements_in_chunk][alloc_count % elements_in_chunk] = idx;
-
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
+		alloc_count.fetch_sub(1, std::memory_order_relaxed);
+		_free_index(idx);
 	}
 
 	_FORCE_INLINE_ uint32_t get_rid_count() const {
-		return alloc_count;
+		return alloc_count.load(std::memory_order_relaxed);
 	}
 
-	_FORCE_INLINE_ T *get_ptr_by_index(uint32_t p_index) {
-		ERR_FAIL_INDEX_V(p_index, alloc_count, NULL);
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-		uint64_t idx = free_list_chunks[p_index / elements_in_chunk][p_index % elements_in_chunk];
-		T *ptr = &chunks[idx / elements_in_chunk][idx % elements_in_chunk];
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
+	// Slots are no longer kept packed, so these walk the owned elements.
+	T *get_ptr_by_index(uint32_t p_index) {
+		ERR_FAIL_INDEX_V(p_index, get_rid_count(), NULL);
+		uint32_t count = max_alloc.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; i++) {
+			const Chunk *chunk = _get_chunk(i);
+			if (chunk->validators[i % elements_in_chunk].load(std::memory_order_acquire) != INVALID_VALIDATOR) {
+				if (p_index == 0) {
+					return &chunk->data[i % elements_in_chunk];
+				}
+				p_index--;
+			}
 		}
-		return ptr;
+		return NULL;
 	}
 
-	_FORCE_INLINE_ RID get_rid_by_index(uint32_t p_index) {
-		ERR_FAIL_INDEX_V(p_index, alloc_count, RID());
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-		uint64_t idx = free_list_chunks[p_index / elements_in_chunk][p_index % elements_in_chunk];
-		uint64_t validator = validator_chunks[idx / elements_in_chunk][idx % elements_in_chunk];
-
-		RID rid = _make_from_id((validator << 32) | idx);
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
+	RID get_rid_by_index(uint32_t p_index) {
+		ERR_FAIL_INDEX_V(p_index, get_rid_count(), RID());
+		uint32_t count = max_alloc.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; i++) {
+			uint64_t validator = _get_chunk(i)->validators[i % elements_in_chunk].load(std::memory_order_acquire);
+			if (validator != INVALID_VALIDATOR) {
+				if (p_index == 0) {
+					return _make_from_id((validator << 32) | i);
+				}
+				p_index--;
+			}
 		}
-		return rid;
+		return RID();
 	}
 
 	void get_owned_list(List<RID> *p_owned) {
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-		for (size_t i = 0; i < max_alloc; i++) {
-			uint64_t validator = validator_chunks[i / elements_in_chunk][i % elements_in_chunk];
-			if (validator != 0xFFFFFFFF) {
+		uint32_t count = max_alloc.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; i++) {
+			uint64_t validator = _get_chunk(i)->validators[i % elements_in_chunk].load(std::memory_order_acquire);
+			if (validator != INVALID_VALIDATOR) {
 				p_owned->push_back(_make_from_id((validator << 32) | i));
 			}
 		}
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
 	}
 
 	void set_description(const char *p_descrption) {
 		description = p_descrption;
 	}
 
-	RID_Alloc(uint32_t p_target_chunk_byte_size = 4096) {
-		chunks = NULL;
-		free_list_chunks = NULL;
-		validator_chunks = NULL;
+	RID_Alloc(uint32_t p_target_chunk_byte_size = 4096) :
+			chunk_table(NULL),
+			max_alloc(0),
+			alloc_count(0) {
 
 		elements_in_chunk = sizeof(T) > p_target_chunk_byte_size ? 1 : (p_target_chunk_byte_size / sizeof(T));
-		max_alloc = 0;
-		alloc_count = 0;
+		free_list = NULL;
+		free_count = 0;
+		shards = NULL;
 		description = NULL;
+
+		if (THREAD_SAFE) {
+			shards = memnew_arr(FreeListShard, FREE_LIST_SHARDS);
+			for (uint32_t i = 0; i < FREE_LIST_SHARDS; i++) {
+				shards[i].count = 0;
+			}
+		}
 	}
 
 	~RID_Alloc() {
-		if (alloc_count) {
+		uint32_t count = max_alloc.load(std::memory_order_acquire);
+		ChunkTable *table = chunk_table.load(std::memory_order_acquire);
+
+		if (alloc_count.load()) {
 			if (description) {
-				print_error("ERROR: " + itos(alloc_count) + " RID allocations of type '" + description + "' were leaked at exit.");
+				print_error("ERROR: " + itos(alloc_count.load()) + " RID allocations of type '" + description + "' were leaked at exit.");
 			} else {
-				print_error("ERROR: " + itos(alloc_count) + " RID allocations of type '" + typeid(T).name() + "' were leaked at exit.");
+				print_error("ERROR: " + itos(alloc_count.load()) + " RID allocations of type '" + typeid(T).name() + "' were leaked at exit.");
 			}
 
-			for (size_t i = 0; i < max_alloc; i++) {
-				uint64_t validator = validator_chunks[i / elements_in_chunk][i % elements_in_chunk];
-				if (validator != 0xFFFFFFFF) {
-					chunks[i / elements_in_chunk][i % elements_in_chunk].~T();
+			for (uint32_t i = 0; i < count; i++) {
+				Chunk &chunk = table->chunks[i / elements_in_chunk];
+				if (chunk.validators[i % elements_in_chunk].load() != INVALID_VALIDATOR) {
+					chunk.data[i % elements_in_chunk].~T();
 				}
 			}
 		}
 
-		uint32_t chunk_count = max_alloc / elements_in_chunk;
+		uint32_t chunk_count = count / elements_in_chunk;
 		for (uint32_t i = 0; i < chunk_count; i++) {
-			memfree(chunks[i]);
-			memfree(validator_chunks[i]);
-			memfree(free_list_chunks[i]);
+			memfree(table->chunks[i].data);
+			memfree(table->chunks[i].validators);
 		}
 
-		if (chunks) {
-			memfree(chunks);
-			memfree(free_list_chunks);
-			memfree(validator_chunks);
+		while (table) {
+			ChunkTable *prev = table->prev;
+			memfree(table->chunks);
+			memdelete(table);
+			table = prev;
+		}
+
+		if (free_list) {
+			memfree(free_list);
+		}
+		if (shards) {
+			memdelete_arr(shards);
 		}
 	}
 };
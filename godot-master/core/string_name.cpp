@@ -33,27 +33,18 @@
 #include "core/os/os.h"
 #include "core/print_string.h"
 
-StaticCString StaticCString::create(const char *p_ptr) {
-	StaticCString scs;
-	scs.ptr = p_ptr;
-	return scs;
-}
-
 StringName::_Data *StringName::_table[STRING_TABLE_LEN];
 
-StringName _scs_create(const char *p_chr) {
-
-	return (p_chr[0] ? StringName(StaticCString::create(p_chr)) : StringName());
-}
-
 bool StringName::configured = false;
-Mutex *StringName::lock = NULL;
+Mutex *StringName::locks[STRING_TABLE_LOCK_LEN];
 
 void StringName::setup() {
 
-	lock = Mutex::create();
-
 	ERR_FAIL_COND(configured);
+	for (int i = 0; i < STRING_TABLE_LOCK_LEN; i++) {
+
+		locks[i] = Mutex::create();
+	}
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
 
 		_table[i] = NULL;
@@ -63,8 +54,6 @@ void StringName::setup() {
 
 void StringName::cleanup() {
 
-	lock->lock();
-
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
 
@@ -87,9 +76,12 @@ void StringName::cleanup() {
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
-	lock->unlock();
 
-	memdelete(lock);
+	for (int i = 0; i < STRING_TABLE_LOCK_LEN; i++) {
+
+		memdelete(locks[i]);
+		locks[i] = NULL;
+	}
 }
 
 void StringName::unref() {
@@ -98,6 +90,7 @@ void StringName::unref() {
 
 	if (_data && _data->refcount.unref()) {
 
+		Mutex *lock = locks[_data->idx & STRING_TABLE_LOCK_MASK];
 		lock->lock();
 
 		if (_data->prev) {
@@ -184,12 +177,13 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *lock = locks[idx & STRING_TABLE_LOCK_MASK];
+	lock->lock();
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -231,12 +225,13 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_static_string.ptr);
+	uint32_t hash = p_static_string.hash;
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *lock = locks[idx & STRING_TABLE_LOCK_MASK];
+	lock->lock();
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -279,12 +274,13 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
 	uint32_t hash = p_name.hash();
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *lock = locks[idx & STRING_TABLE_LOCK_MASK];
+	lock->lock();
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -325,12 +321,13 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *lock = locks[idx & STRING_TABLE_LOCK_MASK];
+	lock->lock();
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -359,12 +356,13 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *lock = locks[idx & STRING_TABLE_LOCK_MASK];
+	lock->lock();
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -387,12 +385,13 @@ StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
 	uint32_t hash = p_name.hash();
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *lock = locks[idx & STRING_TABLE_LOCK_MASK];
+	lock->lock();
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -38,7 +38,19 @@
 struct StaticCString {
 
 	const char *ptr;
-	static StaticCString create(const char *p_ptr);
+	uint32_t hash;
+
+	// Same as String::hash(const char *), folds to a constant for literals.
+	static constexpr uint32_t hash_cstr(const char *p_ptr, uint32_t p_hash = 5381) {
+		return *p_ptr ? hash_cstr(p_ptr + 1, ((p_hash << 5) + p_hash) + (uint32_t)*p_ptr) : p_hash;
+	}
+
+	_FORCE_INLINE_ static StaticCString create(const char *p_ptr) {
+		StaticCString scs;
+		scs.ptr = p_ptr;
+		scs.hash = hash_cstr(p_ptr);
+		return scs;
+	}
 };
 
 class StringName {
@@ -47,7 +59,12 @@ class StringName {
 
 		STRING_TABLE_BITS = 12,
 		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MASK = STRING_TABLE_LEN - 1,
+		// Buckets are spread over several locks so threads looking up
+		// unrelated names rarely wait on each other.
+		STRING_TABLE_LOCK_BITS = 6,
+		STRING_TABLE_LOCK_LEN = 1 << STRING_TABLE_LOCK_BITS,
+		STRING_TABLE_LOCK_MASK = STRING_TABLE_LOCK_LEN - 1
 	};
 
 	struct _Data {
@@ -82,7 +99,7 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 
-	static Mutex *lock;
+	static Mutex *locks[STRING_TABLE_LOCK_LEN];
 	static void setup();
 	static void cleanup();
 	static bool configured;
@@ -164,6 +181,9 @@ public:
 	~StringName();
 };
 
-StringName _scs_create(const char *p_chr);
+_FORCE_INLINE_ StringName _scs_create(const char *p_chr) {
+
+	return (p_chr[0] ? StringName(StaticCString::create(p_chr)) : StringName());
+}
 
 #endif // STRING_NAME_H
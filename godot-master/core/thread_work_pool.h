@@ -98,6 +98,8 @@ public:
 			threads[i].completed.wait();
 			threads[i].work = nullptr;
 		}
+
+		memdelete(w);
 	}
 
 	void init(int p_thread_count = -1);
@@ -51,6 +51,7 @@
 
 class RefPtr;
 class Object;
+struct MethodCallCache;
 class Node; // helper
 class Control; // helper
 
@@ -359,7 +360,7 @@ public:
 		Type expected;
 	};
 
-	void call_ptr(const StringName &p_method, const Variant **p_args, int p_argcount, Variant *r_ret, CallError &r_error);
+	void call_ptr(const StringName &p_method, const Variant **p_args, int p_argcount, Variant *r_ret, CallError &r_error, MethodCallCache *p_cache = NULL);
 	Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, CallError &r_error);
 	Variant call(const StringName &p_method, const Variant &p_arg1 = Variant(), const Variant &p_arg2 = Variant(), const Variant &p_arg3 = Variant(), const Variant &p_arg4 = Variant(), const Variant &p_arg5 = Variant());
 
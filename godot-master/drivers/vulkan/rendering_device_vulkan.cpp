@@ -30,6 +30,7 @@
 
 #include "rendering_device_vulkan.h"
 #include "core/hashfuncs.h"
+#include "core/os/dir_access.h"
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
@@ -1285,7 +1286,7 @@ Error RenderingDeviceVulkan::_insert_staging_block() {
 	bufferInfo.pQueueFamilyIndices = 0;
 
 	VmaAllocationCreateInfo allocInfo;
-	allocInfo.flags = 0;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 	allocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
 	allocInfo.requiredFlags = 0;
 	allocInfo.preferredFlags = 0;
@@ -1294,10 +1295,13 @@ Error RenderingDeviceVulkan::_insert_staging_block() {
 	allocInfo.pUserData = NULL;
 
 	StagingBufferBlock block;
+	VmaAllocationInfo alloc_info;
 
-	VkResult err = vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &block.buffer, &block.allocation, NULL);
+	VkResult err = vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &block.buffer, &block.allocation, &alloc_info);
 	ERR_FAIL_COND_V(err, ERR_CANT_CREATE);
 
+	//CPU only memory is host coherent, so it can stay mapped
+	block.data_ptr = (uint8_t *)alloc_info.pMappedData;
 	block.frame_used = 0;
 	block.fill_amount = 0;
 
@@ -1370,6 +1374,7 @@ Error RenderingDeviceVulkan::_staging_buffer_allocate(uint32_t p_amount, uint32_
 
 							//flush EVERYTHING including setup commands. IF not immediate, also need to flush the draw commands
 							_flush(true);
+							staging_buffer_stalls++;
 
 							//clear the whole staging buffer
 							for (int i = 0; i < staging_buffer_blocks.size(); i++) {
@@ -1414,6 +1419,7 @@ Error RenderingDeviceVulkan::_staging_buffer_allocate(uint32_t p_amount, uint32_
 				} else {
 
 					_flush(false);
+					staging_buffer_stalls++;
 
 					for (int i = 0; i < staging_buffer_blocks.size(); i++) {
 						//clear all blocks but the ones from this frame
@@ -1437,6 +1443,7 @@ Error RenderingDeviceVulkan::_staging_buffer_allocate(uint32_t p_amount, uint32_
 	}
 
 	staging_buffer_used = true;
+	staging_buffer_upload_bytes += r_alloc_size;
 
 	return OK;
 }
@@ -1457,21 +1464,9 @@ Error RenderingDeviceVulkan::_buffer_update(Buffer *p_buffer, size_t p_offset, c
 			return err;
 		}
 
-		//map staging buffer (It's CPU and coherent)
-
-		void *data_ptr = NULL;
-		{
-			VkResult vkerr = vmaMapMemory(allocator, staging_buffer_blocks[staging_buffer_current].allocation, &data_ptr);
-			if (vkerr) {
-				ERR_FAIL_V(ERR_CANT_CREATE);
-			}
-		}
-
-		//copy to staging buffer
-		copymem(((uint8_t *)data_ptr) + block_write_offset, p_data + submit_from, block_write_amount);
+		//copy to staging buffer (persistently mapped)
+		copymem(staging_buffer_blocks[staging_buffer_current].data_ptr + block_write_offset, p_data + submit_from, block_write_amount);
 
-		//unmap
-		vmaUnmapMemory(allocator, staging_buffer_blocks[staging_buffer_current].allocation);
 		//insert a command to copy this
 
 		VkBufferCopy region;
@@ -2174,17 +2169,7 @@ Error RenderingDeviceVulkan::texture_update(RID p_texture, uint32_t p_layer, con
 					Error err = _staging_buffer_allocate(to_allocate, required_align, alloc_offset, alloc_size, false, p_sync_with_draw);
 					ERR_FAIL_COND_V(err, ERR_CANT_CREATE);
 
-					uint8_t *write_ptr;
-
-					{ //map
-						void *data_ptr = NULL;
-						VkResult vkerr = vmaMapMemory(allocator, staging_buffer_blocks[staging_buffer_current].allocation, &data_ptr);
-						if (vkerr) {
-							ERR_FAIL_V(ERR_CANT_CREATE);
-						}
-						write_ptr = (uint8_t *)data_ptr;
-						write_ptr += alloc_offset;
-					}
+					uint8_t *write_ptr = staging_buffer_blocks[staging_buffer_current].data_ptr + alloc_offset;
 
 					uint32_t block_w, block_h;
 					get_compressed_image_format_block_dimensions(texture->format, block_w, block_h);
@@ -2232,10 +2217,6 @@ Error RenderingDeviceVulkan::texture_update(RID p_texture, uint32_t p_layer, con
 						}
 					}
 
-					{ //unmap
-						vmaUnmapMemory(allocator, staging_buffer_blocks[staging_buffer_current].allocation);
-					}
-
 					VkBufferImageCopy buffer_image_copy;
 					buffer_image_copy.bufferOffset = alloc_offset;
 					buffer_image_copy.bufferRowLength = 0; //tigthly packed
@@ -5062,10 +5043,28 @@ RID RenderingDeviceVulkan::render_pipeline_create(RID p_shader, FramebufferForma
 	graphics_pipeline_create_info.basePipelineHandle = NULL;
 	graphics_pipeline_create_info.basePipelineIndex = 0;
 
+	VkPipelineCreationFeedbackEXT pipeline_feedback;
+	VkPipelineCreationFeedbackEXT stage_feedbacks[SHADER_STAGE_MAX];
+	VkPipelineCreationFeedbackCreateInfoEXT feedback_create_info;
+
+	if (context->is_pipeline_creation_feedback_enabled()) {
+		pipeline_feedback.flags = 0;
+		feedback_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+		feedback_create_info.pNext = NULL;
+		feedback_create_info.pPipelineCreationFeedback = &pipeline_feedback;
+		feedback_create_info.pipelineStageCreationFeedbackCount = shader->pipeline_stages.size();
+		feedback_create_info.pPipelineStageCreationFeedbacks = stage_feedbacks;
+		graphics_pipeline_create_info.pNext = &feedback_create_info;
+	}
+
 	RenderPipeline pipeline;
-	VkResult err = vkCreateGraphicsPipelines(device, NULL, 1, &graphics_pipeline_create_info, NULL, &pipeline.pipeline);
+	VkResult err = vkCreateGraphicsPipelines(device, pipeline_cache, 1, &graphics_pipeline_create_info, NULL, &pipeline.pipeline);
 	ERR_FAIL_COND_V(err, RID());
 
+	if (context->is_pipeline_creation_feedback_enabled()) {
+		_pipeline_cache_feedback(pipeline_feedback);
+	}
+
 	pipeline.set_formats = shader->set_formats;
 	pipeline.push_constant_stages = shader->push_constant.push_constants_vk_stage;
 	pipeline.pipeline_layout = shader->pipeline_layout;
@@ -5135,10 +5134,28 @@ RID RenderingDeviceVulkan::compute_pipeline_create(RID p_shader) {
 	compute_pipeline_create_info.basePipelineHandle = NULL;
 	compute_pipeline_create_info.basePipelineIndex = 0;
 
+	VkPipelineCreationFeedbackEXT pipeline_feedback;
+	VkPipelineCreationFeedbackEXT stage_feedback;
+	VkPipelineCreationFeedbackCreateInfoEXT feedback_create_info;
+
+	if (context->is_pipeline_creation_feedback_enabled()) {
+		pipeline_feedback.flags = 0;
+		feedback_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+		feedback_create_info.pNext = NULL;
+		feedback_create_info.pPipelineCreationFeedback = &pipeline_feedback;
+		feedback_create_info.pipelineStageCreationFeedbackCount = 1;
+		feedback_create_info.pPipelineStageCreationFeedbacks = &stage_feedback;
+		compute_pipeline_create_info.pNext = &feedback_create_info;
+	}
+
 	ComputePipeline pipeline;
-	VkResult err = vkCreateComputePipelines(device, NULL, 1, &compute_pipeline_create_info, NULL, &pipeline.pipeline);
+	VkResult err = vkCreateComputePipelines(device, pipeline_cache, 1, &compute_pipeline_create_info, NULL, &pipeline.pipeline);
 	ERR_FAIL_COND_V(err, RID());
 
+	if (context->is_pipeline_creation_feedback_enabled()) {
+		_pipeline_cache_feedback(pipeline_feedback);
+	}
+
 	pipeline.set_formats = shader->set_formats;
 	pipeline.push_constant_stages = shader->push_constant.push_constants_vk_stage;
 	pipeline.pipeline_layout = shader->pipeline_layout;
@@ -6581,6 +6598,11 @@ void RenderingDeviceVulkan::swap_buffers() {
 			staging_buffer_used = false;
 		}
 
+		staging_buffer_last_frame_upload_bytes = staging_buffer_upload_bytes;
+		staging_buffer_last_frame_stalls = staging_buffer_stalls;
+		staging_buffer_upload_bytes = 0;
+		staging_buffer_stalls = 0;
+
 		if (frames[frame].timestamp_count) {
 			vkGetQueryPoolResults(device, frames[frame].timestamp_pool, 0, frames[frame].timestamp_count, sizeof(uint64_t) * max_timestamp_query_elements, frames[frame].timestamp_result_values, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
 			SWAP(frames[frame].timestamp_names, frames[frame].timestamp_result_names);
@@ -6707,6 +6729,151 @@ uint32_t RenderingDeviceVulkan::get_frame_delay() const {
 	return frame_count;
 }
 
+uint32_t RenderingDeviceVulkan::get_pipeline_cache_hits() const {
+	return pipeline_cache_hits;
+}
+
+uint32_t RenderingDeviceVulkan::get_pipeline_cache_misses() const {
+	return pipeline_cache_misses;
+}
+
+uint64_t RenderingDeviceVulkan::get_staging_buffer_upload_bytes() const {
+	return staging_buffer_last_frame_upload_bytes;
+}
+
+uint32_t RenderingDeviceVulkan::get_staging_buffer_stall_count() const {
+	return staging_buffer_last_frame_stalls;
+}
+
+#define PIPELINE_CACHE_MAGIC 0x43505347 // "GSPC"
+
+void RenderingDeviceVulkan::_load_pipeline_cache() {
+
+	pipeline_cache = VK_NULL_HANDLE;
+	pipeline_cache_hits = 0;
+	pipeline_cache_misses = 0;
+
+	if (!GLOBAL_DEF("rendering/vulkan/pipeline_cache/enable", true)) {
+		return;
+	}
+
+	pipeline_cache_path = "user://vulkan/pipelines.cache";
+
+	const VkPhysicalDeviceProperties &props = context->get_device_properties();
+	Vector<uint8_t> cache_data;
+
+	FileAccess *f = FileAccess::open(pipeline_cache_path, FileAccess::READ);
+	if (f) {
+		PipelineCacheHeader header;
+		bool valid = f->get_len() >= sizeof(PipelineCacheHeader);
+		if (valid) {
+			header.magic = f->get_32();
+			header.data_size = f->get_32();
+			header.data_hash = f->get_32();
+			header.vendor_id = f->get_32();
+			header.device_id = f->get_32();
+			header.driver_version = f->get_32();
+			f->get_buffer(header.uuid, VK_UUID_SIZE);
+
+			valid = header.magic == PIPELINE_CACHE_MAGIC && header.vendor_id == props.vendorID && header.device_id == props.deviceID && header.driver_version == props.driverVersion && memcmp(header.uuid, props.pipelineCacheUUID, VK_UUID_SIZE) == 0 && f->get_len() - f->get_position() == header.data_size;
+		}
+
+		if (valid) {
+			cache_data.resize(header.data_size);
+			f->get_buffer(cache_data.ptrw(), header.data_size);
+			valid = hash_djb2_buffer(cache_data.ptr(), cache_data.size()) == header.data_hash;
+		}
+
+		f->close();
+		memdelete(f);
+
+		if (!valid) {
+			print_verbose("Vulkan pipeline cache at '" + pipeline_cache_path + "' is invalid or from another GPU or driver, ignoring it.");
+			cache_data.clear();
+		}
+	}
+
+	VkPipelineCacheCreateInfo cache_create_info;
+	cache_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cache_create_info.pNext = NULL;
+	cache_create_info.flags = 0;
+	cache_create_info.initialDataSize = cache_data.size();
+	cache_create_info.pInitialData = cache_data.ptr();
+
+	VkResult err = vkCreatePipelineCache(device, &cache_create_info, NULL, &pipeline_cache);
+	if (err && cache_data.size()) {
+		//driver refused the data, start from scratch
+		cache_create_info.initialDataSize = 0;
+		cache_create_info.pInitialData = NULL;
+		err = vkCreatePipelineCache(device, &cache_create_info, NULL, &pipeline_cache);
+	}
+
+	if (err) {
+		pipeline_cache = VK_NULL_HANDLE;
+		ERR_FAIL_MSG("Unable to create Vulkan pipeline cache, pipelines will not be cached.");
+	}
+
+	if (cache_data.size()) {
+		print_verbose("Loaded Vulkan pipeline cache (" + itos(cache_data.size()) + " bytes).");
+	}
+}
+
+void RenderingDeviceVulkan::_save_pipeline_cache() {
+
+	if (pipeline_cache == VK_NULL_HANDLE) {
+		return;
+	}
+
+	size_t data_size = 0;
+	VkResult err = vkGetPipelineCacheData(device, pipeline_cache, &data_size, NULL);
+	ERR_FAIL_COND(err);
+
+	if (data_size == 0) {
+		return;
+	}
+
+	Vector<uint8_t> cache_data;
+	cache_data.resize(data_size);
+	err = vkGetPipelineCacheData(device, pipeline_cache, &data_size, cache_data.ptrw());
+	ERR_FAIL_COND(err);
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+	Error dir_err = da->make_dir_recursive(pipeline_cache_path.get_base_dir());
+	memdelete(da);
+	ERR_FAIL_COND_MSG(dir_err != OK && dir_err != ERR_ALREADY_EXISTS, "Unable to create directory for Vulkan pipeline cache: " + pipeline_cache_path.get_base_dir() + ".");
+
+	FileAccess *f = FileAccess::open(pipeline_cache_path, FileAccess::WRITE);
+	ERR_FAIL_COND_MSG(!f, "Unable to save Vulkan pipeline cache to: " + pipeline_cache_path + ".");
+
+	const VkPhysicalDeviceProperties &props = context->get_device_properties();
+
+	f->store_32(PIPELINE_CACHE_MAGIC);
+	f->store_32(data_size);
+	f->store_32(hash_djb2_buffer(cache_data.ptr(), data_size));
+	f->store_32(props.vendorID);
+	f->store_32(props.deviceID);
+	f->store_32(props.driverVersion);
+	f->store_buffer(props.pipelineCacheUUID, VK_UUID_SIZE);
+	f->store_buffer(cache_data.ptr(), data_size);
+	f->close();
+	memdelete(f);
+
+	print_verbose("Saved Vulkan pipeline cache (" + itos(data_size) + " bytes), " + itos(pipeline_cache_hits) + " pipelines were found in it and " + itos(pipeline_cache_misses) + " had to be compiled.");
+}
+
+void RenderingDeviceVulkan::_pipeline_cache_feedback(const VkPipelineCreationFeedbackEXT &p_feedback) {
+
+	if (!(p_feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)) {
+		return;
+	}
+
+	if (p_feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) {
+		pipeline_cache_hits++;
+	} else {
+		pipeline_cache_misses++;
+	}
+}
+
 void RenderingDeviceVulkan::_flush(bool p_current_frame) {
 
 	//not doing this crashes RADV (undefined behavior)
@@ -6852,6 +7019,10 @@ void RenderingDeviceVulkan::initialize(VulkanContext *p_context) {
 	//ensure current staging block is valid and at least one per frame exists
 	staging_buffer_current = 0;
 	staging_buffer_used = false;
+	staging_buffer_upload_bytes = 0;
+	staging_buffer_stalls = 0;
+	staging_buffer_last_frame_upload_bytes = 0;
+	staging_buffer_last_frame_stalls = 0;
 
 	for (int i = 0; i < frame_count; i++) {
 		//staging was never used, create a block
@@ -6861,6 +7032,8 @@ void RenderingDeviceVulkan::initialize(VulkanContext *p_context) {
 
 	max_descriptors_per_pool = GLOBAL_DEF("rendering/vulkan/descriptor_pools/max_descriptors_per_pool", 64);
 
+	_load_pipeline_cache();
+
 	//check to make sure DescriptorPoolKey is good
 	ERR_FAIL_COND(sizeof(uint64_t) * 3 < UNIFORM_TYPE_MAX * sizeof(uint16_t));
 
@@ -7001,6 +7174,8 @@ void RenderingDeviceVulkan::finalize() {
 
 	_flush(false);
 
+	_save_pipeline_cache();
+
 	_free_rids(render_pipeline_owner, "Pipeline");
 	_free_rids(compute_pipeline_owner, "Compute");
 	_free_rids(uniform_set_owner, "UniformSet");
@@ -7060,6 +7235,10 @@ void RenderingDeviceVulkan::finalize() {
 		vmaDestroyBuffer(allocator, staging_buffer_blocks[i].buffer, staging_buffer_blocks[i].allocation);
 	}
 
+	if (pipeline_cache != VK_NULL_HANDLE) {
+		vkDestroyPipelineCache(device, pipeline_cache, NULL);
+	}
+
 	//all these should be clear at this point
 	ERR_FAIL_COND(descriptor_pools.size());
 	ERR_FAIL_COND(dependency_map.size());
@@ -7068,4 +7247,7 @@ void RenderingDeviceVulkan::finalize() {
 
 RenderingDeviceVulkan::RenderingDeviceVulkan() {
 	screen_prepared = false;
+	pipeline_cache = VK_NULL_HANDLE;
+	pipeline_cache_hits = 0;
+	pipeline_cache_misses = 0;
 }
@@ -181,11 +181,23 @@ class RenderingDeviceVulkan : public RenderingDevice {
 	// another fence will ensure everything pending for the current
 	// frame is processed (effectively stalling).
 	//
+	// Blocks stay mapped for their whole lifetime, so
+	// uploads are just a copy into data_ptr.
+	//
+	// Copies are recorded on the setup (or draw) command buffer
+	// and run on the graphics queue. There is no dedicated
+	// transfer queue: it would need queue family ownership
+	// transfers for every buffer and image touched, and callers
+	// would need completion tokens instead of assuming data is
+	// there once the update returns. The stall count reported
+	// for each frame tells when this starts to matter.
+	//
 	// See the comments in the code to understand better how it works.
 
 	struct StagingBufferBlock {
 		VkBuffer buffer;
 		VmaAllocation allocation;
+		uint8_t *data_ptr;
 		uint64_t frame_used;
 		uint32_t fill_amount;
 	};
@@ -196,6 +208,12 @@ class RenderingDeviceVulkan : public RenderingDevice {
 	uint64_t staging_buffer_max_size;
 	bool staging_buffer_used;
 
+	//upload stats, the current frame ones are moved to the last frame ones when a frame is swapped
+	uint64_t staging_buffer_upload_bytes;
+	uint32_t staging_buffer_stalls;
+	uint64_t staging_buffer_last_frame_upload_bytes;
+	uint32_t staging_buffer_last_frame_stalls;
+
 	Error _staging_buffer_allocate(uint32_t p_amount, uint32_t p_required_align, uint32_t &r_alloc_offset, uint32_t &r_alloc_size, bool p_can_segment = true, bool p_on_draw_command_buffer = false);
 	Error _insert_staging_block();
 
@@ -690,6 +708,34 @@ class RenderingDeviceVulkan : public RenderingDevice {
 
 	RID_Owner<ComputePipeline, true> compute_pipeline_owner;
 
+	// All pipelines are created through a single
+	// VkPipelineCache, which is loaded from the
+	// user data folder on startup and saved back
+	// on exit, so pipelines compiled in a previous
+	// run don't need to be compiled again.
+	// The header written before the driver data
+	// is used to reject caches from another GPU or
+	// driver version, or files that got truncated.
+
+	struct PipelineCacheHeader {
+		uint32_t magic;
+		uint32_t data_size;
+		uint32_t data_hash;
+		uint32_t vendor_id;
+		uint32_t device_id;
+		uint32_t driver_version;
+		uint8_t uuid[VK_UUID_SIZE];
+	};
+
+	VkPipelineCache pipeline_cache;
+	String pipeline_cache_path;
+	uint32_t pipeline_cache_hits;
+	uint32_t pipeline_cache_misses;
+
+	void _load_pipeline_cache();
+	void _save_pipeline_cache();
+	void _pipeline_cache_feedback(const VkPipelineCreationFeedbackEXT &p_feedback);
+
 	/*******************/
 	/**** DRAW LIST ****/
 	/*******************/
@@ -1121,6 +1167,12 @@ public:
 
 	virtual uint32_t get_frame_delay() const;
 
+	virtual uint32_t get_pipeline_cache_hits() const;
+	virtual uint32_t get_pipeline_cache_misses() const;
+
+	virtual uint64_t get_staging_buffer_upload_bytes() const;
+	virtual uint32_t get_staging_buffer_stall_count() const;
+
 	RenderingDeviceVulkan();
 };
 
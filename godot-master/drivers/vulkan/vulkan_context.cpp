@@ -396,6 +396,17 @@ Error VulkanContext::_create_physical_device() {
 			}
 		}
 
+		// Optional, used to report pipeline cache hits and misses.
+		VK_EXT_pipeline_creation_feedback_enabled = false;
+		for (uint32_t i = 0; i < device_extension_count; i++) {
+			if (!strcmp(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME, device_extensions[i].extensionName)) {
+				extension_names[enabled_extension_count++] = VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME;
+				VK_EXT_pipeline_creation_feedback_enabled = true;
+				VULKAN_DEBUG("VK_EXT_pipeline_creation_feedback extension enabled\n");
+			}
+			ERR_FAIL_COND_V(enabled_extension_count >= MAX_EXTENSIONS, ERR_BUG);
+		}
+
 		free(device_extensions);
 	}
 
@@ -1432,12 +1443,21 @@ VkPhysicalDeviceLimits VulkanContext::get_device_limits() const {
 	return gpu_props.limits;
 }
 
+const VkPhysicalDeviceProperties &VulkanContext::get_device_properties() const {
+	return gpu_props;
+}
+
+bool VulkanContext::is_pipeline_creation_feedback_enabled() const {
+	return VK_EXT_pipeline_creation_feedback_enabled;
+}
+
 VulkanContext::VulkanContext() {
 	command_buffer_count = 0;
 	instance_validation_layers = NULL;
 	use_validation_layers = true;
 	VK_KHR_incremental_present_enabled = true;
 	VK_GOOGLE_display_timing_enabled = true;
+	VK_EXT_pipeline_creation_feedback_enabled = false;
 
 	command_buffer_queue.resize(1); //first one is the setup command always
 	command_buffer_queue.write[0] = NULL;
@@ -117,6 +117,7 @@ class VulkanContext {
 	//extensions
 	bool VK_KHR_incremental_present_enabled;
 	bool VK_GOOGLE_display_timing_enabled;
+	bool VK_EXT_pipeline_creation_feedback_enabled;
 	const char **instance_validation_layers;
 	uint32_t enabled_extension_count;
 	uint32_t enabled_layer_count;
@@ -196,6 +197,8 @@ public:
 
 	VkFormat get_screen_format() const;
 	VkPhysicalDeviceLimits get_device_limits() const;
+	const VkPhysicalDeviceProperties &get_device_properties() const;
+	bool is_pipeline_creation_feedback_enabled() const;
 
 	void set_setup_buffer(const VkCommandBuffer &pCommandBuffer);
 	void append_command_buffer(const VkCommandBuffer &pCommandBuffer);
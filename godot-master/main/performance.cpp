@@ -44,6 +44,7 @@ Performance *Performance::singleton = NULL;
 void Performance::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_monitor", "monitor"), &Performance::get_monitor);
+	ClassDB::bind_method(D_METHOD("get_memory_size_classes"), &Performance::get_memory_size_classes);
 
 	BIND_ENUM_CONSTANT(TIME_FPS);
 	BIND_ENUM_CONSTANT(TIME_PROCESS);
@@ -74,10 +75,35 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(RENDER_OCCLUDERS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_OCCLUDED_OBJECTS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_STATE_CHANGES_SKIPPED_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_UPLOAD_BYTES_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_UPLOAD_STALLS_IN_FRAME);
+	BIND_ENUM_CONSTANT(TIME_MESSAGE_QUEUE_FLUSH);
+	BIND_ENUM_CONSTANT(RENDER_SYNC_CALLS_IN_FRAME);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
 
+Array Performance::get_memory_size_classes() const {
+
+	Array classes;
+	for (int i = 0; i < Memory::get_size_class_count(); i++) {
+
+		Memory::SizeClassStats stats = Memory::get_size_class_stats(i);
+
+		Dictionary d;
+		d["block_size"] = stats.block_size;
+		d["reserved"] = stats.reserved_blocks * stats.block_size;
+		d["used"] = stats.used_blocks * stats.block_size;
+		d["allocations"] = stats.alloc_count;
+		classes.push_back(d);
+	}
+
+	return classes;
+}
+
 float Performance::_get_node_count() const {
 	MainLoop *ml = OS::get_singleton()->get_main_loop();
 	SceneTree *sml = Object::cast_to<SceneTree>(ml);
@@ -120,6 +146,13 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"raster/occluders",
+		"raster/objects_occluded",
+		"raster/state_changes_skipped",
+		"raster/upload_bytes",
+		"raster/upload_stalls",
+		"time/message_queue_flush",
+		"raster/sync_calls",
 
 	};
 
@@ -140,7 +173,7 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case OBJECT_COUNT: return ObjectDB::get_object_count();
 		case OBJECT_RESOURCE_COUNT: return ResourceCache::get_cached_resource_count();
 		case OBJECT_NODE_COUNT: return _get_node_count();
-		case OBJECT_ORPHAN_NODE_COUNT: return Node::orphan_node_count;
+		case OBJECT_ORPHAN_NODE_COUNT: return Node::orphan_node_count.load();
 		case RENDER_OBJECTS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_OBJECTS_IN_FRAME);
 		case RENDER_VERTICES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_VERTICES_IN_FRAME);
 		case RENDER_MATERIAL_CHANGES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_MATERIAL_CHANGES_IN_FRAME);
@@ -158,6 +191,13 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY: return AudioServer::get_singleton()->get_output_latency();
+		case RENDER_OCCLUDERS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_OCCLUDERS_IN_FRAME);
+		case RENDER_OCCLUDED_OBJECTS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_OCCLUDED_OBJECTS_IN_FRAME);
+		case RENDER_STATE_CHANGES_SKIPPED_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_STATE_CHANGES_SKIPPED_IN_FRAME);
+		case RENDER_UPLOAD_BYTES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_UPLOAD_BYTES_IN_FRAME);
+		case RENDER_UPLOAD_STALLS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_UPLOAD_STALLS_IN_FRAME);
+		case TIME_MESSAGE_QUEUE_FLUSH: return MessageQueue::get_singleton()->get_last_flush_time_usec() / 1000000.0;
+		case RENDER_SYNC_CALLS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_SYNC_CALLS_IN_FRAME);
 
 		default: {
 		}
@@ -200,6 +240,13 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
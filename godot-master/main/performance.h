@@ -81,6 +81,13 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		RENDER_OCCLUDERS_IN_FRAME,
+		RENDER_OCCLUDED_OBJECTS_IN_FRAME,
+		RENDER_STATE_CHANGES_SKIPPED_IN_FRAME,
+		RENDER_UPLOAD_BYTES_IN_FRAME,
+		RENDER_UPLOAD_STALLS_IN_FRAME,
+		TIME_MESSAGE_QUEUE_FLUSH,
+		RENDER_SYNC_CALLS_IN_FRAME,
 		MONITOR_MAX
 	};
 
@@ -91,6 +98,7 @@ public:
 	};
 
 	float get_monitor(Monitor p_monitor) const;
+	Array get_memory_size_classes() const;
 	String get_monitor_name(Monitor p_monitor) const;
 
 	MonitorType get_monitor_type(Monitor p_monitor) const;
@@ -0,0 +1,115 @@
+/*************************************************************************/
+/*  test_benchmark.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_benchmark.h"
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/vector.h"
+
+#include <stdio.h>
+
+namespace TestBenchmark {
+
+struct WorkerData {
+	ThreadFunc func;
+	void *userdata;
+	int thread;
+	int thread_count;
+};
+
+static void _worker(void *p_user) {
+
+	WorkerData *data = (WorkerData *)p_user;
+	data->func(data->thread, data->thread_count, data->userdata);
+}
+
+uint64_t run_threads(int p_thread_count, ThreadFunc p_func, void *p_userdata, MainFunc p_main_func) {
+
+	OS *os = OS::get_singleton();
+
+	Vector<WorkerData> data;
+	data.resize(p_thread_count);
+	for (int i = 0; i < p_thread_count; i++) {
+		data.write[i].func = p_func;
+		data.write[i].userdata = p_userdata;
+		data.write[i].thread = i;
+		data.write[i].thread_count = p_thread_count;
+	}
+
+	Vector<Thread *> threads;
+	uint64_t from = os->get_ticks_usec();
+
+	for (int i = 0; i < p_thread_count; i++) {
+		threads.push_back(Thread::create(_worker, &data.write[i]));
+	}
+
+	if (p_main_func) {
+		p_main_func(p_thread_count, p_userdata);
+	}
+
+	for (int i = 0; i < p_thread_count; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	return os->get_ticks_usec() - from;
+}
+
+void run_scaling(int p_max_threads, ThreadFunc p_func, void *p_userdata, int p_operations, Work p_work, const char *p_operation, MainFunc p_main_func) {
+
+	for (int count = 1; count <= p_max_threads; count *= 2) {
+
+		uint64_t usec = run_threads(count, p_func, p_userdata, p_main_func);
+
+		char label[32];
+		snprintf(label, sizeof(label), "%2d threads:", count);
+		print_time(label, usec, p_work == WORK_PER_THREAD ? double(p_operations) * count : double(p_operations), p_operation);
+	}
+}
+
+void print_time(const char *p_label, uint64_t p_usec, double p_operations, const char *p_operation) {
+
+	if (p_operations > 0) {
+		OS::get_singleton()->print("%-14s %8d usec, %6.1f ns per %s\n", p_label, int(p_usec), double(p_usec) * 1000.0 / p_operations, p_operation);
+	} else {
+		OS::get_singleton()->print("%-14s %8d usec\n", p_label, int(p_usec));
+	}
+}
+
+void report(bool p_ok) {
+
+	OS::get_singleton()->print("\n%s\n", p_ok ? "All checks passed" : "Some checks FAILED");
+	if (!p_ok) {
+		OS::get_singleton()->set_exit_code(EXIT_FAILURE);
+	}
+}
+
+} // namespace TestBenchmark
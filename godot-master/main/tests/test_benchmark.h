@@ -0,0 +1,63 @@
+/*************************************************************************/
+/*  test_benchmark.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_BENCHMARK_H
+#define TEST_BENCHMARK_H
+
+#include "core/typedefs.h"
+
+// Helpers shared by the threaded benchmarks in main/tests.
+namespace TestBenchmark {
+
+// Runs on every worker thread, p_thread is its index.
+typedef void (*ThreadFunc)(int p_thread, int p_thread_count, void *p_userdata);
+// Runs on the calling thread while the workers are busy.
+typedef void (*MainFunc)(int p_thread_count, void *p_userdata);
+
+enum Work {
+	WORK_PER_THREAD, // every thread does all the operations
+	WORK_SPLIT, // the operations are split across the threads
+};
+
+// Runs p_func on p_thread_count threads at once and returns the elapsed microseconds.
+uint64_t run_threads(int p_thread_count, ThreadFunc p_func, void *p_userdata, MainFunc p_main_func = NULL);
+
+// Runs p_func on 1, 2, 4... up to p_max_threads threads, printing the time of each run.
+// The time per operation is only printed when p_operations is not zero.
+void run_scaling(int p_max_threads, ThreadFunc p_func, void *p_userdata, int p_operations, Work p_work, const char *p_operation, MainFunc p_main_func = NULL);
+
+void print_time(const char *p_label, uint64_t p_usec, double p_operations, const char *p_operation);
+
+// Prints the outcome of the correctness checks, and makes the process exit with an error if any failed.
+void report(bool p_ok);
+
+} // namespace TestBenchmark
+
+#endif // TEST_BENCHMARK_H
@@ -37,13 +37,21 @@
 #include "test_gdscript.h"
 #include "test_gui.h"
 #include "test_math.h"
+#include "test_memory.h"
 #include "test_oa_hash_map.h"
+#include "test_object_db.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
+#include "test_physics_replay.h"
+#include "test_physics_shapes.h"
 #include "test_render.h"
+#include "test_rid.h"
 #include "test_shader_lang.h"
+#include "test_signal.h"
 #include "test_string.h"
+#include "test_string_name.h"
+#include "test_visual_cull.h"
 
 const char **tests_get_names() {
 
@@ -62,6 +70,14 @@ const char **tests_get_names() {
 		"gd_bytecode",
 		"ordered_hash_map",
 		"astar",
+		"memory",
+		"string_name",
+		"signal",
+		"rid",
+		"physics_shapes",
+		"physics_replay",
+		"visual_cull",
+		"object_db",
 		NULL
 	};
 
@@ -142,6 +158,46 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "memory") {
+
+		return TestMemory::test();
+	}
+
+	if (p_test == "string_name") {
+
+		return TestStringName::test();
+	}
+
+	if (p_test == "signal") {
+
+		return TestSignal::test();
+	}
+
+	if (p_test == "rid") {
+
+		return TestRID::test();
+	}
+
+	if (p_test == "physics_shapes") {
+
+		return TestPhysicsShapes::test();
+	}
+
+	if (p_test == "physics_replay") {
+
+		return TestPhysicsReplay::test(p_args);
+	}
+
+	if (p_test == "visual_cull") {
+
+		return TestVisualCull::test();
+	}
+
+	if (p_test == "object_db") {
+
+		return TestObjectDB::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return NULL;
 }
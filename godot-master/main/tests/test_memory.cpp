@@ -0,0 +1,168 @@
+/*************************************************************************/
+/*  test_memory.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_memory.h"
+
+#include "core/list.h"
+#include "core/map.h"
+#include "core/os/os.h"
+#include "core/pool_vector.h"
+#include "core/variant.h"
+#include "test_benchmark.h"
+
+namespace TestMemory {
+
+#define BENCH_ITERATIONS 200000
+
+typedef void (*BenchFunc)();
+
+static void bench_raw() {
+
+	void *blocks[256] = {};
+	uint32_t seed = 1;
+
+	for (int i = 0; i < BENCH_ITERATIONS * 4; i++) {
+		seed = seed * 1103515245 + 12345;
+		int slot = (seed >> 8) & 255;
+		if (blocks[slot]) {
+			memfree(blocks[slot]);
+		}
+		blocks[slot] = memalloc(8 + ((seed >> 16) & 255));
+	}
+
+	for (int i = 0; i < 256; i++) {
+		if (blocks[i]) {
+			memfree(blocks[i]);
+		}
+	}
+}
+
+static void bench_list() {
+
+	List<int> list;
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		list.push_back(i);
+		if (i & 1) {
+			list.pop_front();
+		}
+	}
+}
+
+static void bench_map() {
+
+	Map<int, int> map;
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		map[(i * 7919) % 4096] = i;
+		if (i & 1) {
+			map.erase((i * 104729) % 4096);
+		}
+	}
+}
+
+static void bench_variant() {
+
+	for (int i = 0; i < BENCH_ITERATIONS / 10; i++) {
+		Array array;
+		Dictionary dict;
+		for (int j = 0; j < 10; j++) {
+			array.push_back(Variant(j));
+			dict[j] = String::num(j);
+		}
+		Variant v = array;
+		Variant w = dict;
+	}
+}
+
+static void bench_threaded_func(int p_thread, int p_thread_count, void *p_user) {
+
+	bench_raw();
+	bench_map();
+}
+
+static void bench_pool_vector_func(int p_thread, int p_thread_count, void *p_user) {
+
+	for (int i = 0; i < BENCH_ITERATIONS / 10; i++) {
+		PoolVector<int> a;
+		a.resize(16 + (i & 63));
+		{
+			PoolVector<int>::Write w = a.write();
+			w[0] = i;
+		}
+		PoolVector<int> b = a;
+		b.set(1, i); // copy on write
+		b.resize(8);
+	}
+}
+
+static void bench_threaded() {
+
+	TestBenchmark::run_threads(4, bench_threaded_func, NULL);
+}
+
+MainLoop *test() {
+
+	OS *os = OS::get_singleton();
+
+	struct Bench {
+		const char *name;
+		BenchFunc func;
+	};
+
+	const Bench benches[] = {
+		{ "raw memalloc/memfree", bench_raw },
+		{ "List push/pop", bench_list },
+		{ "Map insert/erase", bench_map },
+		{ "Array/Dictionary churn", bench_variant },
+		{ "4 threads raw + Map", bench_threaded },
+		{ NULL, NULL }
+	};
+
+	os->print("\n\nMemory allocator benchmark (%s)\n\n", Memory::get_size_class_count() ? "small object allocator" : "system allocator");
+
+	for (int i = 0; benches[i].name; i++) {
+		uint64_t from = os->get_ticks_usec();
+		benches[i].func();
+		os->print("%-26s %8d usec\n", benches[i].name, int(os->get_ticks_usec() - from));
+	}
+
+	os->print("\nPoolVector churn scaling\n");
+	TestBenchmark::run_scaling(8, bench_pool_vector_func, NULL, BENCH_ITERATIONS / 10, TestBenchmark::WORK_PER_THREAD, "vector");
+
+	if (Memory::get_size_class_count()) {
+		os->print("\nblock size   reserved       used   allocations\n");
+		for (int i = 0; i < Memory::get_size_class_count(); i++) {
+			Memory::SizeClassStats stats = Memory::get_size_class_stats(i);
+			os->print("%10d %10d %10d %13d\n", int(stats.block_size), int(stats.reserved_blocks * stats.block_size), int(stats.used_blocks * stats.block_size), int(stats.alloc_count));
+		}
+	}
+
+	return NULL;
+}
+} // namespace TestMemory
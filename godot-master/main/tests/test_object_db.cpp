@@ -0,0 +1,139 @@
+/*************************************************************************/
+/*  test_object_db.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_object_db.h"
+
+#include "core/os/os.h"
+#include "scene/main/node.h"
+#include "test_benchmark.h"
+
+#include <atomic>
+
+namespace TestObjectDB {
+
+#define NODE_COUNT 1000000
+#define NODE_BATCH 1024
+#define LOOKUP_NODES 4096
+#define LOOKUPS_PER_THREAD 4000000
+#define MAX_THREADS 8
+
+static std::atomic<int> failures(0);
+
+// Creates and frees nodes in batches, so slots get reused while other threads do the same.
+static void churn_thread(int p_thread, int p_thread_count, void *p_user) {
+
+	int count = NODE_COUNT / p_thread_count;
+
+	Node *nodes[NODE_BATCH];
+	ObjectID ids[NODE_BATCH];
+	int errors = 0;
+
+	for (int done = 0; done < count; done += NODE_BATCH) {
+
+		int batch = MIN(NODE_BATCH, count - done);
+
+		for (int i = 0; i < batch; i++) {
+			nodes[i] = memnew(Node);
+			ids[i] = nodes[i]->get_instance_id();
+		}
+
+		for (int i = 0; i < batch; i++) {
+			if (ObjectDB::get_instance(ids[i]) != nodes[i]) {
+				errors++;
+			}
+			memdelete(nodes[i]);
+		}
+
+		// a freed ID must not resolve, even once its slot is reused
+		for (int i = 0; i < batch; i++) {
+			if (ObjectDB::get_instance(ids[i]) != NULL) {
+				errors++;
+			}
+		}
+	}
+
+	failures += errors;
+}
+
+struct LookupData {
+	const ObjectID *ids;
+	const Node *const *nodes;
+};
+
+static void lookup_thread(int p_thread, int p_thread_count, void *p_user) {
+
+	LookupData *data = (LookupData *)p_user;
+	int offset = p_thread * 997;
+	int errors = 0;
+
+	for (int i = 0; i < LOOKUPS_PER_THREAD; i++) {
+		int index = (i * 31 + offset) % LOOKUP_NODES;
+		if (ObjectDB::get_instance(data->ids[index]) != data->nodes[index]) {
+			errors++;
+		}
+	}
+
+	failures += errors;
+}
+
+MainLoop *test() {
+
+	OS *os = OS::get_singleton();
+
+	os->print("\n\nObjectDB: create and free %d nodes, split across threads\n\n", NODE_COUNT);
+
+	TestBenchmark::run_scaling(MAX_THREADS, churn_thread, NULL, NODE_COUNT, TestBenchmark::WORK_SPLIT, "node");
+
+	os->print("\nObjectDB::get_instance(), %d lookups per thread on %d live nodes\n\n", LOOKUPS_PER_THREAD, LOOKUP_NODES);
+
+	Node *nodes[LOOKUP_NODES];
+	ObjectID ids[LOOKUP_NODES];
+	for (int i = 0; i < LOOKUP_NODES; i++) {
+		nodes[i] = memnew(Node);
+		ids[i] = nodes[i]->get_instance_id();
+	}
+
+	LookupData data;
+	data.ids = ids;
+	data.nodes = nodes;
+	TestBenchmark::run_scaling(MAX_THREADS, lookup_thread, &data, LOOKUPS_PER_THREAD, TestBenchmark::WORK_PER_THREAD, "lookup");
+
+	for (int i = 0; i < LOOKUP_NODES; i++) {
+		memdelete(nodes[i]);
+	}
+
+	if (failures > 0) {
+		os->print("\nFAIL: %d IDs resolved to the wrong node\n", failures.load());
+	}
+	TestBenchmark::report(failures == 0);
+
+	return NULL;
+}
+} // namespace TestObjectDB
@@ -0,0 +1,223 @@
+/*************************************************************************/
+/*  test_physics_replay.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_physics_replay.h"
+
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "servers/physics/physics_server_sw.h"
+
+namespace TestPhysicsReplay {
+
+#define STEP_COUNT 600
+#define STEP_TIME (1.0 / 60.0)
+#define PILE_SIZE 5
+#define PILE_LAYERS 6
+
+struct StepRecord {
+	uint32_t active_objects;
+	uint32_t state_hash;
+};
+
+// Drops a pile of boxes and spheres on a floor and records the state hash of every step.
+static void run_scene(PhysicsServerSW *p_server, Vector<StepRecord> &r_records) {
+
+	PhysicsServer *ps = p_server;
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	List<RID> shapes;
+	List<RID> bodies;
+
+	RID floor_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+	ps->shape_set_data(floor_shape, Vector3(50, 1, 50));
+	shapes.push_back(floor_shape);
+
+	RID box_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+	ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+	shapes.push_back(box_shape);
+
+	RID sphere_shape = ps->shape_create(PhysicsServer::SHAPE_SPHERE);
+	ps->shape_set_data(sphere_shape, 0.5);
+	shapes.push_back(sphere_shape);
+
+	RID floor = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+	ps->body_add_shape(floor, floor_shape);
+	ps->body_set_state(floor, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(), Vector3(0, -1, 0)));
+	ps->body_set_space(floor, space);
+	bodies.push_back(floor);
+
+	// Offsets and rotations vary per body so the pile collapses instead of stacking neatly.
+	for (int y = 0; y < PILE_LAYERS; y++) {
+		for (int z = 0; z < PILE_SIZE; z++) {
+			for (int x = 0; x < PILE_SIZE; x++) {
+
+				int index = (y * PILE_SIZE + z) * PILE_SIZE + x;
+				Vector3 origin(x * 1.1 + (index % 3) * 0.1, 0.6 + y * 1.2, z * 1.1 + (index % 5) * 0.05);
+
+				RID body = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+				ps->body_add_shape(body, index % 4 == 0 ? sphere_shape : box_shape);
+				ps->body_set_state(body, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(Vector3(0, 1, 0), index * 0.2), origin));
+				ps->body_set_space(body, space);
+				bodies.push_back(body);
+			}
+		}
+	}
+
+	r_records.resize(STEP_COUNT);
+	for (int i = 0; i < STEP_COUNT; i++) {
+
+		ps->flush_queries();
+		ps->step(STEP_TIME);
+
+		r_records.write[i].active_objects = ps->get_process_info(PhysicsServer::INFO_ACTIVE_OBJECTS);
+		r_records.write[i].state_hash = p_server->space_get_state_hash(space);
+	}
+
+	for (List<RID>::Element *E = bodies.front(); E; E = E->next()) {
+		ps->free(E->get());
+	}
+	for (List<RID>::Element *E = shapes.front(); E; E = E->next()) {
+		ps->free(E->get());
+	}
+	ps->free(space);
+}
+
+// Same layout as the records written to "physics/3d/deterministic_step_log".
+static void save_log(FileAccess *p_file, const Vector<StepRecord> &p_records) {
+
+	for (int i = 0; i < p_records.size(); i++) {
+		p_file->store_64(i);
+		p_file->store_64(0);
+		p_file->store_real(STEP_TIME);
+		p_file->store_32(p_records[i].active_objects);
+		p_file->store_32(p_records[i].state_hash);
+	}
+}
+
+static bool check_log(FileAccess *p_file, const Vector<StepRecord> &p_records) {
+
+	OS *os = OS::get_singleton();
+
+	for (int i = 0; i < p_records.size(); i++) {
+
+		p_file->get_64();
+		p_file->get_64();
+		p_file->get_real();
+		uint32_t active_objects = p_file->get_32();
+		uint32_t state_hash = p_file->get_32();
+
+		if (p_file->eof_reached()) {
+			os->print("Log ends at step %d, expected %d steps\n", i, p_records.size());
+			return false;
+		}
+
+		if (active_objects != p_records[i].active_objects || state_hash != p_records[i].state_hash) {
+			os->print("First desync at step %d: logged hash %08x with %d active bodies, replayed %08x with %d\n", i, state_hash, active_objects, p_records[i].state_hash, p_records[i].active_objects);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Usage: --test physics_replay [log]
+// Records the log if it does not exist, otherwise replays the scene and compares every step against it.
+// Run it on two machines or builds with the same log to find where their simulations diverge.
+MainLoop *test(const List<String> &p_args) {
+
+	OS *os = OS::get_singleton();
+
+	PhysicsServerSW *server = PhysicsServerSW::singleton;
+	if (!server || PhysicsServer::get_singleton() != server) {
+		os->print("The replay needs GodotPhysics without the threaded wrapper.\n");
+		os->set_exit_code(EXIT_FAILURE);
+		return NULL;
+	}
+
+	String log_path;
+	for (const List<String>::Element *E = p_args.front(); E; E = E->next()) {
+		if (E->get() == "physics_replay" && E->next() && !E->next()->get().begins_with("-")) {
+			log_path = E->next()->get();
+			break;
+		}
+	}
+
+	bool was_deterministic = server->is_deterministic();
+	server->set_deterministic(true);
+
+	Vector<StepRecord> records;
+	run_scene(server, records);
+
+	server->set_deterministic(was_deterministic);
+
+	os->print("Stepped %d times, final state hash %08x\n", records.size(), records[records.size() - 1].state_hash);
+
+	if (log_path == String()) {
+		return NULL;
+	}
+
+	if (!FileAccess::exists(log_path)) {
+
+		FileAccess *f = FileAccess::open(log_path, FileAccess::WRITE);
+		if (!f) {
+			os->print("Cannot write %s\n", log_path.utf8().get_data());
+			os->set_exit_code(EXIT_FAILURE);
+			return NULL;
+		}
+
+		save_log(f, records);
+		f->close();
+		memdelete(f);
+
+		os->print("Recorded %s\n", log_path.utf8().get_data());
+		return NULL;
+	}
+
+	FileAccess *f = FileAccess::open(log_path, FileAccess::READ);
+	if (!f) {
+		os->print("Cannot read %s\n", log_path.utf8().get_data());
+		os->set_exit_code(EXIT_FAILURE);
+		return NULL;
+	}
+
+	bool ok = check_log(f, records);
+	f->close();
+	memdelete(f);
+
+	os->print("\n%s\n", ok ? "Replay matches the log" : "Replay FAILED");
+	if (!ok) {
+		os->set_exit_code(EXIT_FAILURE);
+	}
+
+	return NULL;
+}
+} // namespace TestPhysicsReplay
@@ -0,0 +1,677 @@
+/*************************************************************************/
+/*  test_physics_shapes.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_physics_shapes.h"
+
+#include "core/math/face3.h"
+#include "core/math/geometry.h"
+#include "core/os/os.h"
+#include "servers/physics/collision_solver_sw.h"
+#include "servers/physics/shape_sw.h"
+#include "test_benchmark.h"
+
+namespace TestPhysicsShapes {
+
+#define CONVEX_POINTS 64
+#define SAMPLE_COUNT 1024
+#define EQUIVALENCE_ITERATIONS 20000
+#define PROJECTION_ITERATIONS 2000000
+#define COLLISION_ITERATIONS 200000
+#define DEPTH_TOLERANCE 0.001
+#define HULL_DEPTH_TOLERANCE 0.006
+#define HEIGHTMAP_WIDTH 37
+#define HEIGHTMAP_DEPTH 22
+#define HEIGHTMAP_CELL_SIZE 0.75
+#define HEIGHTMAP_SEGMENTS 5000
+#define HEIGHTMAP_CULLS 2000
+#define HEIGHTMAP_TOLERANCE 0.001
+
+static uint32_t seed = 1;
+
+static real_t rand_unit() {
+
+	seed = seed * 1103515245 + 12345;
+	return real_t(seed >> 8) / real_t(1 << 24);
+}
+
+static real_t rand_range(real_t p_from, real_t p_to) {
+
+	return p_from + (p_to - p_from) * rand_unit();
+}
+
+static Vector3 rand_direction() {
+
+	while (true) {
+		Vector3 v(rand_range(-1, 1), rand_range(-1, 1), rand_range(-1, 1));
+		if (v.length_squared() > 0.01) {
+			return v.normalized();
+		}
+	}
+}
+
+static Transform rand_transform(real_t p_spread) {
+
+	Transform xform;
+	xform.basis = Basis(rand_direction(), rand_range(0, Math_PI * 2));
+	xform.origin = Vector3(rand_range(-p_spread, p_spread), rand_range(-p_spread, p_spread), rand_range(-p_spread, p_spread));
+	return xform;
+}
+
+// How ConvexPolygonShapeSW projected before it worked in shape space, kept as the reference.
+static void reference_project_range(const ConvexPolygonShapeSW *p_shape, const Vector3 &p_normal, const Transform &p_transform, real_t &r_min, real_t &r_max) {
+
+	const Vector<Vector3> &vertices = p_shape->get_mesh().vertices;
+
+	for (int i = 0; i < vertices.size(); i++) {
+
+		real_t d = p_normal.dot(p_transform.xform(vertices[i]));
+
+		if (i == 0 || d > r_max)
+			r_max = d;
+		if (i == 0 || d < r_min)
+			r_min = d;
+	}
+}
+
+static real_t reference_support_distance(const ConvexPolygonShapeSW *p_shape, const Vector3 &p_normal) {
+
+	const Vector<Vector3> &vertices = p_shape->get_mesh().vertices;
+
+	real_t max = 0;
+	for (int i = 0; i < vertices.size(); i++) {
+		real_t d = p_normal.dot(vertices[i]);
+		if (i == 0 || d > max)
+			max = d;
+	}
+
+	return max;
+}
+
+struct ContactResult {
+
+	int count;
+	real_t depth;
+};
+
+static void contact_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata) {
+
+	ContactResult *result = (ContactResult *)p_userdata;
+	result->count++;
+	result->depth = MAX(result->depth, p_point_A.distance_to(p_point_B));
+}
+
+static bool solve(const ShapeSW *p_shape_A, const Transform &p_transform_A, const ShapeSW *p_shape_B, const Transform &p_transform_B, ContactResult &r_result) {
+
+	r_result.count = 0;
+	r_result.depth = 0;
+	return CollisionSolverSW::solve_static(p_shape_A, p_transform_A, p_shape_B, p_transform_B, contact_callback, &r_result);
+}
+
+static bool test_projection(OS *p_os, const ConvexPolygonShapeSW *p_convex) {
+
+	int failures = 0;
+
+	for (int i = 0; i < EQUIVALENCE_ITERATIONS; i++) {
+
+		Vector3 normal = rand_direction();
+		Transform xform = rand_transform(10);
+
+		real_t min, max, ref_min, ref_max;
+		p_convex->project_range(normal, xform, min, max);
+		reference_project_range(p_convex, normal, xform, ref_min, ref_max);
+
+		if (Math::abs(min - ref_min) > CMP_EPSILON * 100 || Math::abs(max - ref_max) > CMP_EPSILON * 100) {
+			failures++;
+		}
+
+		// several vertices may be tied, so compare how far the support reaches instead
+		if (Math::abs(normal.dot(p_convex->get_support(normal)) - reference_support_distance(p_convex, normal)) > CMP_EPSILON) {
+			failures++;
+		}
+	}
+
+	p_os->print("projection and support match the per vertex reference: %s (%d failures)\n", failures ? "FAIL" : "OK", failures);
+	return failures == 0;
+}
+
+// A box and a convex hull of its corners take different paths through the
+// separating axis solver, but must produce the same contacts against every
+// shape, curved ones included. Depth and contact count are compared for all of
+// them. Against spheres and capsules the depths agree to float rounding.
+// Between two polyhedra several axes can be within rounding of the least
+// penetration, and each path may settle on a different one. Against the random
+// hull, its edge pairs are also pruned by face adjacency, and QuickHull leaves
+// input points a few millimeters outside its faces. Up to about 1e-4 (boxes)
+// and 6e-3 (hull) was measured, hence DEPTH_TOLERANCE plus 1% of the depth,
+// and HULL_DEPTH_TOLERANCE in place of DEPTH_TOLERANCE against the hull.
+static bool test_contacts(OS *p_os, const BoxShapeSW *p_box, const ConvexPolygonShapeSW *p_convex_box, const ShapeSW *const *p_others, const char *const *p_other_names, int p_other_count) {
+
+	bool ok = true;
+
+	for (int i = 0; i < p_other_count; i++) {
+
+		int tested = 0;
+		int failures = 0;
+		real_t base_tolerance = p_others[i]->get_type() == PhysicsServer::SHAPE_CONVEX_POLYGON ? HULL_DEPTH_TOLERANCE : DEPTH_TOLERANCE;
+
+		for (int j = 0; j < EQUIVALENCE_ITERATIONS; j++) {
+
+			Transform xform_A = rand_transform(0);
+			Transform xform_B = rand_transform(1.5);
+
+			ContactResult box_result, convex_result;
+			bool box_collided = solve(p_box, xform_A, p_others[i], xform_B, box_result);
+			bool convex_collided = solve(p_convex_box, xform_A, p_others[i], xform_B, convex_result);
+
+			if (box_collided != convex_collided) {
+				// only grazing contacts may come out differently
+				if (MAX(box_result.depth, convex_result.depth) > base_tolerance) {
+					failures++;
+				}
+				continue;
+			}
+
+			if (!box_collided) {
+				continue;
+			}
+
+			tested++;
+
+			// see above for why the tolerance grows with the depth
+			real_t tolerance = base_tolerance + box_result.depth * 0.01;
+			if (Math::abs(box_result.depth - convex_result.depth) > tolerance || box_result.count != convex_result.count) {
+				failures++;
+			}
+		}
+
+		p_os->print("box and convex box against %s, %d contacts compared: %s (%d failures)\n", p_other_names[i], tested, failures ? "FAIL" : "OK", failures);
+		ok = ok && failures == 0;
+	}
+
+	return ok;
+}
+
+static PoolVector<real_t> make_heights() {
+
+	PoolVector<real_t> heights;
+	heights.resize(HEIGHTMAP_WIDTH * HEIGHTMAP_DEPTH);
+	PoolVector<real_t>::Write w = heights.write();
+
+	for (int z = 0; z < HEIGHTMAP_DEPTH; z++) {
+		for (int x = 0; x < HEIGHTMAP_WIDTH; x++) {
+			// rolling hills well above zero, with a flat plateau
+			real_t h = 2.5 + Math::sin(x * 0.4) * 1.5 + Math::cos(z * 0.3) + rand_range(-0.2, 0.2);
+			if (x >= 10 && x < 16 && z >= 5 && z < 11) {
+				h = 3.0;
+			}
+			w[z * HEIGHTMAP_WIDTH + x] = h;
+		}
+	}
+
+	return heights;
+}
+
+static HeightMapShapeSW *make_heightmap(const PoolVector<real_t> &p_heights, bool p_compressed) {
+
+	Dictionary d;
+	d["width"] = HEIGHTMAP_WIDTH;
+	d["depth"] = HEIGHTMAP_DEPTH;
+	d["cell_size"] = HEIGHTMAP_CELL_SIZE;
+	d["compressed"] = p_compressed;
+	d["heights"] = p_heights;
+
+	HeightMapShapeSW *heightmap = memnew(HeightMapShapeSW);
+	heightmap->set_data(d);
+	return heightmap;
+}
+
+// Laid out like HeightMapShapeSW does, the grid is centered on the shape origin in XZ.
+static Vector3 heightmap_grid_origin(const HeightMapShapeSW *p_heightmap) {
+
+	real_t cell_size = p_heightmap->get_cell_size();
+	return Vector3((p_heightmap->get_width() - 1) * cell_size * -0.5, 0, (p_heightmap->get_depth() - 1) * cell_size * -0.5);
+}
+
+static Vector3 heightmap_point(const HeightMapShapeSW *p_heightmap, const real_t *p_heights, int p_x, int p_z) {
+
+	real_t cell_size = p_heightmap->get_cell_size();
+	return heightmap_grid_origin(p_heightmap) + Vector3(p_x * cell_size, p_heights[p_z * p_heightmap->get_width() + p_x], p_z * cell_size);
+}
+
+// Both triangles of a cell, split along the same diagonal as HeightMapShapeSW.
+static void heightmap_triangle(const HeightMapShapeSW *p_heightmap, const real_t *p_heights, int p_x, int p_z, int p_half, Vector3 *r_vertices) {
+
+	if (p_half == 0) {
+		r_vertices[0] = heightmap_point(p_heightmap, p_heights, p_x, p_z);
+		r_vertices[1] = heightmap_point(p_heightmap, p_heights, p_x + 1, p_z);
+		r_vertices[2] = heightmap_point(p_heightmap, p_heights, p_x, p_z + 1);
+	} else {
+		r_vertices[0] = heightmap_point(p_heightmap, p_heights, p_x + 1, p_z);
+		r_vertices[1] = heightmap_point(p_heightmap, p_heights, p_x + 1, p_z + 1);
+		r_vertices[2] = heightmap_point(p_heightmap, p_heights, p_x, p_z + 1);
+	}
+}
+
+// Tests the segment against every triangle. On a shared edge or vertex, the
+// normal of any triangle touching the closest hit is correct.
+static bool reference_heightmap_segment(const HeightMapShapeSW *p_heightmap, const real_t *p_heights, const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector<Vector3> &r_normals) {
+
+	int width = p_heightmap->get_width();
+	int depth = p_heightmap->get_depth();
+	real_t closest = -1;
+
+	for (int z = 0; z < depth - 1; z++) {
+		for (int x = 0; x < width - 1; x++) {
+			for (int half = 0; half < 2; half++) {
+
+				Vector3 v[3];
+				heightmap_triangle(p_heightmap, p_heights, x, z, half, v);
+
+				Vector3 res;
+				if (Geometry::segment_intersects_triangle(p_begin, p_end, v[0], v[1], v[2], &res)) {
+					real_t d = p_begin.distance_to(res);
+					if (closest < 0 || d < closest) {
+						closest = d;
+						r_point = res;
+					}
+				}
+			}
+		}
+	}
+
+	if (closest < 0) {
+		return false;
+	}
+
+	r_normals.clear();
+	for (int z = 0; z < depth - 1; z++) {
+		for (int x = 0; x < width - 1; x++) {
+			for (int half = 0; half < 2; half++) {
+
+				Vector3 v[3];
+				heightmap_triangle(p_heightmap, p_heights, x, z, half, v);
+
+				Face3 face(v[0], v[1], v[2]);
+				if (face.get_closest_point_to(r_point).distance_to(r_point) < HEIGHTMAP_TOLERANCE) {
+					r_normals.push_back(Plane(v[0], v[1], v[2]).normal);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+static real_t heightmap_grid_line(const HeightMapShapeSW *p_heightmap, int p_axis, int p_index) {
+
+	return heightmap_grid_origin(p_heightmap)[p_axis] + p_index * p_heightmap->get_cell_size();
+}
+
+// Random segments, many of them starting outside the grid, plus segments that
+// run exactly along the cell edges: vertical ones on grid lines and vertices,
+// and sloped ones along grid lines and cell diagonals.
+static void make_heightmap_segments(const HeightMapShapeSW *p_heightmap, Vector3 *r_begins, Vector3 *r_ends) {
+
+	AABB aabb = p_heightmap->get_aabb();
+	AABB around = aabb.grow(2);
+	real_t top = aabb.position.y + aabb.size.y + 1;
+	real_t bottom = aabb.position.y - 1;
+	int width = p_heightmap->get_width();
+	int depth = p_heightmap->get_depth();
+
+	for (int i = 0; i < HEIGHTMAP_SEGMENTS; i++) {
+
+		int grid_x = Math::fast_ftoi(rand_range(0, width - 1));
+		int grid_z = Math::fast_ftoi(rand_range(0, depth - 1));
+		real_t line_x = heightmap_grid_line(p_heightmap, 0, grid_x);
+		real_t line_z = heightmap_grid_line(p_heightmap, 2, grid_z);
+		real_t free_x = rand_range(aabb.position.x, aabb.position.x + aabb.size.x);
+		real_t free_z = rand_range(aabb.position.z, aabb.position.z + aabb.size.z);
+
+		switch (i % 6) {
+			case 0: {
+				r_begins[i] = around.position + Vector3(rand_unit(), rand_unit(), rand_unit()) * around.size;
+				r_ends[i] = around.position + Vector3(rand_unit(), rand_unit(), rand_unit()) * around.size;
+			} break;
+			case 1: {
+				r_begins[i] = Vector3(line_x, top, line_z);
+				r_ends[i] = Vector3(line_x, bottom, line_z);
+			} break;
+			case 2: {
+				r_begins[i] = Vector3(line_x, top, free_z);
+				r_ends[i] = Vector3(line_x, bottom, free_z);
+			} break;
+			case 3: {
+				r_begins[i] = Vector3(free_x, top, line_z);
+				r_ends[i] = Vector3(free_x, bottom, line_z);
+			} break;
+			case 4: {
+				// along a grid line, from outside the grid and sloping into the terrain
+				if (i & 1) {
+					r_begins[i] = Vector3(around.position.x, top, line_z);
+					r_ends[i] = Vector3(around.position.x + around.size.x, rand_range(bottom, top), line_z);
+				} else {
+					r_begins[i] = Vector3(line_x, top, around.position.z + around.size.z);
+					r_ends[i] = Vector3(line_x, rand_range(bottom, top), around.position.z);
+				}
+			} break;
+			case 5: {
+				// through a vertex, along the diagonal that splits the cells or across it
+				Vector3 dir = (i & 1) ? Vector3(1, 0, -1) : Vector3(1, 0, 1);
+				Vector3 vertex(line_x, 0, line_z);
+				r_begins[i] = vertex - dir * aabb.size.x + Vector3(0, top, 0);
+				r_ends[i] = vertex + dir * aabb.size.x + Vector3(0, rand_range(bottom, top), 0);
+			} break;
+		}
+	}
+}
+
+static bool test_heightmap_segments(OS *p_os, const char *p_name, const HeightMapShapeSW *p_heightmap, const Vector3 *p_begins, const Vector3 *p_ends) {
+
+	PoolVector<real_t> heights = p_heightmap->get_heights();
+	PoolVector<real_t>::Read r = heights.read();
+
+	int hits = 0;
+	int failures = 0;
+
+	for (int i = 0; i < HEIGHTMAP_SEGMENTS; i++) {
+
+		Vector3 point, normal, ref_point;
+		Vector<Vector3> ref_normals;
+		bool hit = p_heightmap->intersect_segment(p_begins[i], p_ends[i], point, normal);
+		bool ref_hit = reference_heightmap_segment(p_heightmap, r.ptr(), p_begins[i], p_ends[i], ref_point, ref_normals);
+
+		if (hit != ref_hit) {
+			failures++;
+			continue;
+		}
+
+		if (!hit) {
+			continue;
+		}
+
+		hits++;
+
+		bool normal_ok = false;
+		for (int j = 0; j < ref_normals.size(); j++) {
+			normal_ok = normal_ok || normal.dot(ref_normals[j]) > 1.0 - HEIGHTMAP_TOLERANCE;
+		}
+
+		if (point.distance_to(ref_point) > HEIGHTMAP_TOLERANCE || !normal_ok) {
+			failures++;
+		}
+	}
+
+	p_os->print("%s heightmap intersect_segment against every triangle, %d hits compared: %s (%d failures)\n", p_name, hits, failures ? "FAIL" : "OK", failures);
+	return failures == 0;
+}
+
+struct HeightmapCullResult {
+
+	const HeightMapShapeSW *heightmap;
+	const real_t *heights;
+	Vector<int> counts; // times each triangle was reported, two per cell
+	int wrong_faces; // faces whose vertices don't match the grid
+};
+
+static void heightmap_cull_callback(void *p_userdata, ShapeSW *p_convex) {
+
+	HeightmapCullResult *result = (HeightmapCullResult *)p_userdata;
+	const FaceShapeSW *face = static_cast<const FaceShapeSW *>(p_convex);
+	const HeightMapShapeSW *heightmap = result->heightmap;
+
+	// both triangles of a cell end on its (x, z + 1) vertex, only the second one starts on the far side
+	Vector3 grid = (face->vertex[2] - heightmap_grid_origin(heightmap)) / heightmap->get_cell_size();
+	int x = Math::fast_ftoi(Math::round(grid.x));
+	int z = Math::fast_ftoi(Math::round(grid.z)) - 1;
+	int half = face->vertex[1].z > face->vertex[0].z ? 1 : 0;
+
+	if (x < 0 || x >= heightmap->get_width() - 1 || z < 0 || z >= heightmap->get_depth() - 1) {
+		result->wrong_faces++;
+		return;
+	}
+
+	Vector3 v[3];
+	heightmap_triangle(heightmap, result->heights, x, z, half, v);
+	for (int i = 0; i < 3; i++) {
+		if (face->vertex[i].distance_to(v[i]) > CMP_EPSILON) {
+			result->wrong_faces++;
+			return;
+		}
+	}
+
+	result->counts.write[(z * (heightmap->get_width() - 1) + x) * 2 + half]++;
+}
+
+// Every triangle overlapping the box must be reported once. Culling works per
+// cell, so the other triangle of a reported cell may come along, as may cells
+// that only touch the box.
+static bool test_heightmap_cull(OS *p_os, const char *p_name, const HeightMapShapeSW *p_heightmap) {
+
+	PoolVector<real_t> heights = p_heightmap->get_heights();
+	PoolVector<real_t>::Read r = heights.read();
+
+	int width = p_heightmap->get_width();
+	int depth = p_heightmap->get_depth();
+	AABB around = p_heightmap->get_aabb().grow(1);
+
+	HeightmapCullResult result;
+	result.heightmap = p_heightmap;
+	result.heights = r.ptr();
+	result.counts.resize((width - 1) * (depth - 1) * 2);
+
+	int reported = 0;
+	int failures = 0;
+
+	for (int i = 0; i < HEIGHTMAP_CULLS; i++) {
+
+		AABB query;
+		query.position = around.position + Vector3(rand_unit(), rand_unit(), rand_unit()) * around.size;
+		query.size = Vector3(rand_range(0.1, 4), rand_range(0.1, 2), rand_range(0.1, 4));
+		if (i & 1) {
+			// start and end on grid lines
+			query.position.x = heightmap_grid_line(p_heightmap, 0, Math::fast_ftoi(rand_range(-2, width + 1)));
+			query.position.z = heightmap_grid_line(p_heightmap, 2, Math::fast_ftoi(rand_range(-2, depth + 1)));
+			query.size.x = Math::fast_ftoi(rand_range(1, 5)) * p_heightmap->get_cell_size();
+			query.size.z = Math::fast_ftoi(rand_range(1, 5)) * p_heightmap->get_cell_size();
+		}
+
+		for (int j = 0; j < result.counts.size(); j++) {
+			result.counts.write[j] = 0;
+		}
+		result.wrong_faces = 0;
+
+		p_heightmap->cull(query, heightmap_cull_callback, &result);
+
+		failures += result.wrong_faces;
+
+		for (int z = 0; z < depth - 1; z++) {
+			for (int x = 0; x < width - 1; x++) {
+
+				AABB cell_aabb;
+				for (int half = 0; half < 2; half++) {
+
+					Vector3 v[3];
+					heightmap_triangle(p_heightmap, r.ptr(), x, z, half, v);
+					AABB triangle_aabb(v[0], Vector3());
+					triangle_aabb.expand_to(v[1]);
+					triangle_aabb.expand_to(v[2]);
+					cell_aabb = half == 0 ? triangle_aabb : cell_aabb.merge(triangle_aabb);
+
+					int count = result.counts[(z * (width - 1) + x) * 2 + half];
+					reported += count;
+					if (count > 1 || (count == 0 && triangle_aabb.intersects(query))) {
+						failures++;
+					}
+				}
+
+				bool cell_reported = result.counts[(z * (width - 1) + x) * 2] || result.counts[(z * (width - 1) + x) * 2 + 1];
+				if (cell_reported && !cell_aabb.intersects_inclusive(query)) {
+					failures++;
+				}
+			}
+		}
+	}
+
+	p_os->print("%s heightmap cull against every triangle, %d faces reported: %s (%d failures)\n", p_name, reported, failures ? "FAIL" : "OK", failures);
+	return failures == 0;
+}
+
+static void benchmark_projection(OS *p_os, const ConvexPolygonShapeSW *p_convex, const Vector3 *p_normals, const Transform *p_transforms) {
+
+	real_t sum = 0;
+
+	uint64_t from = p_os->get_ticks_usec();
+	for (int i = 0; i < PROJECTION_ITERATIONS; i++) {
+		real_t min, max;
+		reference_project_range(p_convex, p_normals[i % SAMPLE_COUNT], p_transforms[i % SAMPLE_COUNT], min, max);
+		sum += max - min;
+	}
+	uint64_t reference_usec = p_os->get_ticks_usec() - from;
+
+	from = p_os->get_ticks_usec();
+	for (int i = 0; i < PROJECTION_ITERATIONS; i++) {
+		real_t min, max;
+		p_convex->project_range(p_normals[i % SAMPLE_COUNT], p_transforms[i % SAMPLE_COUNT], min, max);
+		sum -= max - min;
+	}
+	uint64_t usec = p_os->get_ticks_usec() - from;
+
+	p_os->print("project_range, %d vertices: %6.1f ns per call, per vertex reference %6.1f ns (checksum %g)\n", p_convex->get_mesh().vertices.size(), double(usec) * 1000.0 / PROJECTION_ITERATIONS, double(reference_usec) * 1000.0 / PROJECTION_ITERATIONS, double(sum));
+
+	from = p_os->get_ticks_usec();
+	for (int i = 0; i < PROJECTION_ITERATIONS; i++) {
+		sum += p_convex->get_support(p_normals[i % SAMPLE_COUNT]).x;
+	}
+	usec = p_os->get_ticks_usec() - from;
+
+	p_os->print("get_support, %d vertices: %6.1f ns per call (checksum %g)\n", p_convex->get_mesh().vertices.size(), double(usec) * 1000.0 / PROJECTION_ITERATIONS, double(sum));
+}
+
+static void benchmark_collision(OS *p_os, const char *p_name, const ShapeSW *p_shape_A, const ShapeSW *p_shape_B, const Transform *p_transforms) {
+
+	int collided = 0;
+	ContactResult result;
+
+	uint64_t from = p_os->get_ticks_usec();
+	for (int i = 0; i < COLLISION_ITERATIONS; i++) {
+		if (solve(p_shape_A, Transform(), p_shape_B, p_transforms[i % SAMPLE_COUNT], result)) {
+			collided++;
+		}
+	}
+	uint64_t usec = p_os->get_ticks_usec() - from;
+
+	p_os->print("solve_static %s: %6.1f ns per pair, %d%% colliding\n", p_name, double(usec) * 1000.0 / COLLISION_ITERATIONS, collided * 100 / COLLISION_ITERATIONS);
+}
+
+MainLoop *test() {
+
+	OS *os = OS::get_singleton();
+
+	Vector3 half_extents(0.5, 0.75, 1.0);
+
+	BoxShapeSW *box = memnew(BoxShapeSW);
+	box->set_data(half_extents);
+
+	Vector<Vector3> corners;
+	for (int i = 0; i < 8; i++) {
+		corners.push_back(AABB(-half_extents, half_extents * 2).get_endpoint(i));
+	}
+	ConvexPolygonShapeSW *convex_box = memnew(ConvexPolygonShapeSW);
+	convex_box->set_data(corners);
+
+	Vector<Vector3> points;
+	for (int i = 0; i < CONVEX_POINTS; i++) {
+		points.push_back(rand_direction() * rand_range(0.5, 1.0));
+	}
+	ConvexPolygonShapeSW *convex = memnew(ConvexPolygonShapeSW);
+	convex->set_data(points);
+
+	SphereShapeSW *sphere = memnew(SphereShapeSW);
+	sphere->set_data(0.6);
+
+	CapsuleShapeSW *capsule = memnew(CapsuleShapeSW);
+	Dictionary capsule_params;
+	capsule_params["radius"] = 0.4;
+	capsule_params["height"] = 1.2;
+	capsule->set_data(capsule_params);
+
+	os->print("\n\nGodotPhysics narrow phase shapes\n\n");
+
+	bool ok = test_projection(os, convex);
+
+	const ShapeSW *others[] = { sphere, box, capsule, convex };
+	const char *other_names[] = { "sphere", "box", "capsule", "convex" };
+	ok = test_contacts(os, box, convex_box, others, other_names, 4) && ok;
+
+	PoolVector<real_t> heights = make_heights();
+	HeightMapShapeSW *heightmap = make_heightmap(heights, false);
+	HeightMapShapeSW *compressed_heightmap = make_heightmap(heights, true);
+
+	Vector3 segment_begins[HEIGHTMAP_SEGMENTS];
+	Vector3 segment_ends[HEIGHTMAP_SEGMENTS];
+	make_heightmap_segments(heightmap, segment_begins, segment_ends);
+
+	ok = test_heightmap_segments(os, "float", heightmap, segment_begins, segment_ends) && ok;
+	ok = test_heightmap_segments(os, "compressed", compressed_heightmap, segment_begins, segment_ends) && ok;
+	ok = test_heightmap_cull(os, "float", heightmap) && ok;
+	ok = test_heightmap_cull(os, "compressed", compressed_heightmap) && ok;
+
+	os->print("\n");
+
+	Vector3 normals[SAMPLE_COUNT];
+	Transform transforms[SAMPLE_COUNT];
+	for (int i = 0; i < SAMPLE_COUNT; i++) {
+		normals[i] = rand_direction();
+		transforms[i] = rand_transform(1.5);
+	}
+
+	benchmark_projection(os, convex, normals, transforms);
+
+	benchmark_collision(os, "box / box", box, box, transforms);
+	benchmark_collision(os, "box / capsule", box, capsule, transforms);
+	benchmark_collision(os, "convex box / box", convex_box, box, transforms);
+	benchmark_collision(os, "convex box / capsule", convex_box, capsule, transforms);
+	benchmark_collision(os, "convex / box", convex, box, transforms);
+	benchmark_collision(os, "convex / convex", convex, convex, transforms);
+
+	TestBenchmark::report(ok);
+
+	memdelete(box);
+	memdelete(convex_box);
+	memdelete(convex);
+	memdelete(sphere);
+	memdelete(capsule);
+	memdelete(heightmap);
+	memdelete(compressed_heightmap);
+
+	return NULL;
+}
+} // namespace TestPhysicsShapes
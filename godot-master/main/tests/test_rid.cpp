@@ -0,0 +1,132 @@
+/*************************************************************************/
+/*  test_rid.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_rid.h"
+
+#include "core/os/os.h"
+#include "core/rid_owner.h"
+#include "test_benchmark.h"
+
+#include <atomic>
+
+namespace TestRID {
+
+#define RID_COUNT 65536
+#define LOOKUPS_PER_THREAD 2000000
+
+struct Item {
+	uint32_t index;
+	uint32_t data[7];
+};
+
+typedef RID_Owner<Item, true> ItemOwner;
+
+static ItemOwner *owner = NULL;
+static Vector<RID> rids;
+static std::atomic<int> readers_done;
+static std::atomic<uint32_t> bad_lookups;
+static int churned = 0;
+
+static void lookup_thread(int p_thread, int p_thread_count, void *p_user) {
+
+	uint32_t seed = p_thread * 7919 + 1;
+
+	for (int i = 0; i < LOOKUPS_PER_THREAD; i++) {
+		seed = seed * 1103515245 + 12345;
+		int idx = (seed >> 8) % RID_COUNT;
+		Item *item = owner->getornull(rids[idx]);
+		if (!item || item->index != uint32_t(idx)) {
+			bad_lookups++;
+		}
+	}
+
+	readers_done++;
+}
+
+// Keeps creating and freeing items while the readers run, like the main thread does while rendering.
+static void churn(int p_thread_count, void *p_user) {
+
+	Vector<RID> temp;
+	while (readers_done < p_thread_count) {
+		Item item;
+		item.index = 0xFFFFFFFF;
+		temp.push_back(owner->make_rid(item));
+		if (temp.size() == 256) {
+			for (int i = 0; i < temp.size(); i++) {
+				owner->free(temp[i]);
+			}
+			temp.clear();
+		}
+		churned++;
+	}
+
+	for (int i = 0; i < temp.size(); i++) {
+		owner->free(temp[i]);
+	}
+	readers_done = 0;
+}
+
+MainLoop *test() {
+
+	OS *os = OS::get_singleton();
+
+	owner = memnew(ItemOwner);
+	rids.resize(RID_COUNT);
+	for (int i = 0; i < RID_COUNT; i++) {
+		Item item;
+		item.index = i;
+		rids.write[i] = owner->make_rid(item);
+	}
+	readers_done = 0;
+	bad_lookups = 0;
+	churned = 0;
+
+	os->print("\n\nRID_Owner concurrent getornull benchmark, main thread allocating meanwhile\n\n");
+
+	TestBenchmark::run_scaling(8, lookup_thread, NULL, LOOKUPS_PER_THREAD, TestBenchmark::WORK_PER_THREAD, "lookup", churn);
+
+	os->print("\n%d allocations while reading\n", churned);
+
+	if (bad_lookups > 0) {
+		os->print("FAIL: %d lookups returned the wrong item\n", int(bad_lookups));
+	}
+
+	for (int i = 0; i < RID_COUNT; i++) {
+		owner->free(rids[i]);
+	}
+	rids.clear();
+	memdelete(owner);
+	owner = NULL;
+
+	TestBenchmark::report(bad_lookups == 0);
+
+	return NULL;
+}
+} // namespace TestRID
@@ -0,0 +1,105 @@
+/*************************************************************************/
+/*  test_signal.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_signal.h"
+
+#include "core/object.h"
+#include "core/os/os.h"
+#include "test_benchmark.h"
+
+namespace TestSignal {
+
+#define EMIT_COUNT 500000
+#define TARGET_COUNT 8
+
+MainLoop *test() {
+
+	OS *os = OS::get_singleton();
+
+	os->print("\n\nSignal emission benchmark\n\n");
+
+	Object *source = memnew(Object);
+	source->add_user_signal(MethodInfo("changed", PropertyInfo(Variant::STRING, "name"), PropertyInfo(Variant::INT, "value")));
+	source->add_user_signal(MethodInfo("pinged"));
+
+	Vector<Object *> targets;
+	for (int i = 0; i < TARGET_COUNT; i++) {
+		Object *target = memnew(Object);
+		targets.push_back(target);
+		source->connect("changed", target, "set_meta");
+		source->connect("pinged", target, "set_meta", varray("pings", i));
+	}
+
+	StringName changed = "changed";
+	StringName pinged = "pinged";
+	StringName set_meta = "set_meta";
+	String name = "value";
+
+	uint64_t from = os->get_ticks_usec();
+	for (int i = 0; i < EMIT_COUNT; i++) {
+		for (int j = 0; j < TARGET_COUNT; j++) {
+			targets[j]->call(set_meta, name, i);
+		}
+	}
+	uint64_t usec = os->get_ticks_usec() - from;
+	TestBenchmark::print_time("direct call:", usec, double(EMIT_COUNT) * TARGET_COUNT, "target");
+
+	from = os->get_ticks_usec();
+	for (int i = 0; i < EMIT_COUNT; i++) {
+		source->emit_signal(changed, name, i);
+	}
+	usec = os->get_ticks_usec() - from;
+	TestBenchmark::print_time("emit, 2 args:", usec, double(EMIT_COUNT) * TARGET_COUNT, "target");
+
+	from = os->get_ticks_usec();
+	for (int i = 0; i < EMIT_COUNT; i++) {
+		source->emit_signal(pinged);
+	}
+	usec = os->get_ticks_usec() - from;
+	TestBenchmark::print_time("emit, 2 binds:", usec, double(EMIT_COUNT) * TARGET_COUNT, "target");
+
+	bool valid = true;
+	for (int i = 0; i < TARGET_COUNT; i++) {
+		valid = valid && int(targets[i]->get_meta("value")) == EMIT_COUNT - 1 && int(targets[i]->get_meta("pings")) == i;
+	}
+	if (!valid) {
+		os->print("\nFAIL: targets did not receive the expected values\n");
+	}
+
+	memdelete(source);
+	for (int i = 0; i < TARGET_COUNT; i++) {
+		memdelete(targets[i]);
+	}
+
+	TestBenchmark::report(valid);
+
+	return NULL;
+}
+} // namespace TestSignal
@@ -0,0 +1,86 @@
+/*************************************************************************/
+/*  test_string_name.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_string_name.h"
+
+#include "core/os/os.h"
+#include "core/string_name.h"
+#include "test_benchmark.h"
+
+namespace TestStringName {
+
+#define NAME_COUNT 1024
+#define LOOKUPS_PER_THREAD 200000
+
+static String names[NAME_COUNT];
+
+static void lookup_thread(int p_thread, int p_thread_count, void *p_user) {
+
+	int offset = p_thread * 97;
+
+	for (int i = 0; i < LOOKUPS_PER_THREAD; i++) {
+		// Mostly hits on existing names, with some short-lived ones mixed in.
+		if ((i & 15) == 0) {
+			StringName temp(names[(i + offset) % NAME_COUNT] + "_tmp");
+		} else {
+			StringName name(names[(i * 31 + offset) % NAME_COUNT]);
+		}
+	}
+}
+
+MainLoop *test() {
+
+	OS *os = OS::get_singleton();
+
+	Vector<StringName> keep_alive;
+	for (int i = 0; i < NAME_COUNT; i++) {
+		names[i] = "name_" + itos(i);
+		keep_alive.push_back(names[i]);
+	}
+
+	// Literal names must land in the same bucket as runtime ones.
+	bool ok = _scs_create("name_42") == StringName(names[42]);
+	if (!ok) {
+		os->print("FAIL: static and runtime hashes differ\n");
+	}
+
+	os->print("\n\nStringName interning contention benchmark\n\n");
+
+	TestBenchmark::run_scaling(32, lookup_thread, NULL, LOOKUPS_PER_THREAD, TestBenchmark::WORK_PER_THREAD, "lookup");
+
+	for (int i = 0; i < NAME_COUNT; i++) {
+		names[i] = String();
+	}
+
+	TestBenchmark::report(ok);
+
+	return NULL;
+}
+} // namespace TestStringName
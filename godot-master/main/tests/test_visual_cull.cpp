@@ -0,0 +1,228 @@
+/*************************************************************************/
+/*  test_visual_cull.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_visual_cull.h"
+
+#include "core/math/camera_matrix.h"
+#include "core/os/os.h"
+#include "servers/visual/visual_server_scene.h"
+#include "test_benchmark.h"
+
+namespace TestVisualCull {
+
+#define WORLD_SIZE 4000.0
+#define WORLD_HEIGHT 100.0
+#define CAMERA_FAR 500.0
+#define CAMERA_COUNT 32
+#define CAMERA_LAYER_MASK 0x7
+
+typedef VisualServerScene::Instance Instance;
+typedef VisualServerScene::Scenario Scenario;
+
+static uint32_t seed = 1;
+
+static real_t rand_unit() {
+
+	seed = seed * 1103515245 + 12345;
+	return real_t(seed >> 8) / real_t(1 << 24);
+}
+
+static real_t rand_range(real_t p_from, real_t p_to) {
+
+	return p_from + (p_to - p_from) * rand_unit();
+}
+
+// How _prepare_scene() culled before the flat arrays, including the layer
+// mask check that used to run in the loop after the octree query.
+static int octree_cull(Scenario *p_scenario, const Vector<Plane> &p_planes, Instance **r_result, int p_result_max) {
+
+	int count = p_scenario->octree.cull_convex(p_planes, r_result, p_result_max);
+
+	int visible = 0;
+	for (int i = 0; i < count; i++) {
+		if (r_result[i]->layer_mask & CAMERA_LAYER_MASK) {
+			r_result[visible++] = r_result[i];
+		}
+	}
+
+	return visible;
+}
+
+static int count_differences(Instance **p_a, int p_a_count, Instance **p_b, int p_b_count) {
+
+	Vector<Instance *> a;
+	Vector<Instance *> b;
+	a.resize(p_a_count);
+	b.resize(p_b_count);
+	for (int i = 0; i < p_a_count; i++) {
+		a.write[i] = p_a[i];
+	}
+	for (int i = 0; i < p_b_count; i++) {
+		b.write[i] = p_b[i];
+	}
+	a.sort();
+	b.sort();
+
+	int differences = 0;
+	int i = 0;
+	int j = 0;
+	while (i < a.size() || j < b.size()) {
+		if (j == b.size() || (i < a.size() && a[i] < b[j])) {
+			differences++;
+			i++;
+		} else if (i == a.size() || b[j] < a[i]) {
+			differences++;
+			j++;
+		} else {
+			i++;
+			j++;
+		}
+	}
+
+	return differences;
+}
+
+static bool test_scenario(OS *p_os, VisualServerScene *p_scene, Instance *p_instances, int p_count, const Vector<Plane> *p_frustums) {
+
+	Scenario *scenario = memnew(Scenario);
+
+	uint64_t from = p_os->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		Instance *ins = &p_instances[i];
+		ins->scenario = scenario;
+		ins->octree_id = scenario->octree.create(ins, ins->transformed_aabb, 0, false, 1 << VS::INSTANCE_MESH, 0);
+	}
+	uint64_t octree_build_usec = p_os->get_ticks_usec() - from;
+
+	from = p_os->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		scenario->cull_arrays.add(&p_instances[i]);
+	}
+	uint64_t arrays_build_usec = p_os->get_ticks_usec() - from;
+
+	Instance **octree_result = memnew_arr(Instance *, p_count);
+	Instance **range_result = memnew_arr(Instance *, p_count);
+	Instance **frustum_result = memnew_arr(Instance *, p_count);
+
+	uint64_t octree_usec = 0;
+	uint64_t range_usec = 0;
+	uint64_t frustum_usec = 0;
+	int visible = 0;
+	int differences = 0;
+
+	for (int i = 0; i < CAMERA_COUNT; i++) {
+
+		const Vector<Plane> &planes = p_frustums[i];
+
+		from = p_os->get_ticks_usec();
+		int octree_count = octree_cull(scenario, planes, octree_result, p_count);
+		octree_usec += p_os->get_ticks_usec() - from;
+
+		// the flat arrays on the calling thread only
+		from = p_os->get_ticks_usec();
+		int range_count = VisualServerScene::_cull_convex_range(scenario->cull_arrays, 0, p_count, planes.ptr(), planes.size(), CAMERA_LAYER_MASK, range_result);
+		range_usec += p_os->get_ticks_usec() - from;
+
+		// the flat arrays split into chunks on the cull thread pool, as _prepare_scene() runs it
+		from = p_os->get_ticks_usec();
+		int frustum_count = p_scene->_cull_frustum(scenario, planes, CAMERA_LAYER_MASK, frustum_result, p_count);
+		frustum_usec += p_os->get_ticks_usec() - from;
+
+		visible += octree_count;
+		differences += count_differences(octree_result, octree_count, range_result, range_count);
+		differences += count_differences(octree_result, octree_count, frustum_result, frustum_count);
+	}
+
+	p_os->print("%7d instances, %6.1f visible per camera: %s (%d differences)\n", p_count, double(visible) / CAMERA_COUNT, differences ? "FAIL" : "OK", differences);
+	p_os->print("\tbuild: octree %8.1f ms, flat arrays %8.1f ms\n", octree_build_usec / 1000.0, arrays_build_usec / 1000.0);
+	p_os->print("\tcull:  octree %8.3f ms, flat arrays %8.3f ms, flat arrays threaded %8.3f ms\n", octree_usec / 1000.0 / CAMERA_COUNT, range_usec / 1000.0 / CAMERA_COUNT, frustum_usec / 1000.0 / CAMERA_COUNT);
+
+	memdelete_arr(octree_result);
+	memdelete_arr(range_result);
+	memdelete_arr(frustum_result);
+
+	// the octree and arrays go away with the scenario, only the instances are reused
+	memdelete(scenario);
+	for (int i = 0; i < p_count; i++) {
+		Instance *ins = &p_instances[i];
+		ins->octree_id = 0;
+		ins->cull_index = -1;
+		ins->scenario = NULL;
+	}
+
+	return differences == 0;
+}
+
+MainLoop *test() {
+
+	OS *os = OS::get_singleton();
+	VisualServerScene *scene = VisualServerScene::singleton;
+	ERR_FAIL_COND_V_MSG(!scene, NULL, "The visual server must be running for this test.");
+
+	const int counts[] = { 100000, 300000, 1000000 };
+	const int max_count = counts[2];
+
+	// boxes of a few meters spread over a flat world, each on one of four layers
+	Instance *instances = memnew_arr(Instance, max_count);
+	for (int i = 0; i < max_count; i++) {
+		Instance *ins = &instances[i];
+		ins->base_type = VS::INSTANCE_MESH;
+		ins->layer_mask = 1 << (i & 3);
+
+		Vector3 size(rand_range(0.5, 8.0), rand_range(0.5, 8.0), rand_range(0.5, 8.0));
+		Vector3 position(rand_range(-WORLD_SIZE, WORLD_SIZE) * 0.5, rand_range(0, WORLD_HEIGHT), rand_range(-WORLD_SIZE, WORLD_SIZE) * 0.5);
+		ins->transformed_aabb = AABB(position - size * 0.5, size);
+	}
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 16.0 / 9.0, 0.05, CAMERA_FAR);
+
+	Vector<Plane> frustums[CAMERA_COUNT];
+	for (int i = 0; i < CAMERA_COUNT; i++) {
+		Transform camera;
+		camera.basis = Basis(Vector3(rand_range(-0.3, 0.3), rand_range(0, Math_PI * 2), 0));
+		camera.origin = Vector3(rand_range(-WORLD_SIZE, WORLD_SIZE) * 0.4, rand_range(2, WORLD_HEIGHT * 0.5), rand_range(-WORLD_SIZE, WORLD_SIZE) * 0.4);
+		frustums[i] = projection.get_projection_planes(camera);
+	}
+
+	os->print("\n\nVisualServerScene camera frustum culling, %d cameras, %.0f m far plane\n\n", CAMERA_COUNT, CAMERA_FAR);
+
+	bool ok = true;
+	for (int i = 0; i < 3; i++) {
+		ok = test_scenario(os, scene, instances, counts[i], frustums) && ok;
+	}
+
+	TestBenchmark::report(ok);
+
+	memdelete_arr(instances);
+
+	return NULL;
+}
+} // namespace TestVisualCull
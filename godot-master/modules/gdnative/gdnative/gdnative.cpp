@@ -174,6 +174,10 @@ godot_object GDAPI *godot_instance_from_id(godot_int p_instance_id) {
 	return (godot_object *)ObjectDB::get_instance((ObjectID)p_instance_id);
 }
 
+godot_object GDAPI *godot_instance_from_id64(uint64_t p_instance_id) {
+	return (godot_object *)ObjectDB::get_instance((ObjectID)p_instance_id);
+}
+
 void *godot_get_class_tag(const godot_string_name *p_class) {
 	StringName class_name = *(StringName *)p_class;
 	ClassDB::ClassInfo *class_info = ClassDB::classes.getptr(class_name);
@@ -291,7 +291,9 @@ void GDAPI *godot_get_class_tag(const godot_string_name *p_class);
 godot_object GDAPI *godot_object_cast_to(const godot_object *p_object, void *p_class_tag);
 
 // equivalent of GDScript's instance_from_id
+// deprecated: godot_int is 32 bits and cannot hold a full ObjectID, use godot_instance_from_id64
 godot_object GDAPI *godot_instance_from_id(godot_int p_instance_id);
+godot_object GDAPI *godot_instance_from_id64(uint64_t p_instance_id);
 
 #ifdef __cplusplus
 }
@@ -132,6 +132,7 @@ class GDScriptCompiler {
 		int current_line;
 		int stack_max;
 		int call_max;
+		int call_cache_count;
 	};
 
 	bool _is_class_member_property(CodeGen &codegen, const StringName &p_name);
@@ -242,6 +242,8 @@ private:
 	int _argument_count;
 	int _stack_size;
 	int _call_size;
+	MethodCallCache *_call_caches;
+	int _call_cache_count;
 	int _initial_line;
 	bool _static;
 	MultiplayerAPI::RPCMode rpc_mode;
@@ -752,6 +752,7 @@ public:
 	VisualScriptFunctionCall::RPCCallMode rpc_mode;
 	StringName function;
 	StringName singleton;
+	MethodCallCache call_cache;
 
 	VisualScriptFunctionCall *node;
 	VisualScriptInstance *instance;
@@ -823,9 +824,9 @@ public:
 				if (rpc_mode) {
 					call_rpc(node, p_inputs, input_args);
 				} else if (returns) {
-					*p_outputs[0] = another->call(function, p_inputs, input_args, r_error);
+					*p_outputs[0] = another->call_cached(function, call_cache, p_inputs, input_args, r_error);
 				} else {
-					another->call(function, p_inputs, input_args, r_error);
+					another->call_cached(function, call_cache, p_inputs, input_args, r_error);
 				}
 
 			} break;
@@ -842,9 +843,11 @@ public:
 				} else if (returns) {
 					if (call_mode == VisualScriptFunctionCall::CALL_MODE_INSTANCE) {
 						if (returns >= 2) {
-							*p_outputs[1] = v.call(function, p_inputs + 1, input_args, r_error);
+							Variant ret;
+							v.call_ptr(function, p_inputs + 1, input_args, &ret, r_error, &call_cache);
+							*p_outputs[1] = ret;
 						} else if (returns == 1) {
-							v.call(function, p_inputs + 1, input_args, r_error);
+							v.call_ptr(function, p_inputs + 1, input_args, NULL, r_error, &call_cache);
 						} else {
 							r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
 							r_error_str = "Invalid returns count for call_mode == CALL_MODE_INSTANCE";
@@ -854,7 +857,7 @@ public:
 						*p_outputs[0] = v.call(function, p_inputs + 1, input_args, r_error);
 					}
 				} else {
-					v.call(function, p_inputs + 1, input_args, r_error);
+					v.call_ptr(function, p_inputs + 1, input_args, NULL, r_error, &call_cache);
 				}
 
 				if (call_mode == VisualScriptFunctionCall::CALL_MODE_INSTANCE) {
@@ -874,9 +877,9 @@ public:
 				if (rpc_mode) {
 					call_rpc(object, p_inputs, input_args);
 				} else if (returns) {
-					*p_outputs[0] = object->call(function, p_inputs, input_args, r_error);
+					*p_outputs[0] = object->call_cached(function, call_cache, p_inputs, input_args, r_error);
 				} else {
-					object->call(function, p_inputs, input_args, r_error);
+					object->call_cached(function, call_cache, p_inputs, input_args, r_error);
 				}
 			} break;
 		}
@@ -263,6 +263,17 @@ void GeometryInstance::set_custom_aabb(AABB aabb) {
 	VS::get_singleton()->instance_set_custom_aabb(get_instance(), aabb);
 }
 
+void GeometryInstance::set_occluder_box(const AABB &p_box) {
+
+	occluder_box = p_box;
+	VS::get_singleton()->instance_geometry_set_occluder_box(get_instance(), occluder_box);
+}
+
+AABB GeometryInstance::get_occluder_box() const {
+
+	return occluder_box;
+}
+
 void GeometryInstance::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_material_override", "material"), &GeometryInstance::set_material_override);
@@ -291,6 +302,9 @@ void GeometryInstance::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_custom_aabb", "aabb"), &GeometryInstance::set_custom_aabb);
 
+	ClassDB::bind_method(D_METHOD("set_occluder_box", "box"), &GeometryInstance::set_occluder_box);
+	ClassDB::bind_method(D_METHOD("get_occluder_box"), &GeometryInstance::get_occluder_box);
+
 	ClassDB::bind_method(D_METHOD("get_aabb"), &GeometryInstance::get_aabb);
 
 	ADD_GROUP("Geometry", "");
@@ -299,6 +313,7 @@ void GeometryInstance::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "extra_cull_margin", PROPERTY_HINT_RANGE, "0,16384,0.01"), "set_extra_cull_margin", "get_extra_cull_margin");
 	ADD_PROPERTYI(PropertyInfo(Variant::BOOL, "use_in_baked_light"), "set_flag", "get_flag", FLAG_USE_BAKED_LIGHT);
 	ADD_PROPERTYI(PropertyInfo(Variant::BOOL, "use_dynamic_gi"), "set_flag", "get_flag", FLAG_USE_DYNAMIC_GI);
+	ADD_PROPERTY(PropertyInfo(Variant::AABB, "occluder_box"), "set_occluder_box", "get_occluder_box");
 
 	ADD_GROUP("LOD", "lod_");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_min_distance", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_min_distance", "get_lod_min_distance");
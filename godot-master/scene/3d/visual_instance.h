@@ -109,6 +109,7 @@ private:
 	float lod_max_hysteresis;
 
 	float extra_cull_margin;
+	AABB occluder_box;
 
 protected:
 	void _notification(int p_what);
@@ -141,6 +142,9 @@ public:
 
 	void set_custom_aabb(AABB aabb);
 
+	void set_occluder_box(const AABB &p_box);
+	AABB get_occluder_box() const;
+
 	GeometryInstance();
 };
 
@@ -45,7 +45,7 @@
 
 VARIANT_ENUM_CAST(Node::PauseMode);
 
-int Node::orphan_node_count = 0;
+std::atomic<int> Node::orphan_node_count(0);
 
 void Node::_notification(int p_notification) {
 
@@ -215,8 +215,9 @@ void Node::_propagate_enter_tree() {
 
 	data.inside_tree = true;
 
-	for (Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
-		E->get().group = data.tree->add_to_group(E->key(), this);
+	const StringName *K = NULL;
+	while ((K = data.grouped.next(K))) {
+		data.grouped.getptr(*K)->group = data.tree->add_to_group(*K, this);
 	}
 
 	notification(NOTIFICATION_ENTER_TREE);
@@ -308,9 +309,10 @@ void Node::_propagate_exit_tree() {
 
 	// exit groups
 
-	for (Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
-		data.tree->remove_from_group(E->key(), this);
-		E->get().group = NULL;
+	const StringName *K = NULL;
+	while ((K = data.grouped.next(K))) {
+		data.tree->remove_from_group(*K, this);
+		data.grouped.getptr(*K)->group = NULL;
 	}
 
 	data.viewport = NULL;
@@ -355,14 +357,19 @@ void Node::move_child(Node *p_child, int p_pos) {
 
 		data.children[i]->data.pos = i;
 	}
+	// the first child with this name may have changed
+	_unmap_child_name(p_child);
+	_map_child_name(p_child);
 	// notification second
 	move_child_notify(p_child);
 	for (int i = motion_from; i <= motion_to; i++) {
 		data.children[i]->notification(NOTIFICATION_MOVED_IN_PARENT);
 	}
-	for (const Map<StringName, GroupData>::Element *E = p_child->data.grouped.front(); E; E = E->next()) {
-		if (E->get().group)
-			E->get().group->changed = true;
+	const StringName *K = NULL;
+	while ((K = p_child->data.grouped.next(K))) {
+		SceneTree::Group *group = p_child->data.grouped.getptr(*K)->group;
+		if (group)
+			group->changed = true;
 	}
 
 	data.blocked--;
@@ -924,7 +931,15 @@ StringName Node::get_name() const {
 
 void Node::_set_name_nocheck(const StringName &p_name) {
 
+	if (data.parent) {
+		data.parent->_unmap_child_name(this);
+	}
+
 	data.name = p_name;
+
+	if (data.parent) {
+		data.parent->_map_child_name(this);
+	}
 }
 
 String Node::invalid_character = ". : @ / \"";
@@ -946,11 +961,17 @@ void Node::set_name(const String &p_name) {
 	_validate_node_name(name);
 
 	ERR_FAIL_COND(name == "");
+
+	if (data.parent) {
+		data.parent->_unmap_child_name(this);
+	}
+
 	data.name = name;
 
 	if (data.parent) {
 
 		data.parent->_validate_child_name(this);
+		data.parent->_map_child_name(this);
 	}
 
 	propagate_notification(NOTIFICATION_PATH_CHANGED);
@@ -1009,17 +1030,7 @@ void Node::_validate_child_name(Node *p_child, bool p_force_human_readable) {
 			unique = false;
 		} else {
 			//check if exists
-			Node **children = data.children.ptrw();
-			int cc = data.children.size();
-
-			for (int i = 0; i < cc; i++) {
-				if (children[i] == p_child)
-					continue;
-				if (children[i]->data.name == p_child->data.name) {
-					unique = false;
-					break;
-				}
-			}
+			unique = !_has_child_name(p_child->data.name, p_child);
 		}
 
 		if (!unique) {
@@ -1078,26 +1089,9 @@ void Node::_generate_serial_child_name(const Node *p_child, StringName &name) co
 		}
 	}
 
-	//quickly test if proposed name exists
-	int cc = data.children.size(); //children count
-	const Node *const *children_ptr = data.children.ptr();
-
-	{
-
-		bool exists = false;
-
-		for (int i = 0; i < cc; i++) {
-			if (children_ptr[i] == p_child) { //exclude self in renaming if its already a child
-				continue;
-			}
-			if (children_ptr[i]->data.name == name) {
-				exists = true;
-			}
-		}
-
-		if (!exists) {
-			return; //if it does not exist, it does not need validation
-		}
+	//quickly test if proposed name exists, excluding self in renaming if its already a child
+	if (!_has_child_name(name, p_child)) {
+		return; //if it does not exist, it does not need validation
 	}
 
 	// Extract trailing number
@@ -1124,18 +1118,8 @@ void Node::_generate_serial_child_name(const Node *p_child, StringName &name) co
 
 	for (;;) {
 		StringName attempt = name_string + nums;
-		bool exists = false;
 
-		for (int i = 0; i < cc; i++) {
-			if (children_ptr[i] == p_child) {
-				continue;
-			}
-			if (children_ptr[i]->data.name == attempt) {
-				exists = true;
-			}
-		}
-
-		if (!exists) {
+		if (!_has_child_name(attempt, p_child)) {
 			name = attempt;
 			return;
 		} else {
@@ -1150,12 +1134,56 @@ void Node::_generate_serial_child_name(const Node *p_child, StringName &name) co
 	}
 }
 
+void Node::_map_child_name(Node *p_child) {
+
+	// like the linear search this replaces, a name resolves to the first child that has it
+	ChildName *child = data.child_names.getptr(p_child->data.name);
+	if (!child) {
+		ChildName entry;
+		entry.node = p_child;
+		entry.count = 1;
+		data.child_names.set(p_child->data.name, entry);
+		return;
+	}
+
+	child->count++;
+	if (p_child->data.pos < child->node->data.pos) {
+		child->node = p_child;
+	}
+}
+
+void Node::_unmap_child_name(Node *p_child) {
+
+	ChildName *child = data.child_names.getptr(p_child->data.name);
+	ERR_FAIL_COND(!child);
+
+	child->count--;
+	if (child->count == 0) {
+		data.child_names.erase(p_child->data.name);
+		return;
+	}
+
+	if (child->node != p_child) {
+		return;
+	}
+
+	// names are not always validated (see _add_child_nocheck()), so only duplicates get here; hand the entry to the first one
+	for (int i = 0; i < data.children.size(); i++) {
+		Node *sibling = data.children[i];
+		if (sibling != p_child && sibling->data.name == p_child->data.name) {
+			child->node = sibling;
+			return;
+		}
+	}
+}
+
 void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
 	//add a child node quickly, without name validation
 
 	p_child->data.name = p_name;
 	p_child->data.pos = data.children.size();
 	data.children.push_back(p_child);
+	_map_child_name(p_child);
 	p_child->data.parent = this;
 	p_child->notification(NOTIFICATION_PARENTED);
 
@@ -1265,6 +1293,7 @@ void Node::remove_child(Node *p_child) {
 	p_child->notification(NOTIFICATION_UNPARENTED);
 
 	data.children.remove(idx);
+	_unmap_child_name(p_child);
 
 	//update pointer and size
 	child_count = data.children.size();
@@ -1300,15 +1329,8 @@ Node *Node::get_child(int p_index) const {
 
 Node *Node::_get_child_by_name(const StringName &p_name) const {
 
-	int cc = data.children.size();
-	Node *const *cd = data.children.ptr();
-
-	for (int i = 0; i < cc; i++) {
-		if (cd[i]->data.name == p_name)
-			return cd[i];
-	}
-
-	return NULL;
+	const ChildName *child = data.child_names.getptr(p_name);
+	return child ? child->node : NULL;
 }
 
 Node *Node::get_node_or_null(const NodePath &p_path) const {
@@ -1353,18 +1375,7 @@ Node *Node::get_node_or_null(const NodePath &p_path) const {
 
 		} else {
 
-			next = NULL;
-
-			for (int j = 0; j < current->data.children.size(); j++) {
-
-				Node *child = current->data.children[j];
-
-				if (child->data.name == name) {
-
-					next = child;
-					break;
-				}
-			}
+			next = current->_get_child_by_name(name);
 			if (next == NULL) {
 				return NULL;
 			};
@@ -1680,30 +1691,23 @@ void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 		return;
 
 	GroupData gd;
+	gd.persistent = p_persistent;
+	data.grouped.set(p_identifier, gd);
 
 	if (data.tree) {
-		gd.group = data.tree->add_to_group(p_identifier, this);
-	} else {
-		gd.group = NULL;
+		// the tree keeps the entry's index, so it must exist first
+		data.grouped.getptr(p_identifier)->group = data.tree->add_to_group(p_identifier, this);
 	}
-
-	gd.persistent = p_persistent;
-
-	data.grouped[p_identifier] = gd;
 }
 
 void Node::remove_from_group(const StringName &p_identifier) {
 
 	ERR_FAIL_COND(!data.grouped.has(p_identifier));
 
-	Map<StringName, GroupData>::Element *E = data.grouped.find(p_identifier);
-
-	ERR_FAIL_COND(!E);
-
 	if (data.tree)
-		data.tree->remove_from_group(E->key(), this);
+		data.tree->remove_from_group(p_identifier, this);
 
-	data.grouped.erase(E);
+	data.grouped.erase(p_identifier);
 }
 
 Array Node::_get_groups() const {
@@ -1720,10 +1724,20 @@ Array Node::_get_groups() const {
 
 void Node::get_groups(List<GroupInfo> *p_groups) const {
 
-	for (const Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
+	// sorted by name, so saved scenes and scripts don't see hash order
+	Vector<StringName> names;
+	names.resize(data.grouped.size());
+	int idx = 0;
+	const StringName *K = NULL;
+	while ((K = data.grouped.next(K))) {
+		names.write[idx++] = *K;
+	}
+	names.sort_custom<StringName::AlphCompare>();
+
+	for (int i = 0; i < names.size(); i++) {
 		GroupInfo gi;
-		gi.name = E->key();
-		gi.persistent = E->get().persistent;
+		gi.name = names[i];
+		gi.persistent = data.grouped.getptr(names[i])->persistent;
 		p_groups->push_back(gi);
 	}
 }
@@ -1732,8 +1746,9 @@ int Node::get_persistent_group_count() const {
 
 	int count = 0;
 
-	for (const Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
-		if (E->get().persistent) {
+	const StringName *K = NULL;
+	while ((K = data.grouped.next(K))) {
+		if (data.grouped.getptr(*K)->persistent) {
 			count += 1;
 		}
 	}
@@ -2970,6 +2985,7 @@ Node::~Node() {
 	data.grouped.clear();
 	data.owned.clear();
 	data.children.clear();
+	data.child_names.clear();
 
 	ERR_FAIL_COND(data.parent);
 	ERR_FAIL_COND(data.children.size());
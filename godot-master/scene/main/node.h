@@ -39,6 +39,8 @@
 #include "core/script_language.h"
 #include "scene/main/scene_tree.h"
 
+#include <atomic>
+
 class Viewport;
 class SceneState;
 class Node : public Object {
@@ -75,14 +77,29 @@ public:
 		bool operator()(const Node *p_a, const Node *p_b) const { return p_b->data.process_priority == p_a->data.process_priority ? p_b->is_greater_than(p_a) : p_b->data.process_priority > p_a->data.process_priority; }
 	};
 
-	static int orphan_node_count;
+	static std::atomic<int> orphan_node_count; // nodes can be created and freed on any thread
 
 private:
 	struct GroupData {
 
 		bool persistent;
 		SceneTree::Group *group;
-		GroupData() { persistent = false; }
+		int index; // position in group->nodes, kept up to date by SceneTree
+		GroupData() {
+			persistent = false;
+			group = NULL;
+			index = -1;
+		}
+	};
+
+	struct ChildName {
+
+		Node *node; // first child with the name
+		int count; // children with the name, names are not always unique
+		ChildName() {
+			node = NULL;
+			count = 0;
+		}
 	};
 
 	struct Data {
@@ -96,6 +113,7 @@ private:
 		Node *parent;
 		Node *owner;
 		Vector<Node *> children; // list of children
+		HashMap<StringName, ChildName> child_names;
 		int pos;
 		int depth;
 		int blocked; // safeguard that throws an error when attempting to modify the tree in a harmful way while being traversed.
@@ -110,7 +128,7 @@ private:
 
 		Viewport *viewport;
 
-		Map<StringName, GroupData> grouped;
+		HashMap<StringName, GroupData> grouped;
 		List<Node *>::Element *OW; // owned element
 		List<Node *> owned;
 
@@ -161,6 +179,12 @@ private:
 
 	void _validate_child_name(Node *p_child, bool p_force_human_readable = false);
 	void _generate_serial_child_name(const Node *p_child, StringName &name) const;
+	_FORCE_INLINE_ bool _has_child_name(const StringName &p_name, const Node *p_except) const {
+		const ChildName *child = data.child_names.getptr(p_name);
+		return child && (child->node != p_except || child->count > 1);
+	}
+	void _map_child_name(Node *p_child);
+	void _unmap_child_name(Node *p_child);
 
 	void _propagate_reverse_notification(int p_notification);
 	void _propagate_deferred_notification(int p_notification, bool p_reverse);
@@ -124,32 +124,49 @@ void SceneTree::node_renamed(Node *p_node) {
 
 SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_node) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
-		E = group_map.insert(p_group, Group());
+	Node::GroupData *gd = p_node->data.grouped.getptr(p_group);
+	ERR_FAIL_COND_V(!gd, NULL);
+
+	Group *g = group_map.getptr(p_group);
+	if (!g) {
+		g = &group_map.set(p_group, Group())->value();
+		g->name = p_group;
 	}
 
-	ERR_FAIL_COND_V_MSG(E->get().nodes.find(p_node) != -1, &E->get(), "Already in group: " + p_group + ".");
-	E->get().nodes.push_back(p_node);
-	//E->get().last_tree_version=0;
-	E->get().changed = true;
-	return &E->get();
+	ERR_FAIL_COND_V_MSG(gd->index >= 0 && gd->index < g->nodes.size() && g->nodes[gd->index] == p_node, g, "Already in group: " + p_group + ".");
+	// appended after the sorted part, _update_group_order() merges it in
+	gd->index = g->nodes.size();
+	g->nodes.push_back(p_node);
+	return g;
 }
 
 void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	ERR_FAIL_COND(!E);
+	Group *g = group_map.getptr(p_group);
+	ERR_FAIL_COND(!g);
+	Node::GroupData *gd = p_node->data.grouped.getptr(p_group);
+	ERR_FAIL_COND(!gd);
+	ERR_FAIL_INDEX(gd->index, g->nodes.size());
+	ERR_FAIL_COND(g->nodes[gd->index] != p_node);
+
+	// Leave a hole instead of shifting, so removal keeps the cached order and costs O(1).
+	if (gd->index == g->nodes.size() - 1) {
+		g->nodes.resize(gd->index);
+		g->sorted_count = MIN(g->sorted_count, gd->index);
+	} else {
+		g->nodes.write[gd->index] = NULL;
+		g->removed_count++;
+	}
+	gd->index = -1;
 
-	E->get().nodes.erase(p_node);
-	if (E->get().nodes.empty())
-		group_map.erase(E);
+	if (g->nodes.size() == g->removed_count)
+		group_map.erase(p_group);
 }
 
 void SceneTree::make_group_changed(const StringName &p_group) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (E)
-		E->get().changed = true;
+	Group *g = group_map.getptr(p_group);
+	if (g)
+		g->changed = true;
 }
 
 void SceneTree::flush_transform_notifications() {
@@ -185,32 +202,123 @@ void SceneTree::_flush_ugc() {
 	ugc_locked = false;
 }
 
-void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
+template <class C>
+static int _sort_group_nodes(Node **p_nodes, int p_count, int p_sorted_count) {
 
-	if (!g.changed)
-		return;
-	if (g.nodes.empty())
-		return;
+	SortArray<Node *, C> node_sort;
+
+	if (p_sorted_count >= p_count) {
+		return p_count;
+	}
+	if (p_sorted_count == 0) {
+		node_sort.sort(p_nodes, p_count);
+		return 0;
+	}
+
+	// Sort only what was added since, then merge it into the sorted part.
+	node_sort.sort(&p_nodes[p_sorted_count], p_count - p_sorted_count);
+
+	C compare;
+	int from = p_sorted_count;
+	while (from > 0 && compare(p_nodes[p_sorted_count], p_nodes[from - 1])) {
+		from--;
+	}
+	if (from == p_sorted_count) {
+		return from; // added nodes all go after the sorted ones
+	}
+
+	Vector<Node *> head;
+	head.resize(p_sorted_count - from);
+	Node **head_ptr = head.ptrw();
+	for (int i = 0; i < head.size(); i++) {
+		head_ptr[i] = p_nodes[from + i];
+	}
+
+	int h = 0;
+	int t = p_sorted_count;
+	int to = from;
+	while (h < head.size()) {
+		if (t < p_count && compare(p_nodes[t], head_ptr[h])) {
+			p_nodes[to++] = p_nodes[t++];
+		} else {
+			p_nodes[to++] = head_ptr[h++];
+		}
+	}
+
+	return from;
+}
+
+void SceneTree::_update_group_indices(Group &g, int p_from) {
 
 	Node **nodes = g.nodes.ptrw();
 	int node_count = g.nodes.size();
 
-	if (p_use_priority) {
-		SortArray<Node *, Node::ComparatorWithPriority> node_sort;
-		node_sort.sort(nodes, node_count);
-	} else {
-		SortArray<Node *, Node::Comparator> node_sort;
-		node_sort.sort(nodes, node_count);
+	for (int i = p_from; i < node_count; i++) {
+		nodes[i]->data.grouped.getptr(g.name)->index = i;
+	}
+}
+
+void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
+
+	int changed_from = g.nodes.size();
+
+	if (g.removed_count) {
+		// compact the holes left by remove_from_group, keeping the order
+		Node **nodes = g.nodes.ptrw();
+		int node_count = g.nodes.size();
+		int sorted_count = 0;
+		int to = 0;
+
+		for (int i = 0; i < node_count; i++) {
+			if (!nodes[i])
+				continue;
+			if (i < g.sorted_count)
+				sorted_count++;
+			if (to != i && changed_from > to)
+				changed_from = to;
+			nodes[to++] = nodes[i];
+		}
+
+		g.nodes.resize(to);
+		g.sorted_count = sorted_count;
+		g.removed_count = 0;
+	}
+
+	if (g.sorted_by_priority != p_use_priority) {
+		g.sorted_by_priority = p_use_priority;
+		g.changed = true;
+	}
+
+	int node_count = g.nodes.size();
+
+	if (g.changed || g.sorted_count < node_count) {
+
+		Node **nodes = g.nodes.ptrw();
+		int sorted_count = g.changed ? 0 : g.sorted_count;
+		int from;
+
+		if (p_use_priority) {
+			from = _sort_group_nodes<Node::ComparatorWithPriority>(nodes, node_count, sorted_count);
+		} else {
+			from = _sort_group_nodes<Node::Comparator>(nodes, node_count, sorted_count);
+		}
+
+		changed_from = MIN(changed_from, from);
+		g.sorted_count = node_count;
+		g.changed = false;
+	}
+
+	if (changed_from < node_count) {
+		_update_group_indices(g, changed_from);
 	}
-	g.changed = false;
 }
 
 void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *G = group_map.getptr(p_group);
+	if (!G)
 		return;
-	Group &g = E->get();
+	Group &g = *G;
 	if (g.nodes.empty())
 		return;
 
@@ -286,10 +394,10 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 
 void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_group, int p_notification) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *G = group_map.getptr(p_group);
+	if (!G)
 		return;
-	Group &g = E->get();
+	Group &g = *G;
 	if (g.nodes.empty())
 		return;
 
@@ -335,10 +443,10 @@ void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_gr
 
 void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group, const String &p_name, const Variant &p_value) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *G = group_map.getptr(p_group);
+	if (!G)
 		return;
-	Group &g = E->get();
+	Group &g = *G;
 	if (g.nodes.empty())
 		return;
 
@@ -911,10 +1019,10 @@ bool SceneTree::is_paused() const {
 
 void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *G = group_map.getptr(p_group);
+	if (!G)
 		return;
-	Group &g = E->get();
+	Group &g = *G;
 	if (g.nodes.empty())
 		return;
 
@@ -955,10 +1063,10 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
 
 void SceneTree::_notify_group_pause(const StringName &p_group, int p_notification) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *G = group_map.getptr(p_group);
+	if (!G)
 		return;
-	Group &g = E->get();
+	Group &g = *G;
 	if (g.nodes.empty())
 		return;
 
@@ -1060,18 +1168,18 @@ int64_t SceneTree::get_event_count() const {
 Array SceneTree::_get_nodes_in_group(const StringName &p_group) {
 
 	Array ret;
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *g = group_map.getptr(p_group);
+	if (!g)
 		return ret;
 
-	_update_group_order(E->get()); //update order just in case
-	int nc = E->get().nodes.size();
+	_update_group_order(*g); //update order just in case
+	int nc = g->nodes.size();
 	if (nc == 0)
 		return ret;
 
 	ret.resize(nc);
 
-	Node **ptr = E->get().nodes.ptrw();
+	Node *const *ptr = g->nodes.ptr();
 	for (int i = 0; i < nc; i++) {
 
 		ret[i] = ptr[i];
@@ -1086,15 +1194,15 @@ bool SceneTree::has_group(const StringName &p_identifier) const {
 }
 void SceneTree::get_nodes_in_group(const StringName &p_group, List<Node *> *p_list) {
 
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E)
+	Group *g = group_map.getptr(p_group);
+	if (!g)
 		return;
 
-	_update_group_order(E->get()); //update order just in case
-	int nc = E->get().nodes.size();
+	_update_group_order(*g); //update order just in case
+	int nc = g->nodes.size();
 	if (nc == 0)
 		return;
-	Node **ptr = E->get().nodes.ptrw();
+	Node *const *ptr = g->nodes.ptr();
 	for (int i = 0; i < nc; i++) {
 
 		p_list->push_back(ptr[i]);
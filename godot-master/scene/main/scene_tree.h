@@ -94,10 +94,18 @@ public:
 private:
 	struct Group {
 
+		StringName name;
 		Vector<Node *> nodes;
-		//uint64_t last_tree_version;
-		bool changed;
-		Group() { changed = false; };
+		int sorted_count; // nodes before this are in tree order, the rest were added since
+		int removed_count; // NULL slots left by remove_from_group, compacted on the next order update
+		bool changed; // order between members changed, needs a full sort
+		bool sorted_by_priority;
+		Group() {
+			sorted_count = 0;
+			removed_count = 0;
+			changed = false;
+			sorted_by_priority = false;
+		};
 	};
 
 	Viewport *root;
@@ -115,7 +123,7 @@ private:
 	bool pause;
 	int root_lock;
 
-	Map<StringName, Group> group_map;
+	HashMap<StringName, Group> group_map;
 	bool _quit;
 	bool initialized;
 	bool input_handled;
@@ -160,7 +168,8 @@ private:
 	bool ugc_locked;
 	void _flush_ugc();
 
-	_FORCE_INLINE_ void _update_group_order(Group &g, bool p_use_priority = false);
+	void _update_group_indices(Group &g, int p_from);
+	void _update_group_order(Group &g, bool p_use_priority = false);
 	void _update_listener();
 
 	Array _get_nodes_in_group(const StringName &p_group);
@@ -88,6 +88,7 @@ void HeightMapShape::_update_shape() {
 	d["heights"] = map_data;
 	d["min_height"] = min_height;
 	d["max_height"] = max_height;
+	d["compressed"] = compressed;
 	PhysicsServer::get_singleton()->shape_set_data(get_shape(), d);
 	Shape::_update_shape();
 }
@@ -178,6 +179,22 @@ PoolRealArray HeightMapShape::get_map_data() const {
 	return map_data;
 }
 
+void HeightMapShape::set_compressed(bool p_compressed) {
+	if (compressed == p_compressed) {
+		return;
+	}
+
+	compressed = p_compressed;
+
+	_update_shape();
+	notify_change_to_owners();
+	_change_notify("compressed");
+}
+
+bool HeightMapShape::is_compressed() const {
+	return compressed;
+}
+
 void HeightMapShape::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_map_width", "width"), &HeightMapShape::set_map_width);
 	ClassDB::bind_method(D_METHOD("get_map_width"), &HeightMapShape::get_map_width);
@@ -185,10 +202,13 @@ void HeightMapShape::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_map_depth"), &HeightMapShape::get_map_depth);
 	ClassDB::bind_method(D_METHOD("set_map_data", "data"), &HeightMapShape::set_map_data);
 	ClassDB::bind_method(D_METHOD("get_map_data"), &HeightMapShape::get_map_data);
+	ClassDB::bind_method(D_METHOD("set_compressed", "compressed"), &HeightMapShape::set_compressed);
+	ClassDB::bind_method(D_METHOD("is_compressed"), &HeightMapShape::is_compressed);
 
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "map_width", PROPERTY_HINT_RANGE, "1,4096,1"), "set_map_width", "get_map_width");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "map_depth", PROPERTY_HINT_RANGE, "1,4096,1"), "set_map_depth", "get_map_depth");
 	ADD_PROPERTY(PropertyInfo(Variant::POOL_REAL_ARRAY, "map_data"), "set_map_data", "get_map_data");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "compressed"), "set_compressed", "is_compressed");
 }
 
 HeightMapShape::HeightMapShape() :
@@ -204,6 +224,7 @@ HeightMapShape::HeightMapShape() :
 	w[3] = 0.0;
 	min_height = 0.0;
 	max_height = 0.0;
+	compressed = false;
 
 	_update_shape();
 }
@@ -41,6 +41,7 @@ class HeightMapShape : public Shape {
 	PoolRealArray map_data;
 	float min_height;
 	float max_height;
+	bool compressed;
 
 protected:
 	static void _bind_methods();
@@ -53,6 +54,8 @@ public:
 	int get_map_depth() const;
 	void set_map_data(PoolRealArray p_new);
 	PoolRealArray get_map_data() const;
+	void set_compressed(bool p_compressed);
+	bool is_compressed() const;
 
 	virtual Vector<Vector3> get_debug_mesh_lines();
 	virtual real_t get_enclosing_radius() const;
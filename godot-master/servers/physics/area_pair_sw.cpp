@@ -74,6 +74,7 @@ AreaPairSW::AreaPairSW(BodySW *p_body, int p_body_shape, AreaSW *p_area, int p_a
 	body_shape = p_body_shape;
 	area_shape = p_area_shape;
 	colliding = false;
+	set_stable_id(area->get_self().get_id(), body->get_self().get_id(), ((uint64_t)area_shape << 32) | (uint32_t)body_shape);
 	body->add_constraint(this, 0);
 	area->add_constraint(this);
 	if (p_body->get_mode() == PhysicsServer::BODY_MODE_KINEMATIC)
@@ -139,6 +140,7 @@ Area2PairSW::Area2PairSW(AreaSW *p_area_a, int p_shape_a, AreaSW *p_area_b, int
 	shape_a = p_shape_a;
 	shape_b = p_shape_b;
 	colliding = false;
+	set_stable_id(area_a->get_self().get_id(), area_b->get_self().get_id(), ((uint64_t)shape_a << 32) | (uint32_t)shape_b);
 	area_a->add_constraint(this);
 	area_b->add_constraint(this);
 }
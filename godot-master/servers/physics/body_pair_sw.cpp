@@ -48,6 +48,8 @@
 #define RELAXATION_TIMESTEPS 3
 #define MIN_VELOCITY 0.0001
 #define MAX_BIAS_ROTATION (Math_PI / 8)
+#define COHERENCE_POSITION_THRESHOLD 0.0001
+#define COHERENCE_BASIS_THRESHOLD 0.00001
 
 void BodyPairSW::_contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata) {
 
@@ -80,24 +82,34 @@ void BodyPairSW::contact_added_callback(const Vector3 &p_point_A, const Vector3
 	contact.normal = (p_point_A - p_point_B).normalized();
 	contact.mass_normal = 0; // will be computed in setup()
 
-	// attempt to determine if the contact will be reused
+	// attempt to determine if the contact will be reused, pick the closest one
+	// so accumulated impulses are warm started from the matching feature
 	real_t contact_recycle_radius = space->get_contact_recycle_radius();
+	real_t best_distance = contact_recycle_radius * contact_recycle_radius;
 
 	for (int i = 0; i < contact_count; i++) {
 
 		Contact &c = contacts[i];
-		if (c.local_A.distance_squared_to(local_A) < (contact_recycle_radius * contact_recycle_radius) &&
-				c.local_B.distance_squared_to(local_B) < (contact_recycle_radius * contact_recycle_radius)) {
+		real_t distance_A = c.local_A.distance_squared_to(local_A);
+		real_t distance_B = c.local_B.distance_squared_to(local_B);
+		if (distance_A < (contact_recycle_radius * contact_recycle_radius) &&
+				distance_B < (contact_recycle_radius * contact_recycle_radius) &&
+				MAX(distance_A, distance_B) < best_distance) {
 
-			contact.acc_normal_impulse = c.acc_normal_impulse;
-			contact.acc_bias_impulse = c.acc_bias_impulse;
-			contact.acc_bias_impulse_center_of_mass = c.acc_bias_impulse_center_of_mass;
-			contact.acc_tangent_impulse = c.acc_tangent_impulse;
+			best_distance = MAX(distance_A, distance_B);
 			new_index = i;
-			break;
 		}
 	}
 
+	if (new_index < contact_count) {
+
+		Contact &c = contacts[new_index];
+		contact.acc_normal_impulse = c.acc_normal_impulse;
+		contact.acc_bias_impulse = c.acc_bias_impulse;
+		contact.acc_bias_impulse_center_of_mass = c.acc_bias_impulse_center_of_mass;
+		contact.acc_tangent_impulse = c.acc_tangent_impulse;
+	}
+
 	// figure out if the contact amount must be reduced to fit the new contact
 
 	if (new_index == MAX_CONTACTS) {
@@ -211,6 +223,27 @@ bool BodyPairSW::_test_ccd(real_t p_step, BodySW *p_A, int p_shape_A, const Tran
 	return true;
 }
 
+bool BodyPairSW::_is_coherent(const Transform &p_relative_xform, ShapeSW *p_shape_A, ShapeSW *p_shape_B) const {
+
+	if (!coherence_valid)
+		return false;
+
+	if (p_shape_A != last_shape_A || p_shape_B != last_shape_B || p_shape_A->get_version() != last_shape_version_A || p_shape_B->get_version() != last_shape_version_B)
+		return false;
+
+	if (p_relative_xform.origin.distance_squared_to(last_relative_xform.origin) > COHERENCE_POSITION_THRESHOLD * COHERENCE_POSITION_THRESHOLD)
+		return false;
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (Math::abs(p_relative_xform.basis[i][j] - last_relative_xform.basis[i][j]) > COHERENCE_BASIS_THRESHOLD)
+				return false;
+		}
+	}
+
+	return true;
+}
+
 real_t combine_bounce(BodySW *A, BodySW *B) {
 	return CLAMP(A->get_bounce() + B->get_bounce(), 0, 1);
 }
@@ -224,11 +257,13 @@ bool BodyPairSW::setup(real_t p_step) {
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
 		collided = false;
+		coherence_valid = false;
 		return false;
 	}
 
 	if (A->is_shape_set_as_disabled(shape_A) || B->is_shape_set_as_disabled(shape_B)) {
 		collided = false;
+		coherence_valid = false;
 		return false;
 	}
 
@@ -247,8 +282,26 @@ bool BodyPairSW::setup(real_t p_step) {
 	ShapeSW *shape_A_ptr = A->get_shape(shape_A);
 	ShapeSW *shape_B_ptr = B->get_shape(shape_B);
 
-	bool collided = CollisionSolverSW::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
-	this->collided = collided;
+	// if the shapes barely moved relative to each other since the last narrowphase, the
+	// contacts (kept in local coordinates) are still valid, so reuse the previous result
+	Transform relative_xform = xform_A.affine_inverse() * xform_B;
+	bool collided;
+
+	if (_is_coherent(relative_xform, shape_A_ptr, shape_B_ptr)) {
+
+		collided = this->collided;
+	} else {
+
+		collided = CollisionSolverSW::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
+		this->collided = collided;
+
+		last_relative_xform = relative_xform;
+		last_shape_A = shape_A_ptr;
+		last_shape_B = shape_B_ptr;
+		last_shape_version_A = shape_A_ptr->get_version();
+		last_shape_version_B = shape_B_ptr->get_version();
+		coherence_valid = true;
+	}
 
 	if (!collided) {
 
@@ -482,10 +535,16 @@ BodyPairSW::BodyPairSW(BodySW *p_A, int p_shape_A, BodySW *p_B, int p_shape_B) :
 	shape_A = p_shape_A;
 	shape_B = p_shape_B;
 	space = A->get_space();
+	set_stable_id(A->get_self().get_id(), B->get_self().get_id(), ((uint64_t)shape_A << 32) | (uint32_t)shape_B);
 	A->add_constraint(this, 0);
 	B->add_constraint(this, 1);
 	contact_count = 0;
 	collided = false;
+	last_shape_A = NULL;
+	last_shape_B = NULL;
+	last_shape_version_A = 0;
+	last_shape_version_B = 0;
+	coherence_valid = false;
 }
 
 BodyPairSW::~BodyPairSW() {
@@ -77,6 +77,16 @@ class BodyPairSW : public ConstraintSW {
 	int contact_count;
 	bool collided;
 
+	// temporal coherence, narrowphase is skipped while the shapes keep the same relative placement
+	Transform last_relative_xform;
+	ShapeSW *last_shape_A;
+	ShapeSW *last_shape_B;
+	uint32_t last_shape_version_A;
+	uint32_t last_shape_version_B;
+	bool coherence_valid;
+
+	bool _is_coherent(const Transform &p_relative_xform, ShapeSW *p_shape_A, ShapeSW *p_shape_B) const;
+
 	static void _contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata);
 
 	void contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B);
@@ -51,6 +51,19 @@ struct _CollectorCallback {
 	}
 };
 
+// Arc a-b crosses arc c-d on the unit sphere, the shorter arcs are taken.
+static _FORCE_INLINE_ bool _is_minkowski_face(const Vector3 &p_a, const Vector3 &p_b, const Vector3 &p_b_x_a, const Vector3 &p_c, const Vector3 &p_d, const Vector3 &p_d_x_c) {
+
+	real_t cba = p_c.dot(p_b_x_a);
+	real_t dba = p_d.dot(p_b_x_a);
+	real_t adc = p_a.dot(p_d_x_c);
+	real_t bdc = p_b.dot(p_d_x_c);
+
+	// c and d on opposite sides of plane a-b, a and b on opposite sides of
+	// plane c-d, and both arcs on the same hemisphere
+	return cba * dba < 0 && adc * bdc < 0 && cba * bdc > 0;
+}
+
 typedef void (*GenerateContactsFunc)(const Vector3 *, int, const Vector3 *, int, _CollectorCallback *);
 
 static void _generate_contacts_point_point(const Vector3 *p_points_A, int p_point_count_A, const Vector3 *p_points_B, int p_point_count_B, _CollectorCallback *p_callback) {
@@ -775,6 +788,9 @@ static void _collision_box_capsule(const ShapeSW *p_a, const Transform &p_transf
 	// points of A, capsule cylinder
 	// this sure could be made faster somehow..
 
+	Vector3 capsule_axis = p_transform_b.basis.get_axis(2) * (capsule_B->get_height() * 0.5);
+	Vector3 capsule_segment[2] = { p_transform_b.origin + capsule_axis, p_transform_b.origin - capsule_axis };
+
 	for (int i = 0; i < 2; i++) {
 		for (int j = 0; j < 2; j++) {
 			for (int k = 0; k < 2; k++) {
@@ -786,10 +802,12 @@ static void _collision_box_capsule(const ShapeSW *p_a, const Transform &p_transf
 				for (int l = 0; l < 3; l++)
 					point += p_transform_a.basis.get_axis(l) * he[l];
 
-				//Vector3 axis = (point - cyl_axis * cyl_axis.dot(point)).normalized();
-				Vector3 axis = Plane(cyl_axis, 0).project(point).normalized();
+				// from the closest point of the capsule segment, covers both the cylinder and the balls
+				Vector3 axis = Geometry::get_closest_point_to_segment(point, capsule_segment) - point;
+				if (axis.length_squared() < CMP_EPSILON)
+					continue;
 
-				if (!separator.test_axis(axis))
+				if (!separator.test_axis(axis.normalized()))
 					return;
 			}
 		}
@@ -799,9 +817,7 @@ static void _collision_box_capsule(const ShapeSW *p_a, const Transform &p_transf
 
 	for (int i = 0; i < 2; i++) {
 
-		Vector3 capsule_axis = p_transform_b.basis.get_axis(2) * (capsule_B->get_height() * 0.5);
-
-		Vector3 sphere_pos = p_transform_b.origin + ((i == 0) ? capsule_axis : -capsule_axis);
+		Vector3 sphere_pos = capsule_segment[i];
 
 		Vector3 cnormal = p_transform_a.xform_inv(sphere_pos);
 
@@ -1177,6 +1193,34 @@ static void _collision_capsule_convex_polygon(const ShapeSW *p_a, const Transfor
 		}
 	}
 
+	// closest vertex of B, capsule segment
+
+	Vector3 capsule_axis = p_transform_a.basis.get_axis(2) * (capsule_A->get_height() * 0.5);
+	Vector3 capsule_segment[2] = { p_transform_a.origin + capsule_axis, p_transform_a.origin - capsule_axis };
+
+	real_t closest_distance = 1e20;
+	Vector3 closest_vertex;
+	Vector3 closest_point;
+
+	for (int i = 0; i < mesh.vertices.size(); i++) {
+
+		Vector3 vertex = p_transform_b.xform(vertices[i]);
+		Vector3 point = Geometry::get_closest_point_to_segment(vertex, capsule_segment);
+		real_t distance = point.distance_squared_to(vertex);
+
+		if (distance < closest_distance) {
+			closest_distance = distance;
+			closest_vertex = vertex;
+			closest_point = point;
+		}
+	}
+
+	if (closest_distance > CMP_EPSILON) {
+
+		if (!separator.test_axis((closest_point - closest_vertex).normalized()))
+			return;
+	}
+
 	separator.generate_contacts();
 }
 
@@ -1297,12 +1341,46 @@ static void _collision_convex_polygon_convex_polygon(const ShapeSW *p_a, const T
 	}
 
 	// A<->B edges
+	// Only pairs whose arcs cross on the Gauss map form a face of the Minkowski
+	// difference, the axes of the other pairs can't be the one of least
+	// penetration. For the arcs, edge normals are the normals of the faces around
+	// the edge in world space, negated for B.
+	const ConvexPolygonShapeSW::EdgeFaces *edge_faces_A = convex_polygon_A->get_edge_faces().ptr();
+	const ConvexPolygonShapeSW::EdgeFaces *edge_faces_B = convex_polygon_B->get_edge_faces().ptr();
+	Basis normal_xform_A = p_transform_a.basis.inverse().transposed();
+	Basis normal_xform_B = p_transform_b.basis.inverse().transposed();
+
+	Vector3 *arcs_B = (Vector3 *)alloca(sizeof(Vector3) * edge_count_B * 3); // c, d, d x c
+	bool *has_arc_B = (bool *)alloca(sizeof(bool) * edge_count_B);
+	for (int j = 0; j < edge_count_B; j++) {
+
+		has_arc_B[j] = edge_faces_B[j].face_b >= 0;
+		if (has_arc_B[j]) {
+			Vector3 c = -normal_xform_B.xform(faces_B[edge_faces_B[j].face_a].plane.normal);
+			Vector3 d = -normal_xform_B.xform(faces_B[edge_faces_B[j].face_b].plane.normal);
+			arcs_B[j * 3 + 0] = c;
+			arcs_B[j * 3 + 1] = d;
+			arcs_B[j * 3 + 2] = d.cross(c);
+		}
+	}
+
 	for (int i = 0; i < edge_count_A; i++) {
 
 		Vector3 e1 = p_transform_a.basis.xform(vertices_A[edges_A[i].a]) - p_transform_a.basis.xform(vertices_A[edges_A[i].b]);
 
+		bool has_arc_A = edge_faces_A[i].face_b >= 0;
+		Vector3 a, b, b_x_a;
+		if (has_arc_A) {
+			a = normal_xform_A.xform(faces_A[edge_faces_A[i].face_a].plane.normal);
+			b = normal_xform_A.xform(faces_A[edge_faces_A[i].face_b].plane.normal);
+			b_x_a = b.cross(a);
+		}
+
 		for (int j = 0; j < edge_count_B; j++) {
 
+			if (has_arc_A && has_arc_B[j] && !_is_minkowski_face(a, b, b_x_a, arcs_B[j * 3 + 0], arcs_B[j * 3 + 1], arcs_B[j * 3 + 2]))
+				continue;
+
 			Vector3 e2 = p_transform_b.basis.xform(vertices_B[edges_B[j].a]) - p_transform_b.basis.xform(vertices_B[edges_B[j].b]);
 
 			Vector3 axis = e1.cross(e2).normalized();
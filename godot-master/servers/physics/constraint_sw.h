@@ -44,6 +44,7 @@ class ConstraintSW {
 	bool disabled_collisions_between_bodies;
 
 	RID self;
+	uint64_t stable_id[3]; // ordering key used by deterministic stepping
 
 protected:
 	ConstraintSW(BodySW **p_body_ptr = NULL, int p_body_count = 0) {
@@ -52,12 +53,30 @@ protected:
 		island_step = 0;
 		priority = 1;
 		disabled_collisions_between_bodies = true;
+		stable_id[0] = stable_id[1] = stable_id[2] = 0;
+	}
+
+	_FORCE_INLINE_ void set_stable_id(uint64_t p_a, uint64_t p_b, uint64_t p_c) {
+		stable_id[0] = p_a;
+		stable_id[1] = p_b;
+		stable_id[2] = p_c;
 	}
 
 public:
-	_FORCE_INLINE_ void set_self(const RID &p_self) { self = p_self; }
+	_FORCE_INLINE_ void set_self(const RID &p_self) {
+		self = p_self;
+		set_stable_id(p_self.get_id(), 0, 0);
+	}
 	_FORCE_INLINE_ RID get_self() const { return self; }
 
+	_FORCE_INLINE_ bool is_stable_before(const ConstraintSW *p_constraint) const {
+		for (int i = 0; i < 3; i++) {
+			if (stable_id[i] != p_constraint->stable_id[i])
+				return stable_id[i] < p_constraint->stable_id[i];
+		}
+		return false;
+	}
+
 	_FORCE_INLINE_ uint64_t get_island_step() const { return island_step; }
 	_FORCE_INLINE_ void set_island_step(uint64_t p_step) { island_step = p_step; }
 
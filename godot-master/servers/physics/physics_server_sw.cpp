@@ -33,6 +33,7 @@
 #include "broad_phase_basic.h"
 #include "broad_phase_octree.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 #include "core/script_language.h"
 #include "joints/cone_twist_joint_sw.h"
 #include "joints/generic_6dof_joint_sw.h"
@@ -145,6 +146,7 @@ RID PhysicsServerSW::space_create() {
 	SpaceSW *space = memnew(SpaceSW);
 	RID id = space_owner.make_rid(space);
 	space->set_self(id);
+	space->set_deterministic(deterministic);
 	RID area_id = area_create();
 	AreaSW *area = area_owner.getornull(area_id);
 	ERR_FAIL_COND_V(!area, RID());
@@ -665,7 +667,7 @@ uint32_t PhysicsServerSW::body_get_collision_mask(RID p_body) const {
 	return body->get_collision_mask();
 }
 
-void PhysicsServerSW::body_attach_object_instance_id(RID p_body, uint32_t p_id) {
+void PhysicsServerSW::body_attach_object_instance_id(RID p_body, ObjectID p_id) {
 
 	BodySW *body = body_owner.getornull(p_body);
 	ERR_FAIL_COND(!body);
@@ -673,7 +675,7 @@ void PhysicsServerSW::body_attach_object_instance_id(RID p_body, uint32_t p_id)
 	body->set_instance_id(p_id);
 };
 
-uint32_t PhysicsServerSW::body_get_object_instance_id(RID p_body) const {
+ObjectID PhysicsServerSW::body_get_object_instance_id(RID p_body) const {
 
 	BodySW *body = body_owner.getornull(p_body);
 	ERR_FAIL_COND_V(!body, 0);
@@ -1412,7 +1414,13 @@ void PhysicsServerSW::init() {
 	last_step = 0.001;
 	iterations = 8; // 8?
 	stepper = memnew(StepSW);
+	stepper->set_deterministic(deterministic);
 	direct_state = memnew(PhysicsDirectBodyStateSW);
+
+	if (deterministic && step_log_path != String()) {
+		step_log = FileAccess::open(step_log_path, FileAccess::WRITE);
+		ERR_FAIL_COND_MSG(!step_log, "Cannot open physics step log: " + step_log_path + ".");
+	}
 };
 
 void PhysicsServerSW::step(real_t p_step) {
@@ -1438,7 +1446,18 @@ void PhysicsServerSW::step(real_t p_step) {
 		island_count += E->get()->get_island_count();
 		active_objects += E->get()->get_active_objects();
 		collision_pairs += E->get()->get_collision_pairs();
+
+		if (step_log) {
+			// one record per space and step, compare logs of two runs to find the first desync
+			step_log->store_64(step_count);
+			step_log->store_64(E->get()->get_self().get_id());
+			step_log->store_real(p_step);
+			step_log->store_32(E->get()->get_active_objects());
+			step_log->store_32(E->get()->get_state_hash());
+		}
 	}
+
+	step_count++;
 #endif
 }
 
@@ -1507,8 +1526,36 @@ void PhysicsServerSW::finish() {
 
 	memdelete(stepper);
 	memdelete(direct_state);
+
+	if (step_log) {
+		step_log->close();
+		memdelete(step_log);
+		step_log = NULL;
+	}
 };
 
+void PhysicsServerSW::set_deterministic(bool p_enable) {
+
+	deterministic = p_enable;
+	if (stepper) {
+		stepper->set_deterministic(p_enable);
+	}
+
+	List<RID> spaces;
+	space_owner.get_owned_list(&spaces);
+	for (List<RID>::Element *E = spaces.front(); E; E = E->next()) {
+		space_owner.getornull(E->get())->set_deterministic(p_enable);
+	}
+}
+
+uint32_t PhysicsServerSW::space_get_state_hash(RID p_space) const {
+
+	const SpaceSW *space = space_owner.getornull(p_space);
+	ERR_FAIL_COND_V(!space, 0);
+
+	return space->get_state_hash();
+}
+
 int PhysicsServerSW::get_process_info(ProcessInfo p_info) {
 
 	switch (p_info) {
@@ -1581,6 +1628,12 @@ PhysicsServerSW::PhysicsServerSW() {
 
 	active = true;
 	flushing_queries = false;
+
+	deterministic = GLOBAL_DEF("physics/3d/deterministic_stepping", false);
+	step_log_path = GLOBAL_DEF("physics/3d/deterministic_step_log", "");
+	step_log = NULL;
+	step_count = 0;
+	stepper = NULL;
 };
 
 PhysicsServerSW::~PhysicsServerSW(){
@@ -31,6 +31,7 @@
 #ifndef PHYSICS_SERVER_SW
 #define PHYSICS_SERVER_SW
 
+#include "core/os/file_access.h"
 #include "core/rid_owner.h"
 #include "joints_sw.h"
 #include "servers/physics_server.h"
@@ -57,6 +58,11 @@ class PhysicsServerSW : public PhysicsServer {
 	StepSW *stepper;
 	Set<const SpaceSW *> active_spaces;
 
+	bool deterministic;
+	String step_log_path;
+	FileAccess *step_log;
+	uint64_t step_count;
+
 	PhysicsDirectBodyStateSW *direct_state;
 
 	mutable RID_PtrOwner<ShapeSW> shape_owner;
@@ -177,8 +183,8 @@ public:
 	virtual void body_remove_shape(RID p_body, int p_shape_idx);
 	virtual void body_clear_shapes(RID p_body);
 
-	virtual void body_attach_object_instance_id(RID p_body, uint32_t p_id);
-	virtual uint32_t body_get_object_instance_id(RID p_body) const;
+	virtual void body_attach_object_instance_id(RID p_body, ObjectID p_id);
+	virtual ObjectID body_get_object_instance_id(RID p_body) const;
 
 	virtual void body_set_enable_continuous_collision_detection(RID p_body, bool p_enable);
 	virtual bool body_is_continuous_collision_detection_enabled(RID p_body) const;
@@ -375,6 +381,11 @@ public:
 
 	int get_process_info(ProcessInfo p_info);
 
+	// The step log is only opened by init(), see "physics/3d/deterministic_step_log".
+	void set_deterministic(bool p_enable);
+	bool is_deterministic() const { return deterministic; }
+	uint32_t space_get_state_hash(RID p_space) const; // 0 unless the last step was deterministic
+
 	PhysicsServerSW();
 	~PhysicsServerSW();
 };
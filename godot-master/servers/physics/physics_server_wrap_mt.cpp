@@ -0,0 +1,354 @@
+/*************************************************************************/
+/*  physics_server_wrap_mt.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "physics_server_wrap_mt.h"
+
+#include "core/os/os.h"
+
+void PhysicsServerWrapMT::thread_exit() {
+
+	exit = true;
+}
+
+void PhysicsServerWrapMT::thread_step(real_t p_delta) {
+
+	physics_server->step(p_delta);
+	_snapshot_capture();
+	step_sem->post();
+}
+
+void PhysicsServerWrapMT::_thread_callback(void *_instance) {
+
+	PhysicsServerWrapMT *vsmt = reinterpret_cast<PhysicsServerWrapMT *>(_instance);
+
+	vsmt->thread_loop();
+}
+
+void PhysicsServerWrapMT::thread_loop() {
+
+	server_thread = Thread::get_caller_id();
+
+	physics_server->init();
+
+	exit = false;
+	step_thread_up = true;
+	while (!exit) {
+		// flush pending commands as they arrive, until exit is requested
+		command_queue.wait_and_flush();
+	}
+
+	command_queue.flush_all(); // flush all
+
+	physics_server->finish();
+}
+
+/* STATE SNAPSHOT */
+
+void PhysicsServerWrapMT::_snapshot_capture() {
+
+	snapshot_back.resize(snapshot_bodies.size());
+	BodySnapshot *w = snapshot_back.ptrw();
+
+	// sets iterate in order, so the buffer comes out sorted
+	int i = 0;
+	for (Set<RID>::Element *E = snapshot_bodies.front(); E; E = E->next()) {
+
+		RID body = E->get();
+		w[i].body = body;
+		w[i].transform = physics_server->body_get_state(body, BODY_STATE_TRANSFORM);
+		w[i].linear_velocity = physics_server->body_get_state(body, BODY_STATE_LINEAR_VELOCITY);
+		w[i].angular_velocity = physics_server->body_get_state(body, BODY_STATE_ANGULAR_VELOCITY);
+		w[i].sleeping = physics_server->body_get_state(body, BODY_STATE_SLEEPING);
+		i++;
+	}
+}
+
+void PhysicsServerWrapMT::_snapshot_invalidate(RID p_body) {
+
+	if (!create_thread) {
+		return;
+	}
+
+	snapshot_mutex->lock();
+	snapshot_written.insert(p_body);
+	snapshot_mutex->unlock();
+}
+
+bool PhysicsServerWrapMT::_snapshot_get(RID p_body, BodyState p_state, Variant &r_value) const {
+
+	if (!create_thread || p_state < BODY_STATE_TRANSFORM || p_state > BODY_STATE_SLEEPING) {
+		return false;
+	}
+
+	bool found = false;
+
+	snapshot_mutex->lock();
+
+	if (!snapshot_written.has(p_body) && !snapshot_stepped.has(p_body)) {
+
+		const BodySnapshot *r = snapshot_front.ptr();
+		int low = 0;
+		int high = snapshot_front.size() - 1;
+
+		while (low <= high) {
+
+			int middle = (low + high) / 2;
+			if (r[middle].body < p_body) {
+				low = middle + 1;
+			} else if (p_body < r[middle].body) {
+				high = middle - 1;
+			} else {
+
+				switch (p_state) {
+					case BODY_STATE_TRANSFORM: r_value = r[middle].transform; break;
+					case BODY_STATE_LINEAR_VELOCITY: r_value = r[middle].linear_velocity; break;
+					case BODY_STATE_ANGULAR_VELOCITY: r_value = r[middle].angular_velocity; break;
+					case BODY_STATE_SLEEPING: r_value = r[middle].sleeping; break;
+					default: break;
+				}
+				found = true;
+				break;
+			}
+		}
+	}
+
+	snapshot_mutex->unlock();
+
+	return found;
+}
+
+/* POOLED CREATION */
+
+int PhysicsServerWrapMT::shape_allocn(ShapeType p_shape) {
+
+	for (int i = 0; i < MAX(pool_max_size, 1); i++) {
+		shape_id_pool[p_shape].push_back(physics_server->shape_create(p_shape));
+	}
+	return 0;
+}
+
+int PhysicsServerWrapMT::body_allocn() {
+
+	for (int i = 0; i < MAX(pool_max_size, 1); i++) {
+		body_id_pool.push_back(physics_server->body_create());
+	}
+	return 0;
+}
+
+void PhysicsServerWrapMT::_body_setup(RID p_body, BodyMode p_mode, bool p_init_sleeping) {
+
+	if (p_mode != BODY_MODE_RIGID) {
+		physics_server->body_set_mode(p_body, p_mode);
+	}
+	if (p_init_sleeping) {
+		physics_server->body_set_state(p_body, BODY_STATE_SLEEPING, true);
+	}
+	snapshot_bodies.insert(p_body);
+}
+
+void PhysicsServerWrapMT::_free(RID p_rid) {
+
+	snapshot_bodies.erase(p_rid);
+	physics_server->free(p_rid);
+}
+
+RID PhysicsServerWrapMT::shape_create(ShapeType p_shape) {
+
+	if (Thread::get_caller_id() != server_thread) {
+
+		RID rid;
+
+		if (p_shape < 0 || p_shape >= SHAPE_CUSTOM) {
+			// not pooled, let the server report the error
+			command_queue.push_and_ret(physics_server, &PhysicsServer::shape_create, p_shape, &rid);
+			return rid;
+		}
+
+		alloc_mutex->lock();
+		if (shape_id_pool[p_shape].size() == 0) {
+			int ret;
+			command_queue.push_and_ret(this, &PhysicsServerWrapMT::shape_allocn, p_shape, &ret);
+		}
+		rid = shape_id_pool[p_shape].front()->get();
+		shape_id_pool[p_shape].pop_front();
+		alloc_mutex->unlock();
+		return rid;
+	} else {
+		return physics_server->shape_create(p_shape);
+	}
+}
+
+RID PhysicsServerWrapMT::body_create(BodyMode p_mode, bool p_init_sleeping) {
+
+	if (Thread::get_caller_id() != server_thread) {
+
+		RID rid;
+		alloc_mutex->lock();
+		if (body_id_pool.size() == 0) {
+			int ret;
+			command_queue.push_and_ret(this, &PhysicsServerWrapMT::body_allocn, &ret);
+		}
+		rid = body_id_pool.front()->get();
+		body_id_pool.pop_front();
+		alloc_mutex->unlock();
+
+		command_queue.push(this, &PhysicsServerWrapMT::_body_setup, rid, p_mode, p_init_sleeping);
+		return rid;
+	} else {
+
+		RID rid = physics_server->body_create(p_mode, p_init_sleeping);
+		snapshot_bodies.insert(rid);
+		return rid;
+	}
+}
+
+/* EVENT QUEUING */
+
+void PhysicsServerWrapMT::step(float p_step) {
+
+	if (create_thread) {
+
+		// the step will see every write queued so far
+		snapshot_mutex->lock();
+		for (Set<RID>::Element *E = snapshot_written.front(); E; E = E->next()) {
+			snapshot_stepped.insert(E->get());
+		}
+		snapshot_written.clear();
+		snapshot_mutex->unlock();
+
+		command_queue.push(this, &PhysicsServerWrapMT::thread_step, p_step);
+	} else {
+
+		command_queue.flush_all(); //flush all pending from other threads
+		physics_server->step(p_step);
+	}
+}
+
+void PhysicsServerWrapMT::sync() {
+
+	if (step_sem) {
+		if (first_frame)
+			first_frame = false;
+		else {
+			step_sem->wait(); //must not wait if a step was not issued
+
+			snapshot_mutex->lock();
+			SWAP(snapshot_front, snapshot_back);
+			snapshot_stepped.clear();
+			snapshot_mutex->unlock();
+		}
+	}
+	physics_server->sync();
+}
+
+void PhysicsServerWrapMT::flush_queries() {
+
+	physics_server->flush_queries();
+}
+
+void PhysicsServerWrapMT::init() {
+
+	if (create_thread) {
+
+		step_sem = SemaphoreOld::create();
+		//OS::get_singleton()->release_rendering_thread();
+		if (create_thread) {
+			thread = Thread::create(_thread_callback, this);
+		}
+		while (!step_thread_up) {
+			OS::get_singleton()->delay_usec(1000);
+		}
+	} else {
+
+		physics_server->init();
+	}
+}
+
+void PhysicsServerWrapMT::finish() {
+
+	if (thread) {
+
+		command_queue.push(this, &PhysicsServerWrapMT::thread_exit);
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+
+		thread = NULL;
+	} else {
+		physics_server->finish();
+	}
+
+	space_free_cached_ids();
+	area_free_cached_ids();
+
+	for (int i = 0; i < SHAPE_CUSTOM; i++) {
+		while (shape_id_pool[i].size()) {
+			physics_server->free(shape_id_pool[i].front()->get());
+			shape_id_pool[i].pop_front();
+		}
+	}
+	while (body_id_pool.size()) {
+		physics_server->free(body_id_pool.front()->get());
+		body_id_pool.pop_front();
+	}
+
+	if (step_sem)
+		memdelete(step_sem);
+}
+
+PhysicsServerWrapMT::PhysicsServerWrapMT(PhysicsServer *p_contained, bool p_create_thread) :
+		command_queue(p_create_thread) {
+
+	physics_server = p_contained;
+	create_thread = p_create_thread;
+	thread = NULL;
+	step_sem = NULL;
+	step_thread_up = false;
+	alloc_mutex = Mutex::create();
+	snapshot_mutex = Mutex::create();
+
+	pool_max_size = GLOBAL_GET("memory/limits/multithreaded_server/rid_pool_prealloc");
+
+	if (!p_create_thread) {
+		server_thread = Thread::get_caller_id();
+	} else {
+		server_thread = 0;
+	}
+
+	main_thread = Thread::get_caller_id();
+	first_frame = true;
+}
+
+PhysicsServerWrapMT::~PhysicsServerWrapMT() {
+
+	memdelete(physics_server);
+	memdelete(alloc_mutex);
+	memdelete(snapshot_mutex);
+	//finish();
+}
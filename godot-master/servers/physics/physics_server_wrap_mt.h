@@ -0,0 +1,503 @@
+/*************************************************************************/
+/*  physics_server_wrap_mt.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PHYSICSSERVERWRAPMT_H
+#define PHYSICSSERVERWRAPMT_H
+
+#include "core/command_queue_mt.h"
+#include "core/os/thread.h"
+#include "core/project_settings.h"
+#include "core/set.h"
+#include "servers/physics_server.h"
+
+#ifdef DEBUG_SYNC
+#define SYNC_DEBUG print_line("sync on: " + String(__FUNCTION__));
+#else
+#define SYNC_DEBUG
+#endif
+
+// body setters that can change what the state snapshot holds
+#define FUNC2BODY(m_type, m_arg2)                                               \
+	virtual void m_type(RID p1, m_arg2 p2) {                                    \
+		if (Thread::get_caller_id() != server_thread) {                         \
+			_snapshot_invalidate(p1);                                           \
+			command_queue.push(physics_server, &PhysicsServer::m_type, p1, p2); \
+		} else {                                                                \
+			physics_server->m_type(p1, p2);                                     \
+		}                                                                       \
+	}
+
+#define FUNC3BODY(m_type, m_arg2, m_arg3)                                           \
+	virtual void m_type(RID p1, m_arg2 p2, m_arg3 p3) {                             \
+		if (Thread::get_caller_id() != server_thread) {                             \
+			_snapshot_invalidate(p1);                                               \
+			command_queue.push(physics_server, &PhysicsServer::m_type, p1, p2, p3); \
+		} else {                                                                    \
+			physics_server->m_type(p1, p2, p3);                                     \
+		}                                                                           \
+	}
+
+class PhysicsServerWrapMT : public PhysicsServer {
+
+	mutable PhysicsServer *physics_server;
+
+	mutable CommandQueueMT command_queue;
+
+	static void _thread_callback(void *_instance);
+	void thread_loop();
+
+	Thread::ID server_thread;
+	Thread::ID main_thread;
+	volatile bool exit;
+	Thread *thread;
+	volatile bool step_thread_up;
+	bool create_thread;
+
+	SemaphoreOld *step_sem;
+	void thread_step(real_t p_delta);
+
+	void thread_exit();
+
+	bool first_frame;
+
+	Mutex *alloc_mutex;
+	int pool_max_size;
+
+	// Shapes and bodies take arguments that FUNCRID can't forward, so their
+	// pools are kept by hand. Shapes get one pool per type, filled the first
+	// time that type is requested. Pooled bodies are created rigid and awake,
+	// the requested mode and sleep state are queued with the RID.
+	List<RID> shape_id_pool[SHAPE_CUSTOM];
+	List<RID> body_id_pool;
+
+	int shape_allocn(ShapeType p_shape);
+	int body_allocn();
+	void _body_setup(RID p_body, BodyMode p_mode, bool p_init_sleeping);
+	void _free(RID p_rid);
+
+	// Body state snapshot. After every step the server thread copies the
+	// transform, velocities and sleep state of every body into the back
+	// buffer, sync() swaps it to the front, and body_get_state() answers from
+	// the front instead of waiting for the server thread. Bodies written to
+	// since the last step was queued are left out of both until a step that
+	// saw the write is swapped in.
+	struct BodySnapshot {
+		RID body;
+		Transform transform;
+		Vector3 linear_velocity;
+		Vector3 angular_velocity;
+		bool sleeping;
+	};
+
+	Set<RID> snapshot_bodies; // server thread only
+	Vector<BodySnapshot> snapshot_back; // sorted by RID
+	Vector<BodySnapshot> snapshot_front;
+	Set<RID> snapshot_written; // since the last step was queued
+	Set<RID> snapshot_stepped; // before the last step was queued, until it is swapped in
+	Mutex *snapshot_mutex;
+
+	void _snapshot_capture();
+	void _snapshot_invalidate(RID p_body);
+	bool _snapshot_get(RID p_body, BodyState p_state, Variant &r_value) const;
+
+public:
+#define ServerName PhysicsServer
+#define ServerNameWrapMT PhysicsServerWrapMT
+#define server_name physics_server
+#include "servers/server_wrap_mt_common.h"
+
+	virtual RID shape_create(ShapeType p_shape);
+	FUNC2(shape_set_data, RID, const Variant &);
+	FUNC2(shape_set_custom_solver_bias, RID, real_t);
+
+	FUNC2(shape_set_margin, RID, real_t);
+	FUNC1RC(real_t, shape_get_margin, RID);
+
+	FUNC1RC(ShapeType, shape_get_type, RID);
+	FUNC1RC(Variant, shape_get_data, RID);
+	FUNC1RC(real_t, shape_get_custom_solver_bias, RID);
+
+	/* SPACE API */
+
+	FUNCRID(space);
+	FUNC2(space_set_active, RID, bool);
+	FUNC1RC(bool, space_is_active, RID);
+
+	FUNC3(space_set_param, RID, SpaceParameter, real_t);
+	FUNC2RC(real_t, space_get_param, RID, SpaceParameter);
+
+	// this function only works on physics process, errors and returns null otherwise
+	PhysicsDirectSpaceState *space_get_direct_state(RID p_space) {
+
+		ERR_FAIL_COND_V(main_thread != Thread::get_caller_id(), NULL);
+		return physics_server->space_get_direct_state(p_space);
+	}
+
+	FUNC2(space_set_debug_contacts, RID, int);
+	virtual Vector<Vector3> space_get_contacts(RID p_space) const {
+
+		ERR_FAIL_COND_V(main_thread != Thread::get_caller_id(), Vector<Vector3>());
+		return physics_server->space_get_contacts(p_space);
+	}
+
+	virtual int space_get_contact_count(RID p_space) const {
+
+		ERR_FAIL_COND_V(main_thread != Thread::get_caller_id(), 0);
+		return physics_server->space_get_contact_count(p_space);
+	}
+
+	/* AREA API */
+
+	FUNCRID(area);
+
+	FUNC2(area_set_space, RID, RID);
+	FUNC1RC(RID, area_get_space, RID);
+
+	FUNC2(area_set_space_override_mode, RID, AreaSpaceOverrideMode);
+	FUNC1RC(AreaSpaceOverrideMode, area_get_space_override_mode, RID);
+
+	FUNC4(area_add_shape, RID, RID, const Transform &, bool);
+	FUNC3(area_set_shape, RID, int, RID);
+	FUNC3(area_set_shape_transform, RID, int, const Transform &);
+	FUNC3(area_set_shape_disabled, RID, int, bool);
+
+	FUNC1RC(int, area_get_shape_count, RID);
+	FUNC2RC(RID, area_get_shape, RID, int);
+	FUNC2RC(Transform, area_get_shape_transform, RID, int);
+	FUNC2(area_remove_shape, RID, int);
+	FUNC1(area_clear_shapes, RID);
+
+	FUNC2(area_attach_object_instance_id, RID, ObjectID);
+	FUNC1RC(ObjectID, area_get_object_instance_id, RID);
+
+	FUNC3(area_set_param, RID, AreaParameter, const Variant &);
+	FUNC2(area_set_transform, RID, const Transform &);
+
+	FUNC2RC(Variant, area_get_param, RID, AreaParameter);
+	FUNC1RC(Transform, area_get_transform, RID);
+
+	FUNC2(area_set_collision_mask, RID, uint32_t);
+	FUNC2(area_set_collision_layer, RID, uint32_t);
+
+	FUNC2(area_set_monitorable, RID, bool);
+
+	FUNC3(area_set_monitor_callback, RID, Object *, const StringName &);
+	FUNC3(area_set_area_monitor_callback, RID, Object *, const StringName &);
+
+	FUNC2(area_set_ray_pickable, RID, bool);
+	FUNC1RC(bool, area_is_ray_pickable, RID);
+
+	/* BODY API */
+
+	virtual RID body_create(BodyMode p_mode, bool p_init_sleeping);
+
+	FUNC2(body_set_space, RID, RID);
+	FUNC1RC(RID, body_get_space, RID);
+
+	FUNC2BODY(body_set_mode, BodyMode);
+	FUNC1RC(BodyMode, body_get_mode, RID);
+
+	FUNC4(body_add_shape, RID, RID, const Transform &, bool);
+	FUNC3(body_set_shape, RID, int, RID);
+	FUNC3(body_set_shape_transform, RID, int, const Transform &);
+
+	FUNC1RC(int, body_get_shape_count, RID);
+	FUNC2RC(Transform, body_get_shape_transform, RID, int);
+	FUNC2RC(RID, body_get_shape, RID, int);
+
+	FUNC3(body_set_shape_disabled, RID, int, bool);
+
+	FUNC2(body_remove_shape, RID, int);
+	FUNC1(body_clear_shapes, RID);
+
+	FUNC2(body_attach_object_instance_id, RID, ObjectID);
+	FUNC1RC(ObjectID, body_get_object_instance_id, RID);
+
+	FUNC2(body_set_enable_continuous_collision_detection, RID, bool);
+	FUNC1RC(bool, body_is_continuous_collision_detection_enabled, RID);
+
+	FUNC2(body_set_collision_layer, RID, uint32_t);
+	FUNC1RC(uint32_t, body_get_collision_layer, RID);
+
+	FUNC2(body_set_collision_mask, RID, uint32_t);
+	FUNC1RC(uint32_t, body_get_collision_mask, RID);
+
+	FUNC2(body_set_user_flags, RID, uint32_t);
+	FUNC1RC(uint32_t, body_get_user_flags, RID);
+
+	FUNC3(body_set_param, RID, BodyParameter, float);
+	FUNC2RC(float, body_get_param, RID, BodyParameter);
+
+	FUNC2(body_set_kinematic_safe_margin, RID, real_t);
+	FUNC1RC(real_t, body_get_kinematic_safe_margin, RID);
+
+	FUNC3BODY(body_set_state, BodyState, const Variant &);
+	virtual Variant body_get_state(RID p_body, BodyState p_state) const {
+
+		if (Thread::get_caller_id() != server_thread) {
+			Variant ret;
+			if (_snapshot_get(p_body, p_state, ret)) {
+				return ret;
+			}
+			command_queue.push_and_ret(physics_server, &PhysicsServer::body_get_state, p_body, p_state, &ret);
+			SYNC_DEBUG
+			return ret;
+		} else {
+			return physics_server->body_get_state(p_body, p_state);
+		}
+	}
+
+	FUNC2BODY(body_set_applied_force, const Vector3 &);
+	FUNC1RC(Vector3, body_get_applied_force, RID);
+
+	FUNC2BODY(body_set_applied_torque, const Vector3 &);
+	FUNC1RC(Vector3, body_get_applied_torque, RID);
+
+	FUNC2BODY(body_add_central_force, const Vector3 &);
+	FUNC3BODY(body_add_force, const Vector3 &, const Vector3 &);
+	FUNC2BODY(body_add_torque, const Vector3 &);
+	FUNC2BODY(body_apply_central_impulse, const Vector3 &);
+	FUNC3BODY(body_apply_impulse, const Vector3 &, const Vector3 &);
+	FUNC2BODY(body_apply_torque_impulse, const Vector3 &);
+	FUNC2BODY(body_set_axis_velocity, const Vector3 &);
+
+	FUNC3BODY(body_set_axis_lock, BodyAxis, bool);
+	FUNC2RC(bool, body_is_axis_locked, RID, BodyAxis);
+
+	FUNC2(body_add_collision_exception, RID, RID);
+	FUNC2(body_remove_collision_exception, RID, RID);
+	FUNC2S(body_get_collision_exceptions, RID, List<RID> *);
+
+	FUNC2(body_set_max_contacts_reported, RID, int);
+	FUNC1RC(int, body_get_max_contacts_reported, RID);
+
+	FUNC2(body_set_contacts_reported_depth_threshold, RID, float);
+	FUNC1RC(float, body_get_contacts_reported_depth_threshold, RID);
+
+	FUNC2(body_set_omit_force_integration, RID, bool);
+	FUNC1RC(bool, body_is_omitting_force_integration, RID);
+
+	FUNC4(body_set_force_integration_callback, RID, Object *, const StringName &, const Variant &);
+
+	FUNC2(body_set_ray_pickable, RID, bool);
+	FUNC1RC(bool, body_is_ray_pickable, RID);
+
+	// this function only works on physics process, errors and returns null otherwise
+	PhysicsDirectBodyState *body_get_direct_state(RID p_body) {
+
+		ERR_FAIL_COND_V(main_thread != Thread::get_caller_id(), NULL);
+		return physics_server->body_get_direct_state(p_body);
+	}
+
+	bool body_test_motion(RID p_body, const Transform &p_from, const Vector3 &p_motion, bool p_infinite_inertia, MotionResult *r_result = NULL, bool p_exclude_raycast_shapes = true) {
+
+		ERR_FAIL_COND_V(main_thread != Thread::get_caller_id(), false);
+		return physics_server->body_test_motion(p_body, p_from, p_motion, p_infinite_inertia, r_result, p_exclude_raycast_shapes);
+	}
+
+	int body_test_ray_separation(RID p_body, const Transform &p_transform, bool p_infinite_inertia, Vector3 &r_recover_motion, SeparationResult *r_results, int p_result_max, float p_margin = 0.001) {
+
+		ERR_FAIL_COND_V(main_thread != Thread::get_caller_id(), false);
+		return physics_server->body_test_ray_separation(p_body, p_transform, p_infinite_inertia, r_recover_motion, r_results, p_result_max, p_margin);
+	}
+
+	/* SOFT BODY API */
+
+	FUNC1R(RID, soft_body_create, bool);
+
+	FUNC2(soft_body_update_visual_server, RID, SoftBodyVisualServerHandler *);
+
+	FUNC2(soft_body_set_space, RID, RID);
+	FUNC1RC(RID, soft_body_get_space, RID);
+
+	FUNC2(soft_body_set_mesh, RID, const REF &);
+
+	FUNC2(soft_body_set_collision_layer, RID, uint32_t);
+	FUNC1RC(uint32_t, soft_body_get_collision_layer, RID);
+
+	FUNC2(soft_body_set_collision_mask, RID, uint32_t);
+	FUNC1RC(uint32_t, soft_body_get_collision_mask, RID);
+
+	FUNC2(soft_body_add_collision_exception, RID, RID);
+	FUNC2(soft_body_remove_collision_exception, RID, RID);
+	FUNC2S(soft_body_get_collision_exceptions, RID, List<RID> *);
+
+	FUNC3(soft_body_set_state, RID, BodyState, const Variant &);
+	FUNC2RC(Variant, soft_body_get_state, RID, BodyState);
+
+	FUNC2(soft_body_set_transform, RID, const Transform &);
+	FUNC2RC(Vector3, soft_body_get_vertex_position, RID, int);
+
+	FUNC2(soft_body_set_ray_pickable, RID, bool);
+	FUNC1RC(bool, soft_body_is_ray_pickable, RID);
+
+	FUNC2(soft_body_set_simulation_precision, RID, int);
+	FUNC1R(int, soft_body_get_simulation_precision, RID);
+
+	FUNC2(soft_body_set_total_mass, RID, real_t);
+	FUNC1R(real_t, soft_body_get_total_mass, RID);
+
+	FUNC2(soft_body_set_linear_stiffness, RID, real_t);
+	FUNC1R(real_t, soft_body_get_linear_stiffness, RID);
+
+	FUNC2(soft_body_set_areaAngular_stiffness, RID, real_t);
+	FUNC1R(real_t, soft_body_get_areaAngular_stiffness, RID);
+
+	FUNC2(soft_body_set_volume_stiffness, RID, real_t);
+	FUNC1R(real_t, soft_body_get_volume_stiffness, RID);
+
+	FUNC2(soft_body_set_pressure_coefficient, RID, real_t);
+	FUNC1R(real_t, soft_body_get_pressure_coefficient, RID);
+
+	FUNC2(soft_body_set_pose_matching_coefficient, RID, real_t);
+	FUNC1R(real_t, soft_body_get_pose_matching_coefficient, RID);
+
+	FUNC2(soft_body_set_damping_coefficient, RID, real_t);
+	FUNC1R(real_t, soft_body_get_damping_coefficient, RID);
+
+	FUNC2(soft_body_set_drag_coefficient, RID, real_t);
+	FUNC1R(real_t, soft_body_get_drag_coefficient, RID);
+
+	FUNC3(soft_body_move_point, RID, int, const Vector3 &);
+	FUNC2R(Vector3, soft_body_get_point_global_position, RID, int);
+
+	FUNC2RC(Vector3, soft_body_get_point_offset, RID, int);
+
+	FUNC1(soft_body_remove_all_pinned_points, RID);
+	FUNC3(soft_body_pin_point, RID, int, bool);
+	FUNC2R(bool, soft_body_is_point_pinned, RID, int);
+
+	/* JOINT API */
+
+	FUNC1RC(JointType, joint_get_type, RID);
+
+	FUNC2(joint_set_solver_priority, RID, int);
+	FUNC1RC(int, joint_get_solver_priority, RID);
+
+	FUNC2(joint_disable_collisions_between_bodies, RID, const bool);
+	FUNC1RC(bool, joint_is_disabled_collisions_between_bodies, RID);
+
+	FUNC4R(RID, joint_create_pin, RID, const Vector3 &, RID, const Vector3 &);
+
+	FUNC3(pin_joint_set_param, RID, PinJointParam, float);
+	FUNC2RC(float, pin_joint_get_param, RID, PinJointParam);
+
+	FUNC2(pin_joint_set_local_a, RID, const Vector3 &);
+	FUNC1RC(Vector3, pin_joint_get_local_a, RID);
+
+	FUNC2(pin_joint_set_local_b, RID, const Vector3 &);
+	FUNC1RC(Vector3, pin_joint_get_local_b, RID);
+
+	FUNC4R(RID, joint_create_hinge, RID, const Transform &, RID, const Transform &);
+	FUNC6R(RID, joint_create_hinge_simple, RID, const Vector3 &, const Vector3 &, RID, const Vector3 &, const Vector3 &);
+
+	FUNC3(hinge_joint_set_param, RID, HingeJointParam, float);
+	FUNC2RC(float, hinge_joint_get_param, RID, HingeJointParam);
+
+	FUNC3(hinge_joint_set_flag, RID, HingeJointFlag, bool);
+	FUNC2RC(bool, hinge_joint_get_flag, RID, HingeJointFlag);
+
+	FUNC4R(RID, joint_create_slider, RID, const Transform &, RID, const Transform &);
+
+	FUNC3(slider_joint_set_param, RID, SliderJointParam, float);
+	FUNC2RC(float, slider_joint_get_param, RID, SliderJointParam);
+
+	FUNC4R(RID, joint_create_cone_twist, RID, const Transform &, RID, const Transform &);
+
+	FUNC3(cone_twist_joint_set_param, RID, ConeTwistJointParam, float);
+	FUNC2RC(float, cone_twist_joint_get_param, RID, ConeTwistJointParam);
+
+	FUNC4R(RID, joint_create_generic_6dof, RID, const Transform &, RID, const Transform &);
+
+	FUNC4(generic_6dof_joint_set_param, RID, Vector3::Axis, G6DOFJointAxisParam, float);
+	FUNC3R(float, generic_6dof_joint_get_param, RID, Vector3::Axis, G6DOFJointAxisParam);
+
+	FUNC4(generic_6dof_joint_set_flag, RID, Vector3::Axis, G6DOFJointAxisFlag, bool);
+	FUNC3R(bool, generic_6dof_joint_get_flag, RID, Vector3::Axis, G6DOFJointAxisFlag);
+
+	FUNC2(generic_6dof_joint_set_precision, RID, int);
+	FUNC1R(int, generic_6dof_joint_get_precision, RID);
+
+	/* MISC */
+
+	virtual void free(RID p_rid) {
+
+		if (Thread::get_caller_id() != server_thread) {
+			_snapshot_invalidate(p_rid);
+			command_queue.push(this, &PhysicsServerWrapMT::_free, p_rid);
+		} else {
+			_free(p_rid);
+		}
+	}
+
+	FUNC1(set_active, bool);
+
+	virtual void init();
+	virtual void step(float p_step);
+	virtual void sync();
+	virtual void flush_queries();
+	virtual void finish();
+
+	virtual bool is_flushing_queries() const {
+		return physics_server->is_flushing_queries();
+	}
+
+	int get_process_info(ProcessInfo p_info) {
+		return physics_server->get_process_info(p_info);
+	}
+
+	PhysicsServerWrapMT(PhysicsServer *p_contained, bool p_create_thread);
+	~PhysicsServerWrapMT();
+
+	template <class T>
+	static PhysicsServer *init_server() {
+
+		int tm = GLOBAL_DEF("physics/3d/thread_model", 0);
+		if (tm == 0) // single unsafe
+			return memnew(T);
+		else if (tm == 1) // single safe
+			return memnew(PhysicsServerWrapMT(memnew(T), false));
+		else // multi threaded
+			return memnew(PhysicsServerWrapMT(memnew(T), true));
+	}
+
+#undef ServerNameWrapMT
+#undef ServerName
+#undef server_name
+};
+
+#ifdef DEBUG_SYNC
+#undef DEBUG_SYNC
+#endif
+#undef SYNC_DEBUG
+#undef FUNC2BODY
+#undef FUNC3BODY
+
+#endif // PHYSICSSERVERWRAPMT_H
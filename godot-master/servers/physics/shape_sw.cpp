@@ -30,6 +30,7 @@
 
 #include "shape_sw.h"
 
+#include "core/hash_map.h"
 #include "core/math/geometry.h"
 #include "core/math/quick_hull.h"
 #include "core/sort_array.h"
@@ -41,6 +42,7 @@
 void ShapeSW::configure(const AABB &p_aabb) {
 	aabb = p_aabb;
 	configured = true;
+	version++;
 	for (Map<ShapeOwnerSW *, int>::Element *E = owners.front(); E; E = E->next()) {
 		ShapeOwnerSW *co = (ShapeOwnerSW *)E->key();
 		co->_shape_changed();
@@ -88,6 +90,7 @@ ShapeSW::ShapeSW() {
 
 	custom_bias = 0;
 	configured = false;
+	version = 0;
 }
 
 ShapeSW::~ShapeSW() {
@@ -719,38 +722,44 @@ void ConvexPolygonShapeSW::project_range(const Vector3 &p_normal, const Transfor
 
 	const Vector3 *vrts = &mesh.vertices[0];
 
-	for (int i = 0; i < vertex_count; i++) {
+	// project in local space, so only the normal needs to be transformed instead of every vertex
+	Vector3 local_normal = p_transform.basis.xform_inv(p_normal);
+	real_t distance = p_normal.dot(p_transform.origin);
 
-		real_t d = p_normal.dot(p_transform.xform(vrts[i]));
+	real_t min = local_normal.dot(vrts[0]);
+	real_t max = min;
 
-		if (i == 0 || d > r_max)
-			r_max = d;
-		if (i == 0 || d < r_min)
-			r_min = d;
+	// branchless loop, so it can be vectorized by the compiler
+	for (int i = 1; i < vertex_count; i++) {
+
+		real_t d = local_normal.dot(vrts[i]);
+		min = MIN(min, d);
+		max = MAX(max, d);
 	}
+
+	r_min = min + distance;
+	r_max = max + distance;
 }
 
 Vector3 ConvexPolygonShapeSW::get_support(const Vector3 &p_normal) const {
 
 	Vector3 n = p_normal;
 
-	int vert_support_idx = -1;
-	real_t support_max = 0;
-
 	int vertex_count = mesh.vertices.size();
 	if (vertex_count == 0)
 		return Vector3();
 
 	const Vector3 *vrts = &mesh.vertices[0];
 
-	for (int i = 0; i < vertex_count; i++) {
+	int vert_support_idx = 0;
+	real_t support_max = n.dot(vrts[0]);
 
-		real_t d = n.dot(vrts[i]);
+	for (int i = 1; i < vertex_count; i++) {
 
-		if (i == 0 || d > support_max) {
-			support_max = d;
-			vert_support_idx = i;
-		}
+		real_t d = n.dot(vrts[i]);
+		bool greater = d > support_max;
+		support_max = greater ? d : support_max;
+		vert_support_idx = greater ? i : vert_support_idx;
 	}
 
 	return vrts[vert_support_idx];
@@ -958,6 +967,38 @@ void ConvexPolygonShapeSW::_setup(const Vector<Vector3> &p_vertices) {
 	if (err != OK)
 		ERR_PRINT("Failed to build QuickHull");
 
+	HashMap<uint64_t, int> edge_map;
+	for (int i = 0; i < mesh.edges.size(); i++) {
+		const Geometry::MeshData::Edge &e = mesh.edges[i];
+		edge_map.set(((uint64_t)MIN(e.a, e.b) << 32) | MAX(e.a, e.b), i);
+	}
+
+	edge_faces.resize(mesh.edges.size());
+	for (int i = 0; i < edge_faces.size(); i++) {
+		edge_faces.write[i].face_a = -1;
+		edge_faces.write[i].face_b = -1;
+	}
+
+	for (int i = 0; i < mesh.faces.size(); i++) {
+
+		const Vector<int> &indices = mesh.faces[i].indices;
+
+		for (int j = 0; j < indices.size(); j++) {
+
+			int a = indices[j];
+			int b = indices[(j + 1) % indices.size()];
+			const int *edge = edge_map.getptr(((uint64_t)MIN(a, b) << 32) | MAX(a, b));
+			if (!edge)
+				continue;
+
+			EdgeFaces &ef = edge_faces.write[*edge];
+			if (ef.face_a == -1)
+				ef.face_a = i;
+			else
+				ef.face_b = i;
+		}
+	}
+
 	AABB _aabb;
 
 	for (int i = 0; i < mesh.vertices.size(); i++) {
@@ -1548,7 +1589,17 @@ ConcavePolygonShapeSW::ConcavePolygonShapeSW() {
 
 PoolVector<real_t> HeightMapShapeSW::get_heights() const {
 
-	return heights;
+	if (!compressed)
+		return heights;
+
+	PoolVector<real_t> decoded;
+	decoded.resize(width * depth);
+	PoolVector<real_t>::Write w = decoded.write();
+	for (int i = 0; i < width * depth; i++) {
+		w[i] = compressed_min + compressed_heights[i] * compressed_step;
+	}
+
+	return decoded;
 }
 int HeightMapShapeSW::get_width() const {
 
@@ -1562,6 +1613,10 @@ real_t HeightMapShapeSW::get_cell_size() const {
 
 	return cell_size;
 }
+bool HeightMapShapeSW::is_compressed() const {
+
+	return compressed;
+}
 
 void HeightMapShapeSW::project_range(const Vector3 &p_normal, const Transform &p_transform, real_t &r_min, real_t &r_max) const {
 
@@ -1575,8 +1630,150 @@ Vector3 HeightMapShapeSW::get_support(const Vector3 &p_normal) const {
 	return get_aabb().get_support(p_normal);
 }
 
+void HeightMapShapeSW::_get_cell_range(const real_t *p_heights, int p_x, int p_z, real_t &r_min, real_t &r_max) const {
+
+	real_t h00 = _get_height(p_heights, p_x, p_z);
+	real_t h10 = _get_height(p_heights, p_x + 1, p_z);
+	real_t h01 = _get_height(p_heights, p_x, p_z + 1);
+	real_t h11 = _get_height(p_heights, p_x + 1, p_z + 1);
+
+	r_min = MIN(MIN(h00, h10), MIN(h01, h11));
+	r_max = MAX(MAX(h00, h10), MAX(h01, h11));
+}
+
+bool HeightMapShapeSW::_intersect_cell(const real_t *p_heights, int p_x, int p_z, const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
+
+	Vector3 p00 = _get_point(p_heights, p_x, p_z);
+	Vector3 p10 = _get_point(p_heights, p_x + 1, p_z);
+	Vector3 p01 = _get_point(p_heights, p_x, p_z + 1);
+	Vector3 p11 = _get_point(p_heights, p_x + 1, p_z + 1);
+
+	bool found = false;
+	real_t closest = 0;
+	Vector3 res;
+
+	if (Geometry::segment_intersects_triangle(p_begin, p_end, p00, p10, p01, &res)) {
+
+		closest = p_begin.distance_squared_to(res);
+		r_point = res;
+		r_normal = Plane(p00, p10, p01).normal;
+		found = true;
+	}
+
+	if (Geometry::segment_intersects_triangle(p_begin, p_end, p10, p11, p01, &res)) {
+
+		real_t d = p_begin.distance_squared_to(res);
+		if (!found || d < closest) {
+			r_point = res;
+			r_normal = Plane(p10, p11, p01).normal;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
 bool HeightMapShapeSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
 
+	if (width < 2 || depth < 2)
+		return false;
+
+	// clip the segment against the bounds of the shape
+
+	AABB aabb = get_aabb();
+	Vector3 dir = p_end - p_begin;
+	real_t t_min = 0;
+	real_t t_max = 1;
+
+	for (int i = 0; i < 3; i++) {
+
+		if (Math::abs(dir[i]) < CMP_EPSILON) {
+			if (p_begin[i] < aabb.position[i] || p_begin[i] > aabb.position[i] + aabb.size[i])
+				return false;
+			continue;
+		}
+
+		real_t inv = 1.0 / dir[i];
+		real_t t_a = (aabb.position[i] - p_begin[i]) * inv;
+		real_t t_b = (aabb.position[i] + aabb.size[i] - p_begin[i]) * inv;
+		if (t_a > t_b)
+			SWAP(t_a, t_b);
+
+		t_min = MAX(t_min, t_a);
+		t_max = MIN(t_max, t_b);
+		if (t_min > t_max)
+			return false;
+	}
+
+	Vector3 begin = p_begin + dir * t_min;
+	Vector3 end = p_begin + dir * t_max;
+
+	PoolVector<real_t>::Read r;
+	const real_t *h = NULL;
+	if (!compressed) {
+		r = heights.read();
+		h = r.ptr();
+	}
+
+	// walk the cells crossed by the segment in the XZ plane, front to back
+
+	Vector3 grid_begin = (begin - local_origin) / cell_size;
+	Vector3 grid_end = (end - local_origin) / cell_size;
+	real_t grid_dx = grid_end.x - grid_begin.x;
+	real_t grid_dz = grid_end.z - grid_begin.z;
+
+	int x = CLAMP((int)Math::floor(grid_begin.x), 0, width - 2);
+	int z = CLAMP((int)Math::floor(grid_begin.z), 0, depth - 2);
+	int step_x = grid_dx > 0 ? 1 : -1;
+	int step_z = grid_dz > 0 ? 1 : -1;
+
+	real_t delta_x = Math::abs(grid_dx) > CMP_EPSILON ? 1.0 / Math::abs(grid_dx) : 1e20;
+	real_t delta_z = Math::abs(grid_dz) > CMP_EPSILON ? 1.0 / Math::abs(grid_dz) : 1e20;
+	real_t next_x = Math::abs(grid_dx) > CMP_EPSILON ? (step_x > 0 ? (x + 1 - grid_begin.x) : (grid_begin.x - x)) * delta_x : 1e20;
+	real_t next_z = Math::abs(grid_dz) > CMP_EPSILON ? (step_z > 0 ? (z + 1 - grid_begin.z) : (grid_begin.z - z)) * delta_z : 1e20;
+
+	const BoundsLevel &chunks = bounds[0];
+	real_t t = 0;
+
+	while (true) {
+
+		real_t t_exit = MIN(MIN(next_x, next_z), (real_t)1.0);
+
+		// height range covered by the segment inside this cell
+		real_t y_a = begin.y + (end.y - begin.y) * t;
+		real_t y_b = begin.y + (end.y - begin.y) * t_exit;
+		real_t y_min = MIN(y_a, y_b);
+		real_t y_max = MAX(y_a, y_b);
+
+		const Range &chunk = chunks.ranges[(z / BOUNDS_CHUNK_SIZE) * chunks.width + (x / BOUNDS_CHUNK_SIZE)];
+
+		if (y_min <= chunk.max && y_max >= chunk.min) {
+
+			real_t cell_min, cell_max;
+			_get_cell_range(h, x, z, cell_min, cell_max);
+
+			if (y_min <= cell_max && y_max >= cell_min && _intersect_cell(h, x, z, begin, end, r_point, r_normal)) {
+				return true;
+			}
+		}
+
+		if (t_exit >= 1.0)
+			break;
+
+		if (next_x < next_z) {
+			x += step_x;
+			t = next_x;
+			next_x += delta_x;
+		} else {
+			z += step_z;
+			t = next_z;
+			next_z += delta_z;
+		}
+
+		if (x < 0 || x >= width - 1 || z < 0 || z >= depth - 1)
+			break;
+	}
+
 	return false;
 }
 
@@ -1589,7 +1786,93 @@ Vector3 HeightMapShapeSW::get_closest_point_to(const Vector3 &p_point) const {
 	return Vector3();
 }
 
+void HeightMapShapeSW::_cull_chunk(int p_level, int p_x, int p_z, _CullParams *p_params) const {
+
+	const BoundsLevel &level = bounds[p_level];
+	if (p_x >= level.width || p_z >= level.depth)
+		return;
+
+	// cell range covered by this chunk, clipped to the query
+	int chunk_cells = BOUNDS_CHUNK_SIZE << p_level;
+	int from_x = MAX(p_x * chunk_cells, p_params->from_x);
+	int from_z = MAX(p_z * chunk_cells, p_params->from_z);
+	int to_x = MIN((p_x + 1) * chunk_cells - 1, p_params->to_x);
+	int to_z = MIN((p_z + 1) * chunk_cells - 1, p_params->to_z);
+
+	if (from_x > to_x || from_z > to_z)
+		return;
+
+	const Range &range = level.ranges[p_z * level.width + p_x];
+	if (range.min > p_params->aabb.position.y + p_params->aabb.size.y || range.max < p_params->aabb.position.y)
+		return;
+
+	if (p_level > 0) {
+
+		_cull_chunk(p_level - 1, p_x * 2, p_z * 2, p_params);
+		_cull_chunk(p_level - 1, p_x * 2 + 1, p_z * 2, p_params);
+		_cull_chunk(p_level - 1, p_x * 2, p_z * 2 + 1, p_params);
+		_cull_chunk(p_level - 1, p_x * 2 + 1, p_z * 2 + 1, p_params);
+		return;
+	}
+
+	const real_t *h = p_params->heights;
+	FaceShapeSW *face = p_params->face;
+
+	for (int z = from_z; z <= to_z; z++) {
+
+		for (int x = from_x; x <= to_x; x++) {
+
+			real_t cell_min, cell_max;
+			_get_cell_range(h, x, z, cell_min, cell_max);
+
+			if (cell_min > p_params->aabb.position.y + p_params->aabb.size.y || cell_max < p_params->aabb.position.y)
+				continue;
+
+			Vector3 p00 = _get_point(h, x, z);
+			Vector3 p10 = _get_point(h, x + 1, z);
+			Vector3 p01 = _get_point(h, x, z + 1);
+			Vector3 p11 = _get_point(h, x + 1, z + 1);
+
+			face->vertex[0] = p00;
+			face->vertex[1] = p10;
+			face->vertex[2] = p01;
+			face->normal = Plane(p00, p10, p01).normal;
+			p_params->callback(p_params->userdata, face);
+
+			face->vertex[0] = p10;
+			face->vertex[1] = p11;
+			face->vertex[2] = p01;
+			face->normal = Plane(p10, p11, p01).normal;
+			p_params->callback(p_params->userdata, face);
+		}
+	}
+}
+
 void HeightMapShapeSW::cull(const AABB &p_local_aabb, Callback p_callback, void *p_userdata) const {
+
+	if (width < 2 || depth < 2 || !p_local_aabb.intersects_inclusive(get_aabb()))
+		return;
+
+	_CullParams params;
+	params.aabb = p_local_aabb;
+	params.from_x = CLAMP((int)Math::floor((p_local_aabb.position.x - local_origin.x) / cell_size), 0, width - 2);
+	params.from_z = CLAMP((int)Math::floor((p_local_aabb.position.z - local_origin.z) / cell_size), 0, depth - 2);
+	params.to_x = CLAMP((int)Math::floor((p_local_aabb.position.x + p_local_aabb.size.x - local_origin.x) / cell_size), 0, width - 2);
+	params.to_z = CLAMP((int)Math::floor((p_local_aabb.position.z + p_local_aabb.size.z - local_origin.z) / cell_size), 0, depth - 2);
+
+	PoolVector<real_t>::Read r;
+	params.heights = NULL;
+	if (!compressed) {
+		r = heights.read();
+		params.heights = r.ptr();
+	}
+
+	FaceShapeSW face; // use this to send in the callback
+	params.face = &face;
+	params.callback = p_callback;
+	params.userdata = p_userdata;
+
+	_cull_chunk(bounds.size() - 1, 0, 0, &params);
 }
 
 Vector3 HeightMapShapeSW::get_moment_of_inertia(real_t p_mass) const {
@@ -1603,32 +1886,123 @@ Vector3 HeightMapShapeSW::get_moment_of_inertia(real_t p_mass) const {
 			(p_mass / 3.0) * (extents.y * extents.y + extents.y * extents.y));
 }
 
-void HeightMapShapeSW::_setup(PoolVector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size) {
+void HeightMapShapeSW::_build_bounds(const real_t *p_heights) {
+
+	bounds.clear();
+
+	// finest level, min/max of every chunk of cells
+
+	BoundsLevel level;
+	level.width = ((width - 1) + BOUNDS_CHUNK_SIZE - 1) / BOUNDS_CHUNK_SIZE;
+	level.depth = ((depth - 1) + BOUNDS_CHUNK_SIZE - 1) / BOUNDS_CHUNK_SIZE;
+	level.ranges.resize(level.width * level.depth);
+
+	for (int i = 0; i < level.depth; i++) {
+
+		for (int j = 0; j < level.width; j++) {
+
+			// chunks share their border vertices with the neighbours
+			int to_z = MIN((i + 1) * BOUNDS_CHUNK_SIZE, depth - 1);
+			int to_x = MIN((j + 1) * BOUNDS_CHUNK_SIZE, width - 1);
+
+			Range range;
+			range.min = range.max = _get_height(p_heights, j * BOUNDS_CHUNK_SIZE, i * BOUNDS_CHUNK_SIZE);
+
+			for (int z = i * BOUNDS_CHUNK_SIZE; z <= to_z; z++) {
+				for (int x = j * BOUNDS_CHUNK_SIZE; x <= to_x; x++) {
+					real_t h = _get_height(p_heights, x, z);
+					range.min = MIN(range.min, h);
+					range.max = MAX(range.max, h);
+				}
+			}
+
+			level.ranges.write[i * level.width + j] = range;
+		}
+	}
+
+	bounds.push_back(level);
+
+	// coarser levels merge 2x2 chunks of the previous one, until a single chunk is left
+
+	while (level.width > 1 || level.depth > 1) {
+
+		const BoundsLevel &prev = bounds[bounds.size() - 1];
+
+		BoundsLevel next;
+		next.width = (prev.width + 1) / 2;
+		next.depth = (prev.depth + 1) / 2;
+		next.ranges.resize(next.width * next.depth);
+
+		for (int i = 0; i < next.depth; i++) {
+
+			for (int j = 0; j < next.width; j++) {
+
+				Range range = prev.ranges[(i * 2) * prev.width + (j * 2)];
+
+				for (int k = 1; k < 4; k++) {
+
+					int z = i * 2 + (k >> 1);
+					int x = j * 2 + (k & 1);
+					if (x >= prev.width || z >= prev.depth)
+						continue;
+
+					const Range &child = prev.ranges[z * prev.width + x];
+					range.min = MIN(range.min, child.min);
+					range.max = MAX(range.max, child.max);
+				}
+
+				next.ranges.write[i * next.width + j] = range;
+			}
+		}
+
+		bounds.push_back(next);
+		level = next;
+	}
+}
+
+void HeightMapShapeSW::_setup(PoolVector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size, bool p_compressed) {
 
-	heights = p_heights;
 	width = p_width;
 	depth = p_depth;
 	cell_size = p_cell_size;
+	compressed = p_compressed;
+	local_origin = Vector3((width - 1) * cell_size * -0.5, 0, (depth - 1) * cell_size * -0.5);
 
-	PoolVector<real_t>::Read r = heights.read();
+	PoolVector<real_t>::Read r = p_heights.read();
 
-	AABB aabb;
+	real_t min_height = r[0];
+	real_t max_height = r[0];
 
-	for (int i = 0; i < depth; i++) {
+	for (int i = 1; i < width * depth; i++) {
 
-		for (int j = 0; j < width; j++) {
+		min_height = MIN(min_height, r[i]);
+		max_height = MAX(max_height, r[i]);
+	}
 
-			real_t h = r[i * width + j];
+	if (compressed) {
 
-			Vector3 pos(j * cell_size, h, i * cell_size);
-			if (i == 0 || j == 0)
-				aabb.position = pos;
-			else
-				aabb.expand_to(pos);
+		// quantize to 16 bits over the height range of the map
+		heights = PoolVector<real_t>();
+		compressed_min = min_height;
+		compressed_step = (max_height - min_height) / 65535.0;
+
+		compressed_heights.resize(width * depth);
+		for (int i = 0; i < width * depth; i++) {
+			compressed_heights.write[i] = compressed_step > 0 ? (uint16_t)Math::fast_ftoi((r[i] - min_height) / compressed_step) : 0;
 		}
+
+		_build_bounds(NULL);
+	} else {
+
+		heights = p_heights;
+		compressed_heights.clear();
+		compressed_min = 0;
+		compressed_step = 0;
+
+		_build_bounds(r.ptr());
 	}
 
-	configure(aabb);
+	configure(AABB(local_origin + Vector3(0, min_height, 0), Vector3((width - 1) * cell_size, max_height - min_height, (depth - 1) * cell_size)));
 }
 
 void HeightMapShapeSW::set_data(const Variant &p_data) {
@@ -1637,24 +2011,30 @@ void HeightMapShapeSW::set_data(const Variant &p_data) {
 	Dictionary d = p_data;
 	ERR_FAIL_COND(!d.has("width"));
 	ERR_FAIL_COND(!d.has("depth"));
-	ERR_FAIL_COND(!d.has("cell_size"));
 	ERR_FAIL_COND(!d.has("heights"));
 
 	int width = d["width"];
 	int depth = d["depth"];
-	real_t cell_size = d["cell_size"];
+	real_t cell_size = d.has("cell_size") ? (real_t)d["cell_size"] : 1.0;
+	bool compressed = d.has("compressed") ? (bool)d["compressed"] : false;
 	PoolVector<real_t> heights = d["heights"];
 
 	ERR_FAIL_COND(width <= 0);
 	ERR_FAIL_COND(depth <= 0);
 	ERR_FAIL_COND(cell_size <= CMP_EPSILON);
 	ERR_FAIL_COND(heights.size() != (width * depth));
-	_setup(heights, width, depth, cell_size);
+	_setup(heights, width, depth, cell_size, compressed);
 }
 
 Variant HeightMapShapeSW::get_data() const {
 
-	ERR_FAIL_V(Variant());
+	Dictionary d;
+	d["width"] = width;
+	d["depth"] = depth;
+	d["cell_size"] = cell_size;
+	d["compressed"] = compressed;
+	d["heights"] = get_heights();
+	return d;
 }
 
 HeightMapShapeSW::HeightMapShapeSW() {
@@ -1662,4 +2042,7 @@ HeightMapShapeSW::HeightMapShapeSW() {
 	width = 0;
 	depth = 0;
 	cell_size = 0;
+	compressed = false;
+	compressed_min = 0;
+	compressed_step = 0;
 }
@@ -62,6 +62,7 @@ class ShapeSW {
 	AABB aabb;
 	bool configured;
 	real_t custom_bias;
+	uint32_t version;
 
 	Map<ShapeOwnerSW *, int> owners;
 
@@ -82,6 +83,7 @@ public:
 
 	_FORCE_INLINE_ AABB get_aabb() const { return aabb; }
 	_FORCE_INLINE_ bool is_configured() const { return configured; }
+	_FORCE_INLINE_ uint32_t get_version() const { return version; } // bumped every time the shape is reconfigured
 
 	virtual bool is_concave() const { return false; }
 
@@ -261,12 +263,19 @@ public:
 
 struct ConvexPolygonShapeSW : public ShapeSW {
 
+	struct EdgeFaces {
+		int face_a;
+		int face_b; // -1 when the hull is degenerate around the edge
+	};
+
 	Geometry::MeshData mesh;
+	Vector<EdgeFaces> edge_faces; // faces on both sides of each mesh edge
 
 	void _setup(const Vector<Vector3> &p_vertices);
 
 public:
 	const Geometry::MeshData &get_mesh() const { return mesh; }
+	const Vector<EdgeFaces> &get_edge_faces() const { return edge_faces; }
 
 	virtual PhysicsServer::ShapeType get_type() const { return PhysicsServer::SHAPE_CONVEX_POLYGON; }
 
@@ -368,21 +377,69 @@ public:
 
 struct HeightMapShapeSW : public ConcaveShapeSW {
 
+	enum {
+		BOUNDS_CHUNK_SIZE = 8 // cells per side of a chunk in the finest level of the bounds pyramid
+	};
+
+	struct Range {
+
+		real_t min;
+		real_t max;
+	};
+
+	struct BoundsLevel {
+
+		int width;
+		int depth;
+		Vector<Range> ranges;
+	};
+
 	PoolVector<real_t> heights;
+	Vector<uint16_t> compressed_heights; // used instead of heights when compressed
+	real_t compressed_min;
+	real_t compressed_step;
+	bool compressed;
+
 	int width;
 	int depth;
 	real_t cell_size;
+	Vector3 local_origin; // position of the first vertex, the grid is centered on the shape origin in XZ
+
+	Vector<BoundsLevel> bounds; // min/max height pyramid, finest level first
+
+	struct _CullParams {
+
+		AABB aabb;
+		int from_x, from_z;
+		int to_x, to_z; // inclusive cell range
+		const real_t *heights;
+		Callback callback;
+		void *userdata;
+		FaceShapeSW *face;
+	};
+
+	_FORCE_INLINE_ real_t _get_height(const real_t *p_heights, int p_x, int p_z) const {
+		int idx = p_z * width + p_x;
+		return p_heights ? p_heights[idx] : compressed_min + compressed_heights[idx] * compressed_step;
+	}
+
+	_FORCE_INLINE_ Vector3 _get_point(const real_t *p_heights, int p_x, int p_z) const {
+		return local_origin + Vector3(p_x * cell_size, _get_height(p_heights, p_x, p_z), p_z * cell_size);
+	}
 
-	//void _cull_segment(int p_idx,_SegmentCullParams *p_params) const;
-	//void _cull(int p_idx,_CullParams *p_params) const;
+	void _get_cell_range(const real_t *p_heights, int p_x, int p_z, real_t &r_min, real_t &r_max) const;
+	void _build_bounds(const real_t *p_heights);
+	void _cull_chunk(int p_level, int p_x, int p_z, _CullParams *p_params) const;
+	bool _intersect_cell(const real_t *p_heights, int p_x, int p_z, const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const;
 
-	void _setup(PoolVector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size);
+	void _setup(PoolVector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size, bool p_compressed);
 
 public:
 	PoolVector<real_t> get_heights() const;
 	int get_width() const;
 	int get_depth() const;
 	real_t get_cell_size() const;
+	bool is_compressed() const;
 
 	virtual PhysicsServer::ShapeType get_type() const { return PhysicsServer::SHAPE_HEIGHTMAP; }
 
@@ -997,17 +997,18 @@ bool SpaceSW::test_body_motion(BodySW *p_body, const Transform &p_from, const Ve
 
 void *SpaceSW::_broadphase_pair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_self) {
 
+	SpaceSW *self = (SpaceSW *)p_self;
+
 	CollisionObjectSW::Type type_A = A->get_type();
 	CollisionObjectSW::Type type_B = B->get_type();
-	if (type_A > type_B) {
+	// when deterministic, order pairs of the same type by their RID, so they don't depend on the broadphase traversal order
+	if (type_A > type_B || (self->deterministic && type_A == type_B && B->get_self().get_id() < A->get_self().get_id())) {
 
 		SWAP(A, B);
 		SWAP(p_subindex_A, p_subindex_B);
 		SWAP(type_A, type_B);
 	}
 
-	SpaceSW *self = (SpaceSW *)p_self;
-
 	self->collision_pairs++;
 
 	if (type_A == CollisionObjectSW::TYPE_AREA) {
@@ -1208,9 +1209,11 @@ SpaceSW::SpaceSW() {
 	collision_pairs = 0;
 	active_objects = 0;
 	island_count = 0;
+	state_hash = 0;
 	contact_debug_count = 0;
 
 	locked = false;
+	deterministic = false;
 	contact_recycle_radius = 0.01;
 	contact_max_separation = 0.05;
 	contact_max_allowed_penetration = 0.01;
@@ -112,8 +112,10 @@ private:
 	real_t body_angular_velocity_damp_ratio;
 
 	bool locked;
+	bool deterministic;
 
 	int island_count;
+	uint32_t state_hash;
 	int active_objects;
 	int collision_pairs;
 
@@ -177,6 +179,12 @@ public:
 	void set_island_count(int p_island_count) { island_count = p_island_count; }
 	int get_island_count() const { return island_count; }
 
+	void set_deterministic(bool p_enable) { deterministic = p_enable; }
+	bool is_deterministic() const { return deterministic; }
+
+	void set_state_hash(uint32_t p_hash) { state_hash = p_hash; }
+	uint32_t get_state_hash() const { return state_hash; } // only computed by deterministic steps
+
 	void set_active_objects(int p_active_objects) { active_objects = p_active_objects; }
 	int get_active_objects() const { return active_objects; }
 
@@ -39,9 +39,34 @@ void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **
 	p_body->set_island_next(*p_island);
 	*p_island = p_body;
 
-	for (Map<ConstraintSW *, int>::Element *E = p_body->get_constraint_map().front(); E; E = E->next()) {
+	const Map<ConstraintSW *, int> &constraint_map = p_body->get_constraint_map();
+
+	// the map is ordered by pointer, which changes between runs
+	Vector<ConstraintSW *> sorted_constraints;
+	if (deterministic) {
+		sorted_constraints.resize(constraint_map.size());
+		int idx = 0;
+		for (const Map<ConstraintSW *, int>::Element *E = constraint_map.front(); E; E = E->next()) {
+			sorted_constraints.write[idx++] = E->key();
+		}
+		sorted_constraints.sort_custom<ConstraintStableSort>();
+	}
+
+	const Map<ConstraintSW *, int>::Element *E = deterministic ? NULL : constraint_map.front();
+
+	for (int j = 0; deterministic ? j < sorted_constraints.size() : E != NULL; j++) {
+
+		ConstraintSW *c;
+		int body_index;
+		if (deterministic) {
+			c = sorted_constraints[j];
+			body_index = constraint_map[c];
+		} else {
+			c = E->key();
+			body_index = E->get();
+			E = E->next();
+		}
 
-		ConstraintSW *c = (ConstraintSW *)E->key();
 		if (c->get_island_step() == _step)
 			continue; //already processed
 		c->set_island_step(_step);
@@ -49,7 +74,7 @@ void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **
 		*p_constraint_island = c;
 
 		for (int i = 0; i < c->get_body_count(); i++) {
-			if (i == E->get())
+			if (i == body_index)
 				continue;
 			BodySW *b = c->get_body_ptr()[i];
 			if (b->get_island_step() == _step || b->get_mode() == PhysicsServer::BODY_MODE_STATIC || b->get_mode() == PhysicsServer::BODY_MODE_KINEMATIC)
@@ -177,14 +202,30 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* GENERATE CONSTRAINT ISLANDS */
 
+	if (deterministic) {
+		// the active list order depends on when bodies were woken up, use RID order instead
+		sorted_bodies.resize(active_count);
+		int idx = 0;
+		for (b = body_list->first(); b; b = b->next()) {
+			sorted_bodies.write[idx++] = b->self();
+		}
+		sorted_bodies.sort_custom<BodyStableSort>();
+	}
+
 	BodySW *island_list = NULL;
 	ConstraintSW *constraint_island_list = NULL;
 	b = body_list->first();
 
 	int island_count = 0;
 
-	while (b) {
-		BodySW *body = b->self();
+	for (int i = 0; deterministic ? i < sorted_bodies.size() : b != NULL; i++) {
+		BodySW *body;
+		if (deterministic) {
+			body = sorted_bodies[i];
+		} else {
+			body = b->self();
+			b = b->next();
+		}
 
 		if (body->get_island_step() != _step) {
 
@@ -201,7 +242,6 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 				island_count++;
 			}
 		}
-		b = b->next();
 	}
 
 	p_space->set_island_count(island_count);
@@ -209,9 +249,30 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	const SelfList<AreaSW>::List &aml = p_space->get_moved_area_list();
 
 	while (aml.first()) {
-		for (const Set<ConstraintSW *>::Element *E = aml.first()->self()->get_constraints().front(); E; E = E->next()) {
+		const Set<ConstraintSW *> &constraints = aml.first()->self()->get_constraints();
+
+		Vector<ConstraintSW *> sorted_constraints;
+		if (deterministic) {
+			sorted_constraints.resize(constraints.size());
+			int idx = 0;
+			for (const Set<ConstraintSW *>::Element *E = constraints.front(); E; E = E->next()) {
+				sorted_constraints.write[idx++] = E->get();
+			}
+			sorted_constraints.sort_custom<ConstraintStableSort>();
+		}
+
+		const Set<ConstraintSW *>::Element *E = deterministic ? NULL : constraints.front();
+
+		for (int i = 0; deterministic ? i < sorted_constraints.size() : E != NULL; i++) {
+
+			ConstraintSW *c;
+			if (deterministic) {
+				c = sorted_constraints[i];
+			} else {
+				c = E->get();
+				E = E->next();
+			}
 
-			ConstraintSW *c = E->get();
 			if (c->get_island_step() == _step)
 				continue;
 			c->set_island_step(_step);
@@ -288,12 +349,37 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 		profile_begtime = profile_endtime;
 	}
 
+	if (deterministic) {
+		p_space->set_state_hash(_hash_bodies());
+	}
+
 	p_space->update();
 	p_space->unlock();
 	_step++;
 }
 
+uint32_t StepSW::_hash_bodies() const {
+
+	uint32_t hash = 5381;
+
+	for (int i = 0; i < sorted_bodies.size(); i++) {
+
+		const BodySW *body = sorted_bodies[i];
+		Transform xform = body->get_transform();
+		Vector3 linear_velocity = body->get_linear_velocity();
+		Vector3 angular_velocity = body->get_angular_velocity();
+
+		hash = (uint32_t)hash_djb2_one_64(body->get_self().get_id(), hash);
+		hash = hash_djb2_buffer((const uint8_t *)&xform, sizeof(Transform), hash);
+		hash = hash_djb2_buffer((const uint8_t *)&linear_velocity, sizeof(Vector3), hash);
+		hash = hash_djb2_buffer((const uint8_t *)&angular_velocity, sizeof(Vector3), hash);
+	}
+
+	return hash;
+}
+
 StepSW::StepSW() {
 
 	_step = 1;
+	deterministic = false;
 }
@@ -31,18 +31,38 @@
 #ifndef STEP_SW_H
 #define STEP_SW_H
 
+#include "constraint_sw.h"
 #include "space_sw.h"
 
 class StepSW {
 
 	uint64_t _step;
 
+	bool deterministic;
+	Vector<BodySW *> sorted_bodies;
+
+	struct BodyStableSort {
+
+		_FORCE_INLINE_ bool operator()(const BodySW *p_a, const BodySW *p_b) const { return p_a->get_self().get_id() < p_b->get_self().get_id(); }
+	};
+
+	struct ConstraintStableSort {
+
+		_FORCE_INLINE_ bool operator()(const ConstraintSW *p_a, const ConstraintSW *p_b) const { return p_a->is_stable_before(p_b); }
+	};
+
+	uint32_t _hash_bodies() const;
+
 	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island);
 	void _setup_island(ConstraintSW *p_island, real_t p_delta);
 	void _solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta);
 	void _check_suspend(BodySW *p_island, real_t p_delta);
 
 public:
+	// process bodies and constraints in RID order, so steps are reproducible across runs
+	void set_deterministic(bool p_enable) { deterministic = p_enable; }
+	bool is_deterministic() const { return deterministic; }
+
 	void step(SpaceSW *p_space, real_t p_delta, int p_iterations);
 	StepSW();
 };
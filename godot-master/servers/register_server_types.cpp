@@ -59,6 +59,7 @@
 #include "navigation_2d_server.h"
 #include "navigation_server.h"
 #include "physics/physics_server_sw.h"
+#include "physics/physics_server_wrap_mt.h"
 #include "physics_2d/physics_2d_server_sw.h"
 #include "physics_2d/physics_2d_server_wrap_mt.h"
 #include "physics_2d_server.h"
@@ -91,7 +92,7 @@ static void _debugger_get_resource_usage(List<ScriptDebuggerRemote::ResourceUsag
 ShaderTypes *shader_types = NULL;
 
 PhysicsServer *_createGodotPhysicsCallback() {
-	return memnew(PhysicsServerSW);
+	return PhysicsServerWrapMT::init_server<PhysicsServerSW>();
 }
 
 Physics2DServer *_createGodotPhysics2DCallback() {
@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "light_cluster_builder.h"
+#include "servers/visual/rasterizer_rd/rasterizer_rd.h"
 
 void LightClusterBuilder::begin(const Transform &p_view_transform, const CameraMatrix &p_cam_projection) {
 	view_xform = p_view_transform;
@@ -40,19 +41,18 @@ void LightClusterBuilder::begin(const Transform &p_view_transform, const CameraM
 	light_count = 0;
 	refprobe_count = 0;
 	item_count = 0;
-	sort_id_count = 0;
 }
 
-void LightClusterBuilder::bake_cluster() {
+void LightClusterBuilder::_bake_slice_cells(uint32_t p_slice, void *p_userdata) {
 
-	float slice_depth = (z_near - z_far) / depth;
+	uint32_t slice_cells = width * height;
+	uint32_t *bits = cell_bits + p_slice * slice_cells * cell_words;
+	zeromem(bits, sizeof(uint32_t) * slice_cells * cell_words);
 
-	PoolVector<uint8_t>::Write cluster_dataw = cluster_data.write();
-	Cell *cluster_data_ptr = (Cell *)cluster_dataw.ptr();
-	//clear the cluster
-	zeromem(cluster_data_ptr, (width * height * depth * sizeof(Cell)));
+	float slice_depth = (z_near - z_far) / depth;
+	int j = p_slice;
 
-	/* Step 1, create cell positions and count them */
+	/* Step 1, mark the cells of this slice touched by each item */
 
 	for (uint32_t i = 0; i < item_count; i++) {
 
@@ -61,122 +61,163 @@ void LightClusterBuilder::bake_cluster() {
 		int from_slice = Math::floor((z_near - (item.aabb.position.z + item.aabb.size.z)) / slice_depth);
 		int to_slice = Math::floor((z_near - item.aabb.position.z) / slice_depth);
 
-		if (from_slice >= (int)depth || to_slice < 0) {
-			continue; //sorry no go
+		if (j < from_slice || j > to_slice) {
+			continue; //not in this slice
 		}
 
-		from_slice = MAX(0, from_slice);
-		to_slice = MIN((int)depth - 1, to_slice);
+		Vector3 min = item.aabb.position;
+		Vector3 max = item.aabb.position + item.aabb.size;
 
-		for (int j = from_slice; j <= to_slice; j++) {
+		float limit_near = MIN((z_near - slice_depth * j), max.z);
+		float limit_far = MAX((z_near - slice_depth * (j + 1)), min.z);
 
-			Vector3 min = item.aabb.position;
-			Vector3 max = item.aabb.position + item.aabb.size;
+		max.z = limit_near;
+		min.z = limit_near;
 
-			float limit_near = MIN((z_near - slice_depth * j), max.z);
-			float limit_far = MAX((z_near - slice_depth * (j + 1)), min.z);
+		Vector3 proj_min = projection.xform(min);
+		Vector3 proj_max = projection.xform(max);
 
-			max.z = limit_near;
-			min.z = limit_near;
+		int near_from_x = int(Math::floor((proj_min.x * 0.5 + 0.5) * width));
+		int near_from_y = int(Math::floor((-proj_max.y * 0.5 + 0.5) * height));
+		int near_to_x = int(Math::floor((proj_max.x * 0.5 + 0.5) * width));
+		int near_to_y = int(Math::floor((-proj_min.y * 0.5 + 0.5) * height));
 
-			Vector3 proj_min = projection.xform(min);
-			Vector3 proj_max = projection.xform(max);
+		max.z = limit_far;
+		min.z = limit_far;
 
-			int near_from_x = int(Math::floor((proj_min.x * 0.5 + 0.5) * width));
-			int near_from_y = int(Math::floor((-proj_max.y * 0.5 + 0.5) * height));
-			int near_to_x = int(Math::floor((proj_max.x * 0.5 + 0.5) * width));
-			int near_to_y = int(Math::floor((-proj_min.y * 0.5 + 0.5) * height));
+		proj_min = projection.xform(min);
+		proj_max = projection.xform(max);
 
-			max.z = limit_far;
-			min.z = limit_far;
+		int far_from_x = int(Math::floor((proj_min.x * 0.5 + 0.5) * width));
+		int far_from_y = int(Math::floor((-proj_max.y * 0.5 + 0.5) * height));
+		int far_to_x = int(Math::floor((proj_max.x * 0.5 + 0.5) * width));
+		int far_to_y = int(Math::floor((-proj_min.y * 0.5 + 0.5) * height));
 
-			proj_min = projection.xform(min);
-			proj_max = projection.xform(max);
+		int from_x = MIN(near_from_x, far_from_x);
+		int from_y = MIN(near_from_y, far_from_y);
+		int to_x = MAX(near_to_x, far_to_x);
+		int to_y = MAX(near_to_y, far_to_y);
 
-			int far_from_x = int(Math::floor((proj_min.x * 0.5 + 0.5) * width));
-			int far_from_y = int(Math::floor((-proj_max.y * 0.5 + 0.5) * height));
-			int far_to_x = int(Math::floor((proj_max.x * 0.5 + 0.5) * width));
-			int far_to_y = int(Math::floor((-proj_min.y * 0.5 + 0.5) * height));
+		if (from_x >= (int)width || to_x < 0 || from_y >= (int)height || to_y < 0) {
+			continue;
+		}
 
-			//print_line(itos(j) + " near - " + Vector2i(near_from_x, near_from_y) + " -> " + Vector2i(near_to_x, near_to_y));
-			//print_line(itos(j) + " far - " + Vector2i(far_from_x, far_from_y) + " -> " + Vector2i(far_to_x, far_to_y));
+		int sx = MAX(0, from_x);
+		int sy = MAX(0, from_y);
+		int dx = MIN(width - 1, to_x);
+		int dy = MIN(height - 1, to_y);
 
-			int from_x = MIN(near_from_x, far_from_x);
-			int from_y = MIN(near_from_y, far_from_y);
-			int to_x = MAX(near_to_x, far_to_x);
-			int to_y = MAX(near_to_y, far_to_y);
+		uint32_t word = i >> 5;
+		uint32_t mask = 1u << (i & 31);
 
-			if (from_x >= (int)width || to_x < 0 || from_y >= (int)height || to_y < 0) {
-				continue;
+		for (int y = sy; y <= dy; y++) {
+			uint32_t *row = bits + (y * width) * cell_words + word;
+			for (int x = sx; x <= dx; x++) {
+				row[x * cell_words] |= mask;
 			}
+		}
+	}
 
-			int sx = MAX(0, from_x);
-			int sy = MAX(0, from_y);
-			int dx = MIN(width - 1, to_x);
-			int dy = MIN(height - 1, to_y);
+	/* Step 2, count items per type in each cell */
 
-			//print_line(itos(j) + " - " + Vector2i(sx, sy) + " -> " + Vector2i(dx, dy));
+	Cell *cells = bake_cells + p_slice * slice_cells;
+	uint32_t total = 0;
 
-			for (int x = sx; x <= dx; x++) {
-				for (int y = sy; y <= dy; y++) {
-					uint32_t offset = j * (width * height) + y * width + x;
+	for (uint32_t c = 0; c < slice_cells; c++) {
+		const uint32_t *cb = bits + c * cell_words;
+		for (uint32_t w = 0; w < cell_words; w++) {
+			uint32_t word = cb[w];
+			uint32_t index = w << 5;
+			while (word) {
+				if (word & 1) {
+					cells[c].item_pointers[items[index].type]++;
+					total++;
+				}
+				word >>= 1;
+				index++;
+			}
+		}
+	}
 
-					if (unlikely(sort_id_count == sort_id_max)) {
-						sort_id_max = nearest_power_of_2_templated(sort_id_max + 1);
-						sort_ids = (SortID *)memrealloc(sort_ids, sizeof(SortID) * sort_id_max);
-						if (ids.size()) {
+	slice_ids[p_slice] = total;
+}
+
+void LightClusterBuilder::_bake_slice_ids(uint32_t p_slice, uint32_t *p_ids) {
 
-							ids.resize(sort_id_max);
-							RD::get_singleton()->free(items_buffer);
-							items_buffer = RD::get_singleton()->storage_buffer_create(sizeof(uint32_t) * sort_id_max);
-						}
-					}
+	uint32_t slice_cells = width * height;
+	const uint32_t *bits = cell_bits + p_slice * slice_cells * cell_words;
+	Cell *cells = bake_cells + p_slice * slice_cells;
+	uint32_t offset = slice_ids[p_slice];
 
-					sort_ids[sort_id_count].cell_index = offset;
-					sort_ids[sort_id_count].item_index = item.index;
-					sort_ids[sort_id_count].item_type = item.type;
+	/* Step 3, assign pointers and place item lists, in item order within each type */
 
-					sort_id_count++;
+	for (uint32_t c = 0; c < slice_cells; c++) {
+
+		uint32_t cursor[ITEM_TYPE_MAX];
+		for (int j = 0; j < ITEM_TYPE_MAX; j++) {
+			uint32_t count = cells[c].item_pointers[j];
+			cursor[j] = offset;
+			cells[c].item_pointers[j] = offset | (count << COUNTER_SHIFT);
+			offset += count;
+		}
 
-					//for now, only count
-					cluster_data_ptr[offset].item_pointers[item.type]++;
-					//print_line("at offset " + itos(offset) + " value: " + itos(cluster_data_ptr[offset].item_pointers[item.type]));
+		const uint32_t *cb = bits + c * cell_words;
+		for (uint32_t w = 0; w < cell_words; w++) {
+			uint32_t word = cb[w];
+			uint32_t index = w << 5;
+			while (word) {
+				if (word & 1) {
+					const Item &item = items[index];
+					p_ids[cursor[item.type]++] = item.index;
 				}
+				word >>= 1;
+				index++;
 			}
 		}
 	}
+}
 
-	/* Step 2, Assign pointers (and reset counters) */
+void LightClusterBuilder::bake_cluster() {
 
-	uint32_t offset = 0;
-	for (uint32_t i = 0; i < (width * height * depth); i++) {
-		for (int j = 0; j < ITEM_TYPE_MAX; j++) {
-			uint32_t count = cluster_data_ptr[i].item_pointers[j]; //save count
-			cluster_data_ptr[i].item_pointers[j] = offset; //replace count by pointer
-			offset += count; //increase offset by count;
-		}
+	PoolVector<uint8_t>::Write cluster_dataw = cluster_data.write();
+	bake_cells = (Cell *)cluster_dataw.ptr();
+	//clear the cluster
+	zeromem(bake_cells, (width * height * depth * sizeof(Cell)));
+
+	cell_words = (item_count + 31) >> 5;
+	uint32_t bits_needed = width * height * depth * cell_words;
+	if (bits_needed > cell_bits_max) {
+		cell_bits_max = nearest_power_of_2_templated(bits_needed);
+		cell_bits = (uint32_t *)memrealloc(cell_bits, sizeof(uint32_t) * cell_bits_max);
+	}
+
+	RasterizerRD::thread_work_pool.do_work(depth, this, &LightClusterBuilder::_bake_slice_cells, (void *)nullptr);
+
+	//turn per slice counts into offsets
+	uint32_t total = 0;
+	for (uint32_t i = 0; i < depth; i++) {
+		uint32_t count = slice_ids[i];
+		slice_ids[i] = total;
+		total += count;
 	}
 
-	//print_line("offset: " + itos(offset));
-	/* Step 3, Place item lists */
+	if (total > ids_max) {
+		ids_max = nearest_power_of_2_templated(total);
+		ids.resize(ids_max);
+		RD::get_singleton()->free(items_buffer);
+		items_buffer = RD::get_singleton()->storage_buffer_create(sizeof(uint32_t) * ids_max);
+	}
 
 	PoolVector<uint32_t>::Write idsw = ids.write();
 	uint32_t *ids_ptr = idsw.ptr();
 
-	for (uint32_t i = 0; i < sort_id_count; i++) {
-		const SortID &id = sort_ids[i];
-		Cell &cell = cluster_data_ptr[id.cell_index];
-		uint32_t pointer = cell.item_pointers[id.item_type] & POINTER_MASK;
-		uint32_t counter = cell.item_pointers[id.item_type] >> COUNTER_SHIFT;
-		ids_ptr[pointer + counter] = id.item_index;
-
-		cell.item_pointers[id.item_type] = pointer | ((counter + 1) << COUNTER_SHIFT);
-	}
+	RasterizerRD::thread_work_pool.do_work(depth, this, &LightClusterBuilder::_bake_slice_ids, ids_ptr);
 
+	bake_cells = nullptr;
 	cluster_dataw = PoolVector<uint8_t>::Write();
 
 	RD::get_singleton()->texture_update(cluster_texture, 0, cluster_data, true);
-	RD::get_singleton()->buffer_update(items_buffer, 0, offset * sizeof(uint32_t), ids_ptr, true);
+	RD::get_singleton()->buffer_update(items_buffer, 0, total * sizeof(uint32_t), ids_ptr, true);
 
 	idsw = PoolVector<uint32_t>::Write();
 }
@@ -195,6 +236,7 @@ void LightClusterBuilder::setup(uint32_t p_width, uint32_t p_height, uint32_t p_
 	depth = p_depth;
 
 	cluster_data.resize(width * height * depth * sizeof(Cell));
+	slice_ids = (uint32_t *)memrealloc(slice_ids, sizeof(uint32_t) * depth);
 
 	{
 		RD::TextureFormat tf;
@@ -230,10 +272,9 @@ LightClusterBuilder::LightClusterBuilder() {
 	items = (Item *)memalloc(sizeof(Item) * 1024);
 	item_max = 1024;
 
-	sort_ids = (SortID *)memalloc(sizeof(SortID) * 1024);
-	ids.resize(2014);
-	items_buffer = RD::get_singleton()->storage_buffer_create(sizeof(uint32_t) * 1024);
-	item_max = 1024;
+	ids.resize(1024);
+	ids_max = 1024;
+	items_buffer = RD::get_singleton()->storage_buffer_create(sizeof(uint32_t) * ids_max);
 }
 LightClusterBuilder::~LightClusterBuilder() {
 
@@ -253,8 +294,11 @@ LightClusterBuilder::~LightClusterBuilder() {
 	if (items) {
 		memfree(items);
 	}
-	if (sort_ids) {
-		memfree(sort_ids);
-		RD::get_singleton()->free(items_buffer);
+	if (cell_bits) {
+		memfree(cell_bits);
+	}
+	if (slice_ids) {
+		memfree(slice_ids);
 	}
+	RD::get_singleton()->free(items_buffer);
 }
@@ -107,18 +107,22 @@ private:
 	PoolVector<uint8_t> cluster_data;
 	RID cluster_texture;
 
-	struct SortID {
-		uint32_t cell_index;
-		uint32_t item_index;
-		ItemType item_type;
-	};
+	//while baking, every cell holds a bitmask with one bit per item touching it,
+	//depth slices are independent so each one is baked on its own thread
+	uint32_t *cell_bits = nullptr;
+	uint32_t cell_bits_max = 0;
+	uint32_t cell_words = 0;
+
+	uint32_t *slice_ids = nullptr; //per slice id count, then offset into ids
+	Cell *bake_cells = nullptr;
 
-	SortID *sort_ids = nullptr;
 	PoolVector<uint32_t> ids;
-	uint32_t sort_id_count = 0;
-	uint32_t sort_id_max = 0;
+	uint32_t ids_max = 0;
 	RID items_buffer;
 
+	void _bake_slice_cells(uint32_t p_slice, void *p_userdata);
+	void _bake_slice_ids(uint32_t p_slice, uint32_t *p_ids);
+
 	Transform view_xform;
 	CameraMatrix projection;
 	float z_far = 0;
@@ -78,6 +78,8 @@ void RasterizerRD::blit_render_targets_to_screen(int p_screen, const BlitToScree
 void RasterizerRD::begin_frame(double frame_step) {
 	frame++;
 	time += frame_step;
+	storage->info.render_final = storage->info.render;
+	storage->info.render.reset();
 	canvas->set_time(time);
 	scene->set_time(time, frame_step);
 }
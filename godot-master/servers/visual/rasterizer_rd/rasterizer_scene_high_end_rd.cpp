@@ -762,6 +762,8 @@ void RasterizerSceneHighEndRD::_render_list(RenderingDevice::DrawListID p_draw_l
 	RID prev_index_array_rd;
 	RID prev_pipeline_rd;
 	RID prev_xforms_uniform_set;
+	const RenderList::Element *prev_reusable_e = nullptr;
+	ShaderData::CullVariant prev_cull_variant = ShaderData::CULL_VARIANT_NORMAL;
 
 	PushConstant push_constant;
 	zeromem(&push_constant, sizeof(PushConstant));
@@ -787,143 +789,167 @@ void RasterizerSceneHighEndRD::_render_list(RenderingDevice::DrawListID p_draw_l
 			cull_variant = mirror ? ShaderData::CULL_VARIANT_REVERSED : ShaderData::CULL_VARIANT_NORMAL;
 		}
 
-		//find primitive and vertex format
-		VS::PrimitiveType primitive;
+		// Sorting by key puts consecutive draws of the same plain mesh surface and material
+		// next to each other, those only need a new push constant.
+		bool reuse_state = prev_reusable_e && e->instance->base_type == VS::INSTANCE_MESH && !e->instance->skeleton.is_valid() && prev_reusable_e->instance->base == e->instance->base && prev_reusable_e->surface_index == e->surface_index && prev_reusable_e->material == material && prev_reusable_e->uses_lightmap == e->uses_lightmap && prev_reusable_e->uses_vct == e->uses_vct && prev_cull_variant == cull_variant;
 
-		switch (e->instance->base_type) {
-			case VS::INSTANCE_MESH: {
-				primitive = storage->mesh_surface_get_primitive(e->instance->base, e->surface_index);
-				if (e->instance->skeleton.is_valid()) {
-					xforms_uniform_set = storage->skeleton_get_3d_uniform_set(e->instance->skeleton, default_shader_rd, TRANSFORMS_UNIFORM_SET);
-				}
-			} break;
-			case VS::INSTANCE_MULTIMESH: {
-				RID mesh = storage->multimesh_get_mesh(e->instance->base);
-				ERR_CONTINUE(!mesh.is_valid()); //should be a bug
-				primitive = storage->mesh_surface_get_primitive(mesh, e->surface_index);
-
-				xforms_uniform_set = storage->multimesh_get_3d_uniform_set(e->instance->base, default_shader_rd, TRANSFORMS_UNIFORM_SET);
-
-			} break;
-			case VS::INSTANCE_IMMEDIATE: {
-				ERR_CONTINUE(true); //should be a bug
-			} break;
-			case VS::INSTANCE_PARTICLES: {
-				ERR_CONTINUE(true); //should be a bug
-			} break;
-			default: {
-				ERR_CONTINUE(true); //should be a bug
-			}
-		}
+		RID index_array_rd = prev_index_array_rd;
 
-		ShaderVersion shader_version;
+		if (reuse_state) {
+			storage->info.render.state_change_skip_count++;
+		} else {
+			index_array_rd = RID();
 
-		switch (p_pass_mode) {
-			case PASS_MODE_COLOR:
-			case PASS_MODE_COLOR_TRANSPARENT: {
+			//find primitive and vertex format
+			VS::PrimitiveType primitive;
 
-				if (e->uses_lightmap) {
-					shader_version = SHADER_VERSION_LIGHTMAP_COLOR_PASS;
-				} else if (e->uses_vct) {
-					shader_version = SHADER_VERSION_VCT_COLOR_PASS;
-				} else {
-					shader_version = SHADER_VERSION_COLOR_PASS;
+			switch (e->instance->base_type) {
+				case VS::INSTANCE_MESH: {
+					primitive = storage->mesh_surface_get_primitive(e->instance->base, e->surface_index);
+					if (e->instance->skeleton.is_valid()) {
+						xforms_uniform_set = storage->skeleton_get_3d_uniform_set(e->instance->skeleton, default_shader_rd, TRANSFORMS_UNIFORM_SET);
+					}
+				} break;
+				case VS::INSTANCE_MULTIMESH: {
+					RID mesh = storage->multimesh_get_mesh(e->instance->base);
+					ERR_CONTINUE(!mesh.is_valid()); //should be a bug
+					primitive = storage->mesh_surface_get_primitive(mesh, e->surface_index);
+
+					xforms_uniform_set = storage->multimesh_get_3d_uniform_set(e->instance->base, default_shader_rd, TRANSFORMS_UNIFORM_SET);
+
+				} break;
+				case VS::INSTANCE_IMMEDIATE: {
+					ERR_CONTINUE(true); //should be a bug
+				} break;
+				case VS::INSTANCE_PARTICLES: {
+					ERR_CONTINUE(true); //should be a bug
+				} break;
+				default: {
+					ERR_CONTINUE(true); //should be a bug
 				}
+			}
 
-			} break;
-			case PASS_MODE_COLOR_SPECULAR: {
-				if (e->uses_lightmap) {
-					shader_version = SHADER_VERSION_LIGHTMAP_COLOR_PASS_WITH_SEPARATE_SPECULAR;
-				} else if (e->uses_vct) {
-					shader_version = SHADER_VERSION_VCT_COLOR_PASS_WITH_SEPARATE_SPECULAR;
-				} else {
-					shader_version = SHADER_VERSION_COLOR_PASS_WITH_SEPARATE_SPECULAR;
-				}
-			} break;
-			case PASS_MODE_SHADOW:
-			case PASS_MODE_DEPTH: {
-				shader_version = SHADER_VERSION_DEPTH_PASS;
-			} break;
-			case PASS_MODE_SHADOW_DP: {
-				shader_version = SHADER_VERSION_DEPTH_PASS_DP;
-			} break;
-			case PASS_MODE_DEPTH_NORMAL: {
-				shader_version = SHADER_VERSION_DEPTH_PASS_WITH_NORMAL;
-			} break;
-			case PASS_MODE_DEPTH_NORMAL_ROUGHNESS: {
-				shader_version = SHADER_VERSION_DEPTH_PASS_WITH_NORMAL_AND_ROUGHNESS;
-			} break;
-			case PASS_MODE_DEPTH_MATERIAL: {
-				shader_version = SHADER_VERSION_DEPTH_PASS_WITH_MATERIAL;
-			} break;
-		}
+			ShaderVersion shader_version;
 
-		RenderPipelineVertexFormatCacheRD *pipeline = nullptr;
+			switch (p_pass_mode) {
+				case PASS_MODE_COLOR:
+				case PASS_MODE_COLOR_TRANSPARENT: {
 
-		pipeline = &shader->pipelines[cull_variant][primitive][shader_version];
+					if (e->uses_lightmap) {
+						shader_version = SHADER_VERSION_LIGHTMAP_COLOR_PASS;
+					} else if (e->uses_vct) {
+						shader_version = SHADER_VERSION_VCT_COLOR_PASS;
+					} else {
+						shader_version = SHADER_VERSION_COLOR_PASS;
+					}
 
-		RD::VertexFormatID vertex_format;
-		RID vertex_array_rd;
-		RID index_array_rd;
+				} break;
+				case PASS_MODE_COLOR_SPECULAR: {
+					if (e->uses_lightmap) {
+						shader_version = SHADER_VERSION_LIGHTMAP_COLOR_PASS_WITH_SEPARATE_SPECULAR;
+					} else if (e->uses_vct) {
+						shader_version = SHADER_VERSION_VCT_COLOR_PASS_WITH_SEPARATE_SPECULAR;
+					} else {
+						shader_version = SHADER_VERSION_COLOR_PASS_WITH_SEPARATE_SPECULAR;
+					}
+				} break;
+				case PASS_MODE_SHADOW:
+				case PASS_MODE_DEPTH: {
+					shader_version = SHADER_VERSION_DEPTH_PASS;
+				} break;
+				case PASS_MODE_SHADOW_DP: {
+					shader_version = SHADER_VERSION_DEPTH_PASS_DP;
+				} break;
+				case PASS_MODE_DEPTH_NORMAL: {
+					shader_version = SHADER_VERSION_DEPTH_PASS_WITH_NORMAL;
+				} break;
+				case PASS_MODE_DEPTH_NORMAL_ROUGHNESS: {
+					shader_version = SHADER_VERSION_DEPTH_PASS_WITH_NORMAL_AND_ROUGHNESS;
+				} break;
+				case PASS_MODE_DEPTH_MATERIAL: {
+					shader_version = SHADER_VERSION_DEPTH_PASS_WITH_MATERIAL;
+				} break;
+			}
 
-		switch (e->instance->base_type) {
-			case VS::INSTANCE_MESH: {
-				storage->mesh_surface_get_arrays_and_format(e->instance->base, e->surface_index, pipeline->get_vertex_input_mask(), vertex_array_rd, index_array_rd, vertex_format);
-			} break;
-			case VS::INSTANCE_MULTIMESH: {
-				RID mesh = storage->multimesh_get_mesh(e->instance->base);
-				ERR_CONTINUE(!mesh.is_valid()); //should be a bug
-				storage->mesh_surface_get_arrays_and_format(mesh, e->surface_index, pipeline->get_vertex_input_mask(), vertex_array_rd, index_array_rd, vertex_format);
-			} break;
-			case VS::INSTANCE_IMMEDIATE: {
-				ERR_CONTINUE(true); //should be a bug
-			} break;
-			case VS::INSTANCE_PARTICLES: {
-				ERR_CONTINUE(true); //should be a bug
-			} break;
-			default: {
-				ERR_CONTINUE(true); //should be a bug
+			RenderPipelineVertexFormatCacheRD *pipeline = nullptr;
+
+			pipeline = &shader->pipelines[cull_variant][primitive][shader_version];
+
+			RD::VertexFormatID vertex_format;
+			RID vertex_array_rd;
+
+			switch (e->instance->base_type) {
+				case VS::INSTANCE_MESH: {
+					storage->mesh_surface_get_arrays_and_format(e->instance->base, e->surface_index, pipeline->get_vertex_input_mask(), vertex_array_rd, index_array_rd, vertex_format);
+				} break;
+				case VS::INSTANCE_MULTIMESH: {
+					RID mesh = storage->multimesh_get_mesh(e->instance->base);
+					ERR_CONTINUE(!mesh.is_valid()); //should be a bug
+					storage->mesh_surface_get_arrays_and_format(mesh, e->surface_index, pipeline->get_vertex_input_mask(), vertex_array_rd, index_array_rd, vertex_format);
+				} break;
+				case VS::INSTANCE_IMMEDIATE: {
+					ERR_CONTINUE(true); //should be a bug
+				} break;
+				case VS::INSTANCE_PARTICLES: {
+					ERR_CONTINUE(true); //should be a bug
+				} break;
+				default: {
+					ERR_CONTINUE(true); //should be a bug
+				}
 			}
-		}
 
-		if (prev_vertex_array_rd != vertex_array_rd) {
-			RD::get_singleton()->draw_list_bind_vertex_array(draw_list, vertex_array_rd);
-			prev_vertex_array_rd = vertex_array_rd;
-		}
+			if (prev_vertex_array_rd != vertex_array_rd) {
+				RD::get_singleton()->draw_list_bind_vertex_array(draw_list, vertex_array_rd);
+				prev_vertex_array_rd = vertex_array_rd;
+				storage->info.render.surface_switch_count++;
+			}
 
-		if (prev_index_array_rd != index_array_rd) {
-			if (index_array_rd.is_valid()) {
-				RD::get_singleton()->draw_list_bind_index_array(draw_list, index_array_rd);
+			if (prev_index_array_rd != index_array_rd) {
+				if (index_array_rd.is_valid()) {
+					RD::get_singleton()->draw_list_bind_index_array(draw_list, index_array_rd);
+				}
+				prev_index_array_rd = index_array_rd;
 			}
-			prev_index_array_rd = index_array_rd;
-		}
 
-		RID pipeline_rd = pipeline->get_render_pipeline(vertex_format, framebuffer_format);
+			RID pipeline_rd = pipeline->get_render_pipeline(vertex_format, framebuffer_format);
 
-		if (pipeline_rd != prev_pipeline_rd) {
-			// checking with prev shader does not make so much sense, as
-			// the pipeline may still be different.
-			RD::get_singleton()->draw_list_bind_render_pipeline(draw_list, pipeline_rd);
-			prev_pipeline_rd = pipeline_rd;
-		}
+			if (pipeline_rd != prev_pipeline_rd) {
+				// checking with prev shader does not make so much sense, as
+				// the pipeline may still be different.
+				RD::get_singleton()->draw_list_bind_render_pipeline(draw_list, pipeline_rd);
+				prev_pipeline_rd = pipeline_rd;
+				storage->info.render.shader_rebind_count++;
+			}
 
-		if (xforms_uniform_set.is_valid() && prev_xforms_uniform_set != xforms_uniform_set) {
-			RD::get_singleton()->draw_list_bind_uniform_set(draw_list, xforms_uniform_set, TRANSFORMS_UNIFORM_SET);
-			prev_xforms_uniform_set = xforms_uniform_set;
-		}
+			if (xforms_uniform_set.is_valid() && prev_xforms_uniform_set != xforms_uniform_set) {
+				RD::get_singleton()->draw_list_bind_uniform_set(draw_list, xforms_uniform_set, TRANSFORMS_UNIFORM_SET);
+				prev_xforms_uniform_set = xforms_uniform_set;
+			}
+
+			if (material != prev_material) {
+				//update uniform set
+				if (material->uniform_set.is_valid()) {
+					RD::get_singleton()->draw_list_bind_uniform_set(draw_list, material->uniform_set, MATERIAL_UNIFORM_SET);
+					storage->info.render.material_switch_count++;
+				}
 
-		if (material != prev_material) {
-			//update uniform set
-			if (material->uniform_set.is_valid()) {
-				RD::get_singleton()->draw_list_bind_uniform_set(draw_list, material->uniform_set, MATERIAL_UNIFORM_SET);
+				prev_material = material;
 			}
+		}
 
-			prev_material = material;
+		if (e->instance->base_type == VS::INSTANCE_MESH && !e->instance->skeleton.is_valid()) {
+			prev_reusable_e = e;
+			prev_cull_variant = cull_variant;
+		} else {
+			prev_reusable_e = nullptr;
 		}
 
 		push_constant.index = i;
 		RD::get_singleton()->draw_list_set_push_constant(draw_list, &push_constant, sizeof(PushConstant));
 
+		storage->info.render.object_count++;
+		storage->info.render.draw_call_count++;
+
 		switch (e->instance->base_type) {
 			case VS::INSTANCE_MESH: {
 				RD::get_singleton()->draw_list_draw(draw_list, index_array_rd.is_valid());
@@ -1787,8 +1813,10 @@ void RasterizerSceneHighEndRD::_render_scene(RID p_render_buffer, const Transfor
 	_setup_gi_probes(p_gi_probe_cull_result, p_gi_probe_cull_count, p_cam_transform);
 	_setup_environment(p_environment, p_cam_projection, p_cam_transform, p_reflection_probe, p_reflection_probe.is_valid(), screen_pixel_size, p_shadow_atlas, !p_reflection_probe.is_valid(), p_default_bg_color, p_cam_projection.get_z_near(), p_cam_projection.get_z_far(), false);
 
+	RENDER_TIMESTAMP("Bake Light Cluster");
 	cluster_builder.bake_cluster(); //bake to cluster
 
+	RENDER_TIMESTAMP("Fill Render List");
 	_update_render_base_uniform_set(); //may have changed due to the above (light buffer enlarged, as an example)
 
 	render_list.clear();
@@ -427,7 +427,67 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 			alpha_element_count = 0;
 		}
 
-		//should eventually be replaced by radix
+		// Lists smaller than this use SortArray, radix setup cost is not worth it.
+		enum {
+			RADIX_SORT_THRESHOLD = 128
+		};
+
+		struct SortItem {
+			uint64_t key;
+			Element *element;
+		};
+
+		SortItem *sort_items;
+		SortItem *sort_items_tmp;
+
+		static _FORCE_INLINE_ uint32_t _depth_to_key(float p_depth) {
+			// Maps IEEE floats to unsigned ints with the same ordering.
+			union {
+				float f;
+				uint32_t u;
+			} depth;
+			depth.f = p_depth;
+			return depth.u ^ ((depth.u & 0x80000000) ? 0xFFFFFFFF : 0x80000000);
+		}
+
+		// Stable LSD radix sort over sort_items, one byte per pass. Passes where every key
+		// has the same digit are skipped, so keys using only a few bits stay cheap.
+		void _radix_sort(Element **p_elements, int p_count, int p_key_bytes) {
+
+			SortItem *src = sort_items;
+			SortItem *dst = sort_items_tmp;
+			uint32_t histogram[256];
+
+			for (int pass = 0; pass < p_key_bytes; pass++) {
+
+				uint32_t shift = pass * 8;
+				zeromem(histogram, sizeof(histogram));
+				for (int i = 0; i < p_count; i++) {
+					histogram[(src[i].key >> shift) & 0xFF]++;
+				}
+
+				if (histogram[(src[0].key >> shift) & 0xFF] == uint32_t(p_count)) {
+					continue;
+				}
+
+				uint32_t offset = 0;
+				for (int i = 0; i < 256; i++) {
+					uint32_t count = histogram[i];
+					histogram[i] = offset;
+					offset += count;
+				}
+
+				for (int i = 0; i < p_count; i++) {
+					dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+				}
+
+				SWAP(src, dst);
+			}
+
+			for (int i = 0; i < p_count; i++) {
+				p_elements[i] = src[i].element;
+			}
+		}
 
 		struct SortByKey {
 
@@ -438,12 +498,20 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 
 		void sort_by_key(bool p_alpha) {
 
-			SortArray<Element *, SortByKey> sorter;
-			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
-			} else {
-				sorter.sort(elements, element_count);
+			Element **list = p_alpha ? &elements[max_elements - alpha_element_count] : elements;
+			int count = p_alpha ? alpha_element_count : element_count;
+
+			if (count < RADIX_SORT_THRESHOLD) {
+				SortArray<Element *, SortByKey> sorter;
+				sorter.sort(list, count);
+				return;
 			}
+
+			for (int i = 0; i < count; i++) {
+				sort_items[i].key = list[i]->sort_key;
+				sort_items[i].element = list[i];
+			}
+			_radix_sort(list, count, 8);
 		}
 
 		struct SortByDepth {
@@ -455,12 +523,20 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 
 		void sort_by_depth(bool p_alpha) { //used for shadows
 
-			SortArray<Element *, SortByDepth> sorter;
-			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
-			} else {
-				sorter.sort(elements, element_count);
+			Element **list = p_alpha ? &elements[max_elements - alpha_element_count] : elements;
+			int count = p_alpha ? alpha_element_count : element_count;
+
+			if (count < RADIX_SORT_THRESHOLD) {
+				SortArray<Element *, SortByDepth> sorter;
+				sorter.sort(list, count);
+				return;
+			}
+
+			for (int i = 0; i < count; i++) {
+				sort_items[i].key = _depth_to_key(list[i]->instance->depth);
+				sort_items[i].element = list[i];
 			}
+			_radix_sort(list, count, 4);
 		}
 
 		struct SortByReverseDepthAndPriority {
@@ -478,12 +554,21 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 
 		void sort_by_reverse_depth_and_priority(bool p_alpha) { //used for alpha
 
-			SortArray<Element *, SortByReverseDepthAndPriority> sorter;
-			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
-			} else {
-				sorter.sort(elements, element_count);
+			Element **list = p_alpha ? &elements[max_elements - alpha_element_count] : elements;
+			int count = p_alpha ? alpha_element_count : element_count;
+
+			if (count < RADIX_SORT_THRESHOLD) {
+				SortArray<Element *, SortByReverseDepthAndPriority> sorter;
+				sorter.sort(list, count);
+				return;
+			}
+
+			for (int i = 0; i < count; i++) {
+				//priority ascending, then depth descending
+				sort_items[i].key = (uint64_t(list[i]->priority) << 32) | uint64_t(~_depth_to_key(list[i]->instance->depth));
+				sort_items[i].element = list[i];
 			}
+			_radix_sort(list, count, 5);
 		}
 
 		_FORCE_INLINE_ Element *add_element() {
@@ -510,6 +595,8 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 			alpha_element_count = 0;
 			elements = memnew_arr(Element *, max_elements);
 			base_elements = memnew_arr(Element, max_elements);
+			sort_items = memnew_arr(SortItem, max_elements);
+			sort_items_tmp = memnew_arr(SortItem, max_elements);
 			for (int i = 0; i < max_elements; i++)
 				elements[i] = &base_elements[i]; // assign elements
 		}
@@ -522,6 +609,8 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 		~RenderList() {
 			memdelete_arr(elements);
 			memdelete_arr(base_elements);
+			memdelete_arr(sort_items);
+			memdelete_arr(sort_items_tmp);
 		}
 	};
 
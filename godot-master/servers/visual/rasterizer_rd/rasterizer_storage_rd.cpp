@@ -4314,6 +4314,31 @@ bool RasterizerStorageRD::has_os_feature(const String &p_feature) const {
 
 	return false;
 }
+
+int RasterizerStorageRD::get_render_info(VS::RenderInfo p_info) {
+
+	switch (p_info) {
+		case VS::INFO_OBJECTS_IN_FRAME:
+			return info.render_final.object_count;
+		case VS::INFO_MATERIAL_CHANGES_IN_FRAME:
+			return info.render_final.material_switch_count;
+		case VS::INFO_SHADER_CHANGES_IN_FRAME:
+			return info.render_final.shader_rebind_count;
+		case VS::INFO_SURFACE_CHANGES_IN_FRAME:
+			return info.render_final.surface_switch_count;
+		case VS::INFO_DRAW_CALLS_IN_FRAME:
+			return info.render_final.draw_call_count;
+		case VS::INFO_STATE_CHANGES_SKIPPED_IN_FRAME:
+			return info.render_final.state_change_skip_count;
+		case VS::INFO_UPLOAD_BYTES_IN_FRAME:
+			return MIN(RD::get_singleton()->get_staging_buffer_upload_bytes(), (uint64_t)0x7FFFFFFF); //clamp, render info is an int
+		case VS::INFO_UPLOAD_STALLS_IN_FRAME:
+			return RD::get_singleton()->get_staging_buffer_stall_count();
+		default:
+			return 0; //not tracked yet
+	}
+}
+
 bool RasterizerStorageRD::free(RID p_rid) {
 
 	if (texture_owner.owns(p_rid)) {
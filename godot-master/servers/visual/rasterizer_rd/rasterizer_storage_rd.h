@@ -1107,11 +1107,38 @@ public:
 
 	void set_debug_generate_wireframes(bool p_generate) {}
 
+	struct Info {
+
+		struct Render {
+			uint32_t object_count;
+			uint32_t draw_call_count;
+			uint32_t material_switch_count;
+			uint32_t surface_switch_count;
+			uint32_t shader_rebind_count;
+			uint32_t state_change_skip_count;
+
+			void reset() {
+				object_count = 0;
+				draw_call_count = 0;
+				material_switch_count = 0;
+				surface_switch_count = 0;
+				shader_rebind_count = 0;
+				state_change_skip_count = 0;
+			}
+		} render, render_final;
+
+		Info() {
+			render.reset();
+			render_final.reset();
+		}
+
+	} info;
+
 	void render_info_begin_capture() {}
 	void render_info_end_capture() {}
 	int get_captured_render_info(VS::RenderInfo p_info) { return 0; }
 
-	int get_render_info(VS::RenderInfo p_info) { return 0; }
+	int get_render_info(VS::RenderInfo p_info);
 	String get_video_adapter_name() const { return String(); }
 	String get_video_adapter_vendor() const { return String(); }
 
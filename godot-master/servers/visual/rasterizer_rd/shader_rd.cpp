@@ -29,10 +29,17 @@
 /*************************************************************************/
 
 #include "shader_rd.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/project_settings.h"
 #include "core/string_builder.h"
+#include "core/version.h"
+#include "core/version_hash.gen.h"
 #include "rasterizer_rd.h"
 #include "servers/visual/rendering_device.h"
 
+#define SHADER_CACHE_MAGIC 0x43535347 // "GSSC"
+
 void ShaderRD::setup(const char *p_vertex_code, const char *p_fragment_code, const char *p_compute_code, const char *p_name) {
 
 	name = p_name;
@@ -206,6 +213,83 @@ void ShaderRD::_clear_version(Version *p_version) {
 	}
 }
 
+bool ShaderRD::_load_from_cache(const String &p_path, PoolVector<uint8_t> &r_spirv) {
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f) {
+		return false;
+	}
+
+	bool valid = f->get_len() > 12 && f->get_32() == SHADER_CACHE_MAGIC;
+	uint32_t size = 0;
+	uint32_t hash = 0;
+	if (valid) {
+		size = f->get_32();
+		hash = f->get_32();
+		valid = size > 0 && (size % 4) == 0 && f->get_len() - f->get_position() == size;
+	}
+
+	if (valid) {
+		r_spirv.resize(size);
+		PoolVector<uint8_t>::Write w = r_spirv.write();
+		f->get_buffer(w.ptr(), size);
+		valid = hash_djb2_buffer(w.ptr(), size) == hash;
+	}
+
+	f->close();
+	memdelete(f);
+
+	if (!valid) {
+		r_spirv.resize(0);
+	}
+
+	return valid;
+}
+
+void ShaderRD::_save_to_cache(const String &p_path, const PoolVector<uint8_t> &p_spirv) {
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE);
+	if (!f) {
+		return; //cache is best effort, user data folder may be read-only
+	}
+
+	PoolVector<uint8_t>::Read r = p_spirv.read();
+	f->store_32(SHADER_CACHE_MAGIC);
+	f->store_32(p_spirv.size());
+	f->store_32(hash_djb2_buffer(r.ptr(), p_spirv.size()));
+	f->store_buffer(r.ptr(), p_spirv.size());
+	f->close();
+	memdelete(f);
+}
+
+// A cache miss still compiles synchronously, in parallel across variants on
+// the thread work pool. Canvas and scene shader data create their pipelines
+// right after version_set_code(), so compiling in the background with a
+// fallback variant would need those owners to rebuild pipelines once the
+// real variant is ready.
+PoolVector<uint8_t> ShaderRD::_compile_stage(RD::ShaderStage p_stage, const String &p_source, String *r_error) {
+
+	String cache_path;
+	if (shader_cache_dir != String()) {
+		//source already contains version, general, variant and custom defines
+		String key = String(VERSION_FULL_BUILD) + "." + VERSION_HASH + "\n" + itos(p_stage) + "\n" + p_source;
+		cache_path = shader_cache_dir.plus_file(key.sha256_text() + ".spv");
+
+		PoolVector<uint8_t> spirv;
+		if (_load_from_cache(cache_path, spirv)) {
+			return spirv;
+		}
+	}
+
+	PoolVector<uint8_t> spirv = RD::get_singleton()->shader_compile_from_source(p_stage, p_source, RD::SHADER_LANGUAGE_GLSL, r_error);
+
+	if (spirv.size() && cache_path != String()) {
+		_save_to_cache(cache_path, spirv);
+	}
+
+	return spirv;
+}
+
 void ShaderRD::_compile_variant(uint32_t p_variant, Version *p_version) {
 
 	Vector<RD::ShaderStageData> stages;
@@ -245,7 +329,7 @@ void ShaderRD::_compile_variant(uint32_t p_variant, Version *p_version) {
 
 		current_source = builder.as_string();
 		RD::ShaderStageData stage;
-		stage.spir_v = RD::get_singleton()->shader_compile_from_source(RD::SHADER_STAGE_VERTEX, current_source, RD::SHADER_LANGUAGE_GLSL, &error);
+		stage.spir_v = _compile_stage(RD::SHADER_STAGE_VERTEX, current_source, &error);
 		if (stage.spir_v.size() == 0) {
 			build_ok = false;
 		} else {
@@ -290,7 +374,7 @@ void ShaderRD::_compile_variant(uint32_t p_variant, Version *p_version) {
 
 		current_source = builder.as_string();
 		RD::ShaderStageData stage;
-		stage.spir_v = RD::get_singleton()->shader_compile_from_source(RD::SHADER_STAGE_FRAGMENT, current_source, RD::SHADER_LANGUAGE_GLSL, &error);
+		stage.spir_v = _compile_stage(RD::SHADER_STAGE_FRAGMENT, current_source, &error);
 		if (stage.spir_v.size() == 0) {
 			build_ok = false;
 		} else {
@@ -331,7 +415,7 @@ void ShaderRD::_compile_variant(uint32_t p_variant, Version *p_version) {
 
 		current_source = builder.as_string();
 		RD::ShaderStageData stage;
-		stage.spir_v = RD::get_singleton()->shader_compile_from_source(RD::SHADER_STAGE_COMPUTE, current_source, RD::SHADER_LANGUAGE_GLSL, &error);
+		stage.spir_v = _compile_stage(RD::SHADER_STAGE_COMPUTE, current_source, &error);
 		if (stage.spir_v.size() == 0) {
 			build_ok = false;
 		} else {
@@ -481,6 +565,18 @@ void ShaderRD::initialize(const Vector<String> &p_variant_defines, const String
 
 		variant_defines.push_back(p_variant_defines[i].utf8());
 	}
+
+	if (GLOBAL_DEF("rendering/vulkan/shader_cache/enable", true)) {
+		shader_cache_dir = String("user://shader_cache").plus_file(name);
+
+		DirAccess *da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+		Error err = da->make_dir_recursive(shader_cache_dir);
+		memdelete(da);
+		if (err != OK && err != ERR_ALREADY_EXISTS) {
+			print_verbose("Unable to create shader cache directory '" + shader_cache_dir + "', shaders will not be cached.");
+			shader_cache_dir = String();
+		}
+	}
 }
 
 ShaderRD::~ShaderRD() {
@@ -35,6 +35,7 @@
 #include "core/map.h"
 #include "core/rid_owner.h"
 #include "core/variant.h"
+#include "servers/visual/rendering_device.h"
 #include <stdio.h>
 #include <mutex>
 /**
@@ -71,6 +72,12 @@ class ShaderRD {
 
 	std::mutex variant_set_mutex;
 
+	//compiled SPIR-V is kept on disk, keyed by a hash of the full stage source and engine version
+	String shader_cache_dir;
+
+	bool _load_from_cache(const String &p_path, PoolVector<uint8_t> &r_spirv);
+	void _save_to_cache(const String &p_path, const PoolVector<uint8_t> &p_spirv);
+	PoolVector<uint8_t> _compile_stage(RD::ShaderStage p_stage, const String &p_source, String *r_error);
 	void _compile_variant(uint32_t p_variant, Version *p_version);
 
 	void _clear_version(Version *p_version);
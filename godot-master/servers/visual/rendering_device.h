@@ -1021,6 +1021,14 @@ public:
 
 	virtual uint32_t get_frame_delay() const = 0;
 
+	//pipelines created from (or missing in) the persistent pipeline cache, 0 when the driver can't tell
+	virtual uint32_t get_pipeline_cache_hits() const = 0;
+	virtual uint32_t get_pipeline_cache_misses() const = 0;
+
+	//bytes uploaded through the staging buffers and stalls caused by running out of them, in the previous frame
+	virtual uint64_t get_staging_buffer_upload_bytes() const = 0;
+	virtual uint32_t get_staging_buffer_stall_count() const = 0;
+
 	static RenderingDevice *get_singleton();
 
 	RenderingDevice();
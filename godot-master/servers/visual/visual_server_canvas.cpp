@@ -76,10 +76,10 @@ void _collect_ysort_children(VisualServerCanvas::Item *p_canvas_item, Transform2
 		if (child_items[i]->visible) {
 			if (r_items) {
 				r_items[r_index] = child_items[i];
-				child_items[i]->ysort_xform = p_transform;
-				child_items[i]->ysort_pos = p_transform.xform(child_items[i]->xform.elements[2]);
-				child_items[i]->material_owner = child_items[i]->use_parent_material ? p_material_owner : NULL;
 			}
+			child_items[i]->ysort_xform = p_transform;
+			child_items[i]->ysort_pos = p_transform.xform(child_items[i]->xform.elements[2]);
+			child_items[i]->material_owner = child_items[i]->use_parent_material ? p_material_owner : NULL;
 
 			r_index++;
 
@@ -96,6 +96,61 @@ void _mark_ysort_dirty(VisualServerCanvas::Item *ysort_owner, RID_PtrOwner<Visua
 	} while (ysort_owner && ysort_owner->sort_y);
 }
 
+void _resort_ysort_children(VisualServerCanvas::Item **p_items, int p_count) {
+
+	// The previous order is usually still correct or off by a few swaps, so an
+	// insertion sort on it is close to linear. Fall back to a full sort when too
+	// many items moved since last frame.
+	VisualServerCanvas::ItemPtrSort compare;
+	int moves_left = p_count * 4 + 64;
+
+	for (int i = 1; i < p_count; i++) {
+		VisualServerCanvas::Item *item = p_items[i];
+		int j = i;
+		while (j > 0 && compare(item, p_items[j - 1])) {
+			p_items[j] = p_items[j - 1];
+			j--;
+		}
+		p_items[j] = item;
+
+		moves_left -= i - j;
+		if (moves_left < 0) {
+			SortArray<VisualServerCanvas::Item *, VisualServerCanvas::ItemPtrSort> sorter;
+			sorter.sort(p_items, p_count);
+			return;
+		}
+	}
+}
+
+void _mark_subtree_rect_dirty(VisualServerCanvas::Item *p_canvas_item, RID_PtrOwner<VisualServerCanvas::Item> &canvas_item_owner) {
+	// A dirty item always has dirty ancestors, so stop at the first one already marked.
+	while (p_canvas_item && !p_canvas_item->subtree_rect_dirty) {
+		p_canvas_item->subtree_rect_dirty = true;
+		p_canvas_item = canvas_item_owner.owns(p_canvas_item->parent) ? canvas_item_owner.getornull(p_canvas_item->parent) : NULL;
+	}
+}
+
+void _update_subtree_rect(VisualServerCanvas::Item *p_canvas_item) {
+
+	// Hidden children are included too, so toggling visibility does not invalidate the bounds.
+	Rect2 subtree_rect = p_canvas_item->get_rect();
+	bool cullable = !p_canvas_item->update_when_visible && !p_canvas_item->vp_render && !p_canvas_item->copy_back_buffer;
+
+	int child_item_count = p_canvas_item->child_items.size();
+	VisualServerCanvas::Item **child_items = p_canvas_item->child_items.ptrw();
+	for (int i = 0; i < child_item_count; i++) {
+		if (child_items[i]->subtree_rect_dirty) {
+			_update_subtree_rect(child_items[i]);
+		}
+		subtree_rect = subtree_rect.merge(child_items[i]->xform.xform(child_items[i]->subtree_rect));
+		cullable = cullable && child_items[i]->subtree_cullable;
+	}
+
+	p_canvas_item->subtree_rect = subtree_rect;
+	p_canvas_item->subtree_cullable = cullable;
+	p_canvas_item->subtree_rect_dirty = false;
+}
+
 void VisualServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RasterizerCanvas::Item **z_list, RasterizerCanvas::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner) {
 
 	Item *ci = p_canvas_item;
@@ -114,6 +169,19 @@ void VisualServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transform2
 	Rect2 global_rect = xform.xform(rect);
 	global_rect.position += p_clip_rect.position;
 
+	if (ci->subtree_rect_dirty) {
+		_update_subtree_rect(ci);
+	}
+
+	if (ci->subtree_cullable) {
+		// Nothing in this subtree can reach the screen, skip it entirely.
+		Rect2 subtree_global_rect = xform.xform(ci->subtree_rect);
+		subtree_global_rect.position += p_clip_rect.position;
+		if (!p_clip_rect.intersects_touch(subtree_global_rect)) {
+			return;
+		}
+	}
+
 	if (ci->use_parent_material && p_material_owner)
 		ci->material_owner = p_material_owner;
 	else {
@@ -146,16 +214,22 @@ void VisualServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transform2
 		if (ci->ysort_children_count == -1) {
 			ci->ysort_children_count = 0;
 			_collect_ysort_children(ci, Transform2D(), p_material_owner, NULL, ci->ysort_children_count);
-		}
+			ci->ysort_children.resize(ci->ysort_children_count);
 
-		child_item_count = ci->ysort_children_count;
-		child_items = (Item **)alloca(child_item_count * sizeof(Item *));
+			int i = 0;
+			_collect_ysort_children(ci, Transform2D(), p_material_owner, ci->ysort_children.ptrw(), i);
 
-		int i = 0;
-		_collect_ysort_children(ci, Transform2D(), p_material_owner, child_items, i);
+			SortArray<Item *, ItemPtrSort> sorter;
+			sorter.sort(ci->ysort_children.ptrw(), ci->ysort_children_count);
+		} else {
+			// Same children as last frame, refresh their positions and fix up the previous order.
+			int i = 0;
+			_collect_ysort_children(ci, Transform2D(), p_material_owner, NULL, i);
+			_resort_ysort_children(ci->ysort_children.ptrw(), ci->ysort_children_count);
+		}
 
-		SortArray<Item *, ItemPtrSort> sorter;
-		sorter.sort(child_items, child_item_count);
+		child_item_count = ci->ysort_children_count;
+		child_items = ci->ysort_children.ptrw();
 	}
 
 	if (ci->z_relative)
@@ -359,6 +433,7 @@ void VisualServerCanvas::canvas_item_set_parent(RID p_item, RID p_parent) {
 
 			Item *item_owner = canvas_item_owner.getornull(canvas_item->parent);
 			item_owner->child_items.erase(canvas_item);
+			_mark_subtree_rect_dirty(item_owner, canvas_item_owner);
 
 			if (item_owner->sort_y) {
 				_mark_ysort_dirty(item_owner, canvas_item_owner);
@@ -381,6 +456,7 @@ void VisualServerCanvas::canvas_item_set_parent(RID p_item, RID p_parent) {
 			Item *item_owner = canvas_item_owner.getornull(p_parent);
 			item_owner->child_items.push_back(canvas_item);
 			item_owner->children_order_dirty = true;
+			_mark_subtree_rect_dirty(item_owner, canvas_item_owner);
 
 			if (item_owner->sort_y) {
 				_mark_ysort_dirty(item_owner, canvas_item_owner);
@@ -417,6 +493,10 @@ void VisualServerCanvas::canvas_item_set_transform(RID p_item, const Transform2D
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->xform = p_transform;
+
+	if (canvas_item_owner.owns(canvas_item->parent)) {
+		_mark_subtree_rect_dirty(canvas_item_owner.getornull(canvas_item->parent), canvas_item_owner);
+	}
 }
 void VisualServerCanvas::canvas_item_set_clip(RID p_item, bool p_clip) {
 
@@ -439,6 +519,8 @@ void VisualServerCanvas::canvas_item_set_custom_rect(RID p_item, bool p_custom_r
 
 	canvas_item->custom_rect = p_custom_rect;
 	canvas_item->rect = p_rect;
+
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 }
 void VisualServerCanvas::canvas_item_set_modulate(RID p_item, const Color &p_color) {
 
@@ -469,6 +551,8 @@ void VisualServerCanvas::canvas_item_set_update_when_visible(RID p_item, bool p_
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->update_when_visible = p_update;
+
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 }
 
 void VisualServerCanvas::canvas_item_set_default_texture_filter(RID p_item, VS::CanvasItemTextureFilter p_filter) {
@@ -492,6 +576,7 @@ void VisualServerCanvas::canvas_item_add_line(RID p_item, const Point2 &p_from,
 
 	Item::CommandPrimitive *line = canvas_item->alloc_command<Item::CommandPrimitive>();
 	ERR_FAIL_COND(!line);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	if (p_width > 1.001) {
 
 		Vector2 t = (p_from - p_to).tangent().normalized();
@@ -519,6 +604,7 @@ void VisualServerCanvas::canvas_item_add_polyline(RID p_item, const Vector<Point
 
 	Item::CommandPolygon *pline = canvas_item->alloc_command<Item::CommandPolygon>();
 	ERR_FAIL_COND(!pline);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 
 	pline->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, RID(), RID(), RID(), VS::CANVAS_ITEM_TEXTURE_FILTER_NEAREST, VS::CANVAS_ITEM_TEXTURE_REPEAT_DISABLED, RID());
 
@@ -611,6 +697,7 @@ void VisualServerCanvas::canvas_item_add_multiline(RID p_item, const Vector<Poin
 
 	Item::CommandPolygon *pline = canvas_item->alloc_command<Item::CommandPolygon>();
 	ERR_FAIL_COND(!pline);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 
 	pline->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, RID(), RID(), RID(), VS::CANVAS_ITEM_TEXTURE_FILTER_NEAREST, VS::CANVAS_ITEM_TEXTURE_REPEAT_DISABLED, RID());
 
@@ -631,6 +718,7 @@ void VisualServerCanvas::canvas_item_add_rect(RID p_item, const Rect2 &p_rect, c
 
 	Item::CommandRect *rect = canvas_item->alloc_command<Item::CommandRect>();
 	ERR_FAIL_COND(!rect);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	rect->modulate = p_color;
 	rect->rect = p_rect;
 }
@@ -642,6 +730,7 @@ void VisualServerCanvas::canvas_item_add_circle(RID p_item, const Point2 &p_pos,
 
 	Item::CommandPolygon *circle = canvas_item->alloc_command<Item::CommandPolygon>();
 	ERR_FAIL_COND(!circle);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 
 	circle->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, RID(), RID(), RID(), VS::CANVAS_ITEM_TEXTURE_FILTER_NEAREST, VS::CANVAS_ITEM_TEXTURE_REPEAT_DISABLED, RID());
 
@@ -680,6 +769,7 @@ void VisualServerCanvas::canvas_item_add_texture_rect(RID p_item, const Rect2 &p
 
 	Item::CommandRect *rect = canvas_item->alloc_command<Item::CommandRect>();
 	ERR_FAIL_COND(!rect);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	rect->modulate = p_modulate;
 	rect->rect = p_rect;
 	rect->flags = 0;
@@ -714,6 +804,7 @@ void VisualServerCanvas::canvas_item_add_texture_rect_region(RID p_item, const R
 
 	Item::CommandRect *rect = canvas_item->alloc_command<Item::CommandRect>();
 	ERR_FAIL_COND(!rect);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	rect->modulate = p_modulate;
 	rect->rect = p_rect;
 	rect->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, p_texture, p_normal_map, p_specular_map, p_filter, p_repeat, RID());
@@ -759,6 +850,7 @@ void VisualServerCanvas::canvas_item_add_nine_patch(RID p_item, const Rect2 &p_r
 
 	Item::CommandNinePatch *style = canvas_item->alloc_command<Item::CommandNinePatch>();
 	ERR_FAIL_COND(!style);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	style->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, p_texture, p_normal_map, p_specular_map, p_filter, p_repeat, RID());
 	style->specular_shininess = p_specular_color_shininess;
 	style->rect = p_rect;
@@ -782,6 +874,7 @@ void VisualServerCanvas::canvas_item_add_primitive(RID p_item, const Vector<Poin
 
 	Item::CommandPrimitive *prim = canvas_item->alloc_command<Item::CommandPrimitive>();
 	ERR_FAIL_COND(!prim);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 
 	for (int i = 0; i < p_points.size(); i++) {
 		prim->points[i] = p_points[i];
@@ -820,6 +913,7 @@ void VisualServerCanvas::canvas_item_add_polygon(RID p_item, const Vector<Point2
 
 	Item::CommandPolygon *polygon = canvas_item->alloc_command<Item::CommandPolygon>();
 	ERR_FAIL_COND(!polygon);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	polygon->primitive = VS::PRIMITIVE_TRIANGLES;
 	polygon->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, p_texture, p_normal_map, p_specular_map, p_filter, p_repeat, RID());
 	polygon->specular_shininess = p_specular_color_shininess;
@@ -842,6 +936,7 @@ void VisualServerCanvas::canvas_item_add_triangle_array(RID p_item, const Vector
 
 	Item::CommandPolygon *polygon = canvas_item->alloc_command<Item::CommandPolygon>();
 	ERR_FAIL_COND(!polygon);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	polygon->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, p_texture, p_normal_map, p_specular_map, p_filter, p_repeat, RID());
 	polygon->specular_shininess = p_specular_color_shininess;
 	polygon->polygon.create(indices, p_points, p_colors, p_uvs, p_bones, p_weights);
@@ -856,6 +951,7 @@ void VisualServerCanvas::canvas_item_add_set_transform(RID p_item, const Transfo
 
 	Item::CommandTransform *tr = canvas_item->alloc_command<Item::CommandTransform>();
 	ERR_FAIL_COND(!tr);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	tr->xform = p_transform;
 }
 
@@ -866,6 +962,7 @@ void VisualServerCanvas::canvas_item_add_mesh(RID p_item, const RID &p_mesh, con
 
 	Item::CommandMesh *m = canvas_item->alloc_command<Item::CommandMesh>();
 	ERR_FAIL_COND(!m);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	m->mesh = p_mesh;
 	m->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, p_texture, p_normal_map, p_specular_map, p_filter, p_repeat, RID());
 	m->specular_shininess = p_specular_color_shininess;
@@ -879,6 +976,7 @@ void VisualServerCanvas::canvas_item_add_particles(RID p_item, RID p_particles,
 
 	Item::CommandParticles *part = canvas_item->alloc_command<Item::CommandParticles>();
 	ERR_FAIL_COND(!part);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	part->particles = p_particles;
 	part->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, p_texture, p_normal_map, p_specular_map, p_filter, p_repeat, RID());
 	part->specular_shininess = p_specular_color_shininess;
@@ -894,6 +992,7 @@ void VisualServerCanvas::canvas_item_add_multimesh(RID p_item, RID p_mesh, RID p
 
 	Item::CommandMultiMesh *mm = canvas_item->alloc_command<Item::CommandMultiMesh>();
 	ERR_FAIL_COND(!mm);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	mm->multimesh = p_mesh;
 	mm->texture_binding.create(canvas_item->texture_filter, canvas_item->texture_repeat, p_texture, p_normal_map, p_specular_map, p_filter, p_repeat, mm->multimesh);
 	mm->specular_shininess = p_specular_color_shininess;
@@ -906,6 +1005,7 @@ void VisualServerCanvas::canvas_item_add_clip_ignore(RID p_item, bool p_ignore)
 
 	Item::CommandClipIgnore *ci = canvas_item->alloc_command<Item::CommandClipIgnore>();
 	ERR_FAIL_COND(!ci);
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 	ci->ignore = p_ignore;
 }
 void VisualServerCanvas::canvas_item_set_sort_children_by_y(RID p_item, bool p_enable) {
@@ -959,6 +1059,8 @@ void VisualServerCanvas::canvas_item_set_copy_to_backbuffer(RID p_item, bool p_e
 		canvas_item->copy_back_buffer->rect = p_rect;
 		canvas_item->copy_back_buffer->full = p_rect == Rect2();
 	}
+
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 }
 
 void VisualServerCanvas::canvas_item_clear(RID p_item) {
@@ -967,6 +1069,8 @@ void VisualServerCanvas::canvas_item_clear(RID p_item) {
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->clear();
+
+	_mark_subtree_rect_dirty(canvas_item, canvas_item_owner);
 }
 void VisualServerCanvas::canvas_item_set_draw_index(RID p_item, int p_index) {
 
@@ -1383,6 +1487,7 @@ bool VisualServerCanvas::free(RID p_rid) {
 
 				Item *item_owner = canvas_item_owner.getornull(canvas_item->parent);
 				item_owner->child_items.erase(canvas_item);
+				_mark_subtree_rect_dirty(item_owner, canvas_item_owner);
 
 				if (item_owner->sort_y) {
 					_mark_ysort_dirty(item_owner, canvas_item_owner);
@@ -52,6 +52,10 @@ public:
 		Color ysort_modulate;
 		Transform2D ysort_xform;
 		Vector2 ysort_pos;
+		Vector<Item *> ysort_children; // sorted order from the last frame
+		Rect2 subtree_rect; // own rect merged with all children, in local space
+		bool subtree_rect_dirty;
+		bool subtree_cullable;
 		VS::CanvasItemTextureFilter texture_filter;
 		VS::CanvasItemTextureRepeat texture_repeat;
 
@@ -70,6 +74,8 @@ public:
 			ysort_children_count = -1;
 			ysort_xform = Transform2D();
 			ysort_pos = Vector2();
+			subtree_rect_dirty = true;
+			subtree_cullable = false;
 			texture_filter = VS::CANVAS_ITEM_TEXTURE_FILTER_DEFAULT;
 			texture_repeat = VS::CANVAS_ITEM_TEXTURE_REPEAT_DEFAULT;
 		}
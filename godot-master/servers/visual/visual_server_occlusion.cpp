@@ -0,0 +1,369 @@
+/*************************************************************************/
+/*  visual_server_occlusion.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "visual_server_occlusion.h"
+
+#define OCCLUSION_CLEAR_DEPTH 1e20
+
+OcclusionBufferSW::ClipVertex OcclusionBufferSW::_xform(const Vector3 &p_point) const {
+
+	const real_t(*m)[4] = view_projection.matrix;
+
+	ClipVertex v;
+	v.x = m[0][0] * p_point.x + m[1][0] * p_point.y + m[2][0] * p_point.z + m[3][0];
+	v.y = m[0][1] * p_point.x + m[1][1] * p_point.y + m[2][1] * p_point.z + m[3][1];
+	v.z = m[0][2] * p_point.x + m[1][2] * p_point.y + m[2][2] * p_point.z + m[3][2];
+	v.w = m[0][3] * p_point.x + m[1][3] * p_point.y + m[2][3] * p_point.z + m[3][3];
+	return v;
+}
+
+void OcclusionBufferSW::_rasterize_polygon(const ClipVertex *p_points, int p_count) {
+
+	// to screen space, y pointing down
+	Vector3 v[MAX_POLYGON_POINTS];
+	for (int i = 0; i < p_count; i++) {
+		float inv_w = 1.0 / p_points[i].w;
+		v[i].x = (p_points[i].x * inv_w * 0.5 + 0.5) * width;
+		v[i].y = (0.5 - p_points[i].y * inv_w * 0.5) * height;
+		v[i].z = p_points[i].z * inv_w;
+	}
+
+	// depth comes from the largest triangle of the fan, the face is planar
+	float area = 0;
+	int depth_vertex = 1;
+	for (int i = 1; i < p_count - 1; i++) {
+		float a = (v[i].x - v[0].x) * (v[i + 1].y - v[0].y) - (v[i].y - v[0].y) * (v[i + 1].x - v[0].x);
+		if (Math::abs(a) > Math::abs(area)) {
+			area = a;
+			depth_vertex = i;
+		}
+	}
+
+	if (Math::abs(area) < CMP_EPSILON) {
+		return;
+	}
+
+	Vector3 d0 = v[0];
+	Vector3 d1 = v[depth_vertex];
+	Vector3 d2 = v[depth_vertex + 1];
+
+	if (area < 0) {
+		// both windings are drawn, boxes are closed so nothing is culled by facing
+		for (int i = 0; i < p_count / 2; i++) {
+			SWAP(v[i], v[p_count - 1 - i]);
+		}
+		SWAP(d1, d2);
+		area = -area;
+	}
+
+	float min_x = v[0].x, max_x = v[0].x, min_y = v[0].y, max_y = v[0].y;
+	for (int i = 1; i < p_count; i++) {
+		min_x = MIN(min_x, v[i].x);
+		max_x = MAX(max_x, v[i].x);
+		min_y = MIN(min_y, v[i].y);
+		max_y = MAX(max_y, v[i].y);
+	}
+
+	int x0 = MAX(0, (int)Math::floor(min_x));
+	int x1 = MIN(width - 1, (int)Math::ceil(max_x));
+	int y0 = MAX(0, (int)Math::floor(min_y));
+	int y1 = MIN(height - 1, (int)Math::ceil(max_y));
+
+	if (x0 > x1 || y0 > y1) {
+		return;
+	}
+
+	// one edge function per side, positive inside, unused sides always pass
+	float inv_area = 1.0 / area;
+	float step_x[MAX_POLYGON_POINTS], step_y[MAX_POLYGON_POINTS], base[MAX_POLYGON_POINTS];
+	for (int i = 0; i < MAX_POLYGON_POINTS; i++) {
+		if (i >= p_count) {
+			step_x[i] = 0;
+			step_y[i] = 0;
+			base[i] = 1;
+			continue;
+		}
+		const Vector3 &from = v[i];
+		const Vector3 &to = v[(i + 1) % p_count];
+		step_x[i] = -(to.y - from.y) * inv_area;
+		step_y[i] = (to.x - from.x) * inv_area;
+		base[i] = ((to.x - from.x) * (y0 + 0.5 - from.y) - (to.y - from.y) * (x0 + 0.5 - from.x)) * inv_area;
+	}
+
+	// depth is affine in screen space, step it alongside the barycentric weights
+	// of the depth triangle, which are its opposite edge functions
+	float z_step_x = (-(d2.y - d1.y) * d0.z - (d0.y - d2.y) * d1.z - (d1.y - d0.y) * d2.z) * inv_area;
+	float z_step_y = ((d2.x - d1.x) * d0.z + (d0.x - d2.x) * d1.z + (d1.x - d0.x) * d2.z) * inv_area;
+	float z_base = d0.z + (x0 + 0.5 - d0.x) * z_step_x + (y0 + 0.5 - d0.y) * z_step_y;
+
+	// Conservative: a texel is only written when the whole of it is covered,
+	// with the farthest depth found inside it. Both are linear, so their extremes
+	// over the texel are at a corner, half a step in x and y away from the center.
+	for (int i = 0; i < MAX_POLYGON_POINTS; i++) {
+		base[i] -= 0.5 * (Math::abs(step_x[i]) + Math::abs(step_y[i]));
+	}
+	z_base += 0.5 * (Math::abs(z_step_x) + Math::abs(z_step_y));
+
+	float *buffer = depth.ptrw();
+
+	for (int y = y0; y <= y1; y++) {
+
+		float w[MAX_POLYGON_POINTS];
+		for (int i = 0; i < MAX_POLYGON_POINTS; i++) {
+			w[i] = base[i];
+		}
+		float z = z_base;
+		float *row = &buffer[y * width];
+
+		// kept free of early outs so the compiler can vectorize it
+		for (int x = x0; x <= x1; x++) {
+			bool inside = (w[0] >= 0) & (w[1] >= 0) & (w[2] >= 0) & (w[3] >= 0) & (w[4] >= 0);
+			float d = row[x];
+			row[x] = (inside && z < d) ? z : d;
+			for (int i = 0; i < MAX_POLYGON_POINTS; i++) {
+				w[i] += step_x[i];
+			}
+			z += z_step_x;
+		}
+
+		for (int i = 0; i < MAX_POLYGON_POINTS; i++) {
+			base[i] += step_y[i];
+		}
+		z_base += z_step_y;
+	}
+}
+
+void OcclusionBufferSW::_clip_and_rasterize_face(const ClipVertex *p_points, int p_count) {
+
+	// only the near plane (z >= -w) needs clipping, the rest is handled by the screen bounds
+	ClipVertex clipped[MAX_POLYGON_POINTS];
+	int count = 0;
+
+	for (int i = 0; i < p_count; i++) {
+
+		const ClipVertex &from = p_points[i];
+		const ClipVertex &to = p_points[(i + 1) % p_count];
+		float d_from = from.z + from.w;
+		float d_to = to.z + to.w;
+
+		if (d_from >= 0) {
+			clipped[count++] = from;
+		}
+
+		if ((d_from >= 0) != (d_to >= 0)) {
+			float t = d_from / (d_from - d_to);
+			ClipVertex &c = clipped[count++];
+			c.x = from.x + (to.x - from.x) * t;
+			c.y = from.y + (to.y - from.y) * t;
+			c.z = from.z + (to.z - from.z) * t;
+			c.w = from.w + (to.w - from.w) * t;
+		}
+	}
+
+	if (count < 3) {
+		return;
+	}
+
+	_rasterize_polygon(clipped, count);
+}
+
+void OcclusionBufferSW::resize(int p_width, int p_height) {
+
+	ERR_FAIL_COND(p_width < 1 || p_height < 1);
+
+	if (p_width == width && p_height == height) {
+		return;
+	}
+
+	width = p_width;
+	height = p_height;
+
+	int w = width;
+	int h = height;
+	int offset = 0;
+	level_count = 0;
+
+	while (level_count < MAX_LEVELS) {
+		levels[level_count].width = w;
+		levels[level_count].height = h;
+		levels[level_count].offset = offset;
+		level_count++;
+		offset += w * h;
+
+		if (w == 1 && h == 1) {
+			break;
+		}
+		w = MAX(1, (w + 1) >> 1);
+		h = MAX(1, (h + 1) >> 1);
+	}
+
+	depth.resize(offset);
+	has_occluders = false;
+}
+
+void OcclusionBufferSW::begin(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection) {
+
+	view_projection = p_cam_projection * CameraMatrix(p_cam_transform.affine_inverse());
+
+	float *buffer = depth.ptrw();
+	int size = width * height;
+	for (int i = 0; i < size; i++) {
+		buffer[i] = OCCLUSION_CLEAR_DEPTH;
+	}
+
+	has_occluders = false;
+}
+
+void OcclusionBufferSW::rasterize_box(const Transform &p_xform, const AABB &p_aabb) {
+
+	// endpoint bits are z, y, x from lowest to highest
+	static const int faces[6][4] = {
+		{ 0, 1, 3, 2 },
+		{ 4, 6, 7, 5 },
+		{ 0, 4, 5, 1 },
+		{ 2, 3, 7, 6 },
+		{ 0, 2, 6, 4 },
+		{ 1, 5, 7, 3 },
+	};
+
+	ClipVertex points[8];
+	for (int i = 0; i < 8; i++) {
+		points[i] = _xform(p_xform.xform(p_aabb.get_endpoint(i)));
+	}
+
+	// faces are drawn whole, conservative coverage would leave gaps along a split diagonal
+	for (int i = 0; i < 6; i++) {
+		const int *f = faces[i];
+		ClipVertex face[4] = { points[f[0]], points[f[1]], points[f[2]], points[f[3]] };
+		_clip_and_rasterize_face(face, 4);
+	}
+
+	has_occluders = true;
+}
+
+void OcclusionBufferSW::end() {
+
+	if (!has_occluders) {
+		return;
+	}
+
+	// each texel of a level keeps the farthest depth of the texels it covers below
+	float *buffer = depth.ptrw();
+
+	for (int i = 1; i < level_count; i++) {
+
+		const Level &src = levels[i - 1];
+		const Level &dst = levels[i];
+		const float *src_ptr = &buffer[src.offset];
+		float *dst_ptr = &buffer[dst.offset];
+
+		for (int y = 0; y < dst.height; y++) {
+
+			int y0 = MIN(y * 2, src.height - 1);
+			int y1 = MIN(y * 2 + 1, src.height - 1);
+			const float *row0 = &src_ptr[y0 * src.width];
+			const float *row1 = &src_ptr[y1 * src.width];
+
+			for (int x = 0; x < dst.width; x++) {
+
+				int x0 = MIN(x * 2, src.width - 1);
+				int x1 = MIN(x * 2 + 1, src.width - 1);
+				dst_ptr[y * dst.width + x] = MAX(MAX(row0[x0], row0[x1]), MAX(row1[x0], row1[x1]));
+			}
+		}
+	}
+}
+
+bool OcclusionBufferSW::is_occluded(const AABB &p_aabb) const {
+
+	if (!has_occluders) {
+		return false;
+	}
+
+	float min_x = 1e20, min_y = 1e20, min_z = 1e20;
+	float max_x = -1e20, max_y = -1e20;
+
+	for (int i = 0; i < 8; i++) {
+
+		ClipVertex v = _xform(p_aabb.get_endpoint(i));
+		if (v.z < -v.w || v.w <= 0) {
+			// touches the near plane, can't be behind anything
+			return false;
+		}
+
+		float inv_w = 1.0 / v.w;
+		float x = (v.x * inv_w * 0.5 + 0.5) * width;
+		float y = (0.5 - v.y * inv_w * 0.5) * height;
+		min_x = MIN(min_x, x);
+		max_x = MAX(max_x, x);
+		min_y = MIN(min_y, y);
+		max_y = MAX(max_y, y);
+		min_z = MIN(min_z, v.z * inv_w);
+	}
+
+	int x0 = MAX(0, (int)Math::floor(min_x));
+	int x1 = MIN(width - 1, (int)Math::floor(max_x));
+	int y0 = MAX(0, (int)Math::floor(min_y));
+	int y1 = MIN(height - 1, (int)Math::floor(max_y));
+
+	if (x0 > x1 || y0 > y1) {
+		return false;
+	}
+
+	// pick the first level where the rect spans at most 4x4 texels
+	int level = 0;
+	while (level < level_count - 1 && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3)) {
+		level++;
+	}
+
+	const Level &l = levels[level];
+	const float *buffer = &depth[l.offset];
+	int tx1 = MIN(x1 >> level, l.width - 1);
+	int ty1 = MIN(y1 >> level, l.height - 1);
+
+	for (int y = y0 >> level; y <= ty1; y++) {
+		for (int x = x0 >> level; x <= tx1; x++) {
+			if (buffer[y * l.width + x] >= min_z) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+OcclusionBufferSW::OcclusionBufferSW() {
+
+	level_count = 0;
+	width = 0;
+	height = 0;
+	has_occluders = false;
+}
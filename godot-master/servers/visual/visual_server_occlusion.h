@@ -0,0 +1,85 @@
+/*************************************************************************/
+/*  visual_server_occlusion.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef VISUAL_SERVER_OCCLUSION_H
+#define VISUAL_SERVER_OCCLUSION_H
+
+#include "core/math/camera_matrix.h"
+#include "core/vector.h"
+
+// Low resolution depth buffer rasterized on the CPU from occluder boxes,
+// with a max-depth pyramid (hierarchical Z) used to reject bounds that are
+// completely hidden behind them. Depth is stored as NDC z, so it can be
+// interpolated linearly in screen space for both projection types.
+class OcclusionBufferSW {
+
+	enum {
+		MAX_LEVELS = 16,
+		MAX_POLYGON_POINTS = 5 // a box face clipped by the near plane
+	};
+
+	struct Level {
+		int width;
+		int height;
+		int offset; // into depth
+	};
+
+	Level levels[MAX_LEVELS];
+	int level_count;
+	int width;
+	int height;
+	Vector<float> depth;
+
+	CameraMatrix view_projection;
+	bool has_occluders; // nothing to test against when false
+
+	struct ClipVertex {
+		float x, y, z, w;
+	};
+
+	_FORCE_INLINE_ ClipVertex _xform(const Vector3 &p_point) const;
+	void _rasterize_polygon(const ClipVertex *p_points, int p_count);
+	void _clip_and_rasterize_face(const ClipVertex *p_points, int p_count);
+
+public:
+	void resize(int p_width, int p_height);
+	_FORCE_INLINE_ int get_width() const { return width; }
+	_FORCE_INLINE_ int get_height() const { return height; }
+
+	void begin(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection);
+	void rasterize_box(const Transform &p_xform, const AABB &p_aabb);
+	void end();
+
+	bool is_occluded(const AABB &p_aabb) const;
+
+	OcclusionBufferSW();
+};
+
+#endif // VISUAL_SERVER_OCCLUSION_H
@@ -107,6 +107,8 @@ void VisualServerRaster::draw(bool p_swap_buffers, double frame_step) {
 
 	VSG::scene_render->update(); //update scenes stuff before updating instances
 
+	VSG::scene->occlusion_begin_frame();
+
 	VSG::scene->update_dirty_instances(); //update scene stuff
 
 	VSG::scene->render_probes();
@@ -175,6 +177,13 @@ void VisualServerRaster::finish() {
 
 int VisualServerRaster::get_render_info(RenderInfo p_info) {
 
+	switch (p_info) {
+		case INFO_OCCLUDERS_IN_FRAME:
+		case INFO_OCCLUDED_OBJECTS_IN_FRAME: return VSG::scene->get_render_info(p_info);
+		default: {
+		}
+	}
+
 	return VSG::storage->get_render_info(p_info);
 }
 
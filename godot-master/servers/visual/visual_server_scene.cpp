@@ -31,6 +31,8 @@
 #include "visual_server_scene.h"
 
 #include "core/os/os.h"
+#include "core/project_settings.h"
+#include "core/sort_array.h"
 #include "visual_server_globals.h"
 #include "visual_server_raster.h"
 
@@ -137,6 +139,7 @@ void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance
 		if (geom->can_cast_shadows) {
 
 			light->shadow_dirty = true;
+			light->shadow_casters_dirty = true;
 		}
 		geom->lighting_dirty = true;
 
@@ -219,6 +222,7 @@ void VisualServerScene::_instance_unpair(void *p_self, OctreeElementID, Instance
 
 		if (geom->can_cast_shadows) {
 			light->shadow_dirty = true;
+			light->shadow_casters_dirty = true;
 		}
 		geom->lighting_dirty = true;
 
@@ -361,6 +365,7 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 
 		if (scenario && instance->octree_id) {
 			scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
+			scenario->cull_arrays.remove(instance);
 			instance->octree_id = 0;
 		}
 
@@ -518,6 +523,7 @@ void VisualServerScene::instance_set_scenario(RID p_instance, RID p_scenario) {
 
 		if (instance->octree_id) {
 			instance->scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
+			instance->scenario->cull_arrays.remove(instance);
 			instance->octree_id = 0;
 		}
 
@@ -606,6 +612,10 @@ void VisualServerScene::instance_set_layer_mask(RID p_instance, uint32_t p_mask)
 	ERR_FAIL_COND(!instance);
 
 	instance->layer_mask = p_mask;
+
+	if (instance->scenario && instance->cull_index >= 0) {
+		instance->scenario->cull_arrays.update(instance);
+	}
 }
 void VisualServerScene::instance_set_transform(RID p_instance, const Transform &p_transform) {
 
@@ -884,6 +894,7 @@ void VisualServerScene::instance_geometry_set_flag(RID p_instance, VS::InstanceF
 			if (instance->octree_id != 0) {
 				//remove from octree, it needs to be re-paired
 				instance->scenario->octree.erase(instance->octree_id);
+				instance->scenario->cull_arrays.remove(instance);
 				instance->octree_id = 0;
 				_instance_queue_update(instance, true, true);
 			}
@@ -918,11 +929,87 @@ void VisualServerScene::instance_geometry_set_material_override(RID p_instance,
 	_instance_queue_update(instance, false, true);
 }
 
+void VisualServerScene::instance_geometry_set_occluder_box(RID p_instance, const AABB &p_box) {
+
+	Instance *instance = instance_owner.getornull(p_instance);
+	ERR_FAIL_COND(!instance);
+
+	instance->occluder_box = p_box;
+	instance->occluder = !p_box.has_no_area(); // a flat or empty box hides nothing
+}
+
 void VisualServerScene::instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin) {
 }
 void VisualServerScene::instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance) {
 }
 
+void VisualServerScene::InstanceCullArrays::add(Instance *p_instance) {
+
+	ERR_FAIL_COND(p_instance->cull_index >= 0);
+
+	p_instance->cull_index = instances.size();
+	instances.push_back(p_instance);
+	center_x.push_back(0);
+	center_y.push_back(0);
+	center_z.push_back(0);
+	extent_x.push_back(0);
+	extent_y.push_back(0);
+	extent_z.push_back(0);
+	layer_mask.push_back(0);
+
+	update(p_instance);
+}
+
+void VisualServerScene::InstanceCullArrays::update(Instance *p_instance) {
+
+	int idx = p_instance->cull_index;
+	ERR_FAIL_INDEX(idx, instances.size());
+
+	const AABB &aabb = p_instance->transformed_aabb;
+	Vector3 extents = aabb.size * 0.5;
+	Vector3 center = aabb.position + extents;
+
+	center_x.write[idx] = center.x;
+	center_y.write[idx] = center.y;
+	center_z.write[idx] = center.z;
+	extent_x.write[idx] = extents.x;
+	extent_y.write[idx] = extents.y;
+	extent_z.write[idx] = extents.z;
+	layer_mask.write[idx] = p_instance->layer_mask;
+}
+
+void VisualServerScene::InstanceCullArrays::remove(Instance *p_instance) {
+
+	int idx = p_instance->cull_index;
+	ERR_FAIL_INDEX(idx, instances.size());
+
+	// move the last element into the freed slot
+	int last = instances.size() - 1;
+	if (idx != last) {
+		instances.write[idx] = instances[last];
+		center_x.write[idx] = center_x[last];
+		center_y.write[idx] = center_y[last];
+		center_z.write[idx] = center_z[last];
+		extent_x.write[idx] = extent_x[last];
+		extent_y.write[idx] = extent_y[last];
+		extent_z.write[idx] = extent_z[last];
+		layer_mask.write[idx] = layer_mask[last];
+		instances[idx]->cull_index = idx;
+	}
+
+	instances.resize(last);
+	center_x.resize(last);
+	center_y.resize(last);
+	center_z.resize(last);
+	extent_x.resize(last);
+	extent_y.resize(last);
+	extent_z.resize(last);
+	layer_mask.resize(last);
+
+	p_instance->cull_index = -1;
+	removed_version++;
+}
+
 void VisualServerScene::_update_instance(Instance *p_instance) {
 
 	p_instance->version++;
@@ -933,6 +1020,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 
 		VSG::scene_render->light_instance_set_transform(light->instance, p_instance->transform);
 		light->shadow_dirty = true;
+		light->shadow_casters_dirty = true;
 	}
 
 	if (p_instance->base_type == VS::INSTANCE_REFLECTION_PROBE) {
@@ -968,6 +1056,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
 				InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
 				light->shadow_dirty = true;
+				light->shadow_casters_dirty = true;
 			}
 		}
 
@@ -1014,6 +1103,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 
 		// not inside octree
 		p_instance->octree_id = p_instance->scenario->octree.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
+		p_instance->scenario->cull_arrays.add(p_instance);
 
 	} else {
 
@@ -1023,6 +1113,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 		*/
 
 		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
+		p_instance->scenario->cull_arrays.update(p_instance);
 	}
 }
 
@@ -1334,16 +1425,31 @@ void VisualServerScene::_update_instance_lightmap_captures(Instance *p_instance)
 	}
 }
 
-bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario) {
+void VisualServerScene::_light_instance_queue_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, Scenario *p_scenario) {
 
 	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
 
 	Transform light_transform = p_instance->transform;
 	light_transform.orthonormalize(); //scale does not count on lights
 
-	bool animated_material_found = false;
+	ShadowCullLight shadow_light;
+	shadow_light.instance = p_instance;
+	shadow_light.first_pass = shadow_cull_passes.size();
+	shadow_light.pass_count = 0;
+	shadow_light.animated_material_found = false;
+
+	ShadowCullPass pass;
+	pass.light = p_instance;
+	pass.light_transform = light_transform;
+	pass.directional = false;
+	pass.cached = false;
+	pass.results = NULL;
+	pass.result_count = 0;
+	pass.shadow_range = 0;
+
+	VS::LightType light_type = VSG::storage->light_get_type(p_instance->base);
 
-	switch (VSG::storage->light_get_type(p_instance->base)) {
+	switch (light_type) {
 
 		case VS::LIGHT_DIRECTIONAL: {
 
@@ -1376,7 +1482,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 					}
 
 					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-						animated_material_found = true;
+						shadow_light.animated_material_found = true;
 					}
 
 					float max, min;
@@ -1425,8 +1531,6 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 			for (int i = 0; i < splits; i++) {
 
-				RENDER_TIMESTAMP("Culling Directional Light split" + itos(i));
-
 				// setup a camera matrix for that range!
 				CameraMatrix camera_matrix;
 
@@ -1547,118 +1651,64 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 				//now that we now all ranges, we can proceed to make the light frustum planes, for culling octree
 
-				Vector<Plane> light_frustum_planes;
-				light_frustum_planes.resize(6);
-
+				pass.pass = i;
+				pass.directional = true;
+				pass.plane_count = 6;
 				//right/left
-				light_frustum_planes.write[0] = Plane(x_vec, x_max);
-				light_frustum_planes.write[1] = Plane(-x_vec, -x_min);
+				pass.planes[0] = Plane(x_vec, x_max);
+				pass.planes[1] = Plane(-x_vec, -x_min);
 				//top/bottom
-				light_frustum_planes.write[2] = Plane(y_vec, y_max);
-				light_frustum_planes.write[3] = Plane(-y_vec, -y_min);
+				pass.planes[2] = Plane(y_vec, y_max);
+				pass.planes[3] = Plane(-y_vec, -y_min);
 				//near/far
-				light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
-				light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
-
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-
-				// a pre pass will need to be needed to determine the actual z-near to be used
-
-				Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
-
-				for (int j = 0; j < cull_count; j++) {
-
-					float min, max;
-					Instance *instance = instance_shadow_cull_result[j];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						cull_count--;
-						SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-						j--;
-						continue;
-					}
-
-					instance->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-					if (max > z_max)
-						z_max = max;
-				}
-
-				{
-
-					CameraMatrix ortho_camera;
-					real_t half_x = (x_max_cam - x_min_cam) * 0.5;
-					real_t half_y = (y_max_cam - y_min_cam) * 0.5;
-
-					ortho_camera.set_orthogonal(-half_x, half_x, -half_y, half_y, 0, (z_max - z_min_cam));
-
-					Transform ortho_transform;
-					ortho_transform.basis = transform.basis;
-					ortho_transform.origin = x_vec * (x_min_cam + half_x) + y_vec * (y_min_cam + half_y) + z_vec * z_max;
-
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, 0, distances[i + 1], i, bias_scale);
-				}
-
-				VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+				pass.planes[4] = Plane(z_vec, z_max + 1e6);
+				pass.planes[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
+
+				pass.depth_plane = Plane(light_transform.origin, -light_transform.basis.get_axis(2));
+				pass.x_min_cam = x_min_cam;
+				pass.x_max_cam = x_max_cam;
+				pass.y_min_cam = y_min_cam;
+				pass.y_max_cam = y_max_cam;
+				pass.z_min_cam = z_min_cam;
+				pass.z_max = z_max;
+				pass.split_distance = distances[i + 1];
+				pass.bias_scale = bias_scale;
+
+				shadow_cull_passes.push_back(pass);
 			}
 
 		} break;
 		case VS::LIGHT_OMNI: {
 
 			VS::LightOmniShadowMode shadow_mode = VSG::storage->light_omni_get_shadow_mode(p_instance->base);
+			float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
+			pass.shadow_range = radius;
 
 			if (shadow_mode == VS::LIGHT_OMNI_SHADOW_DUAL_PARABOLOID || !VSG::scene_render->light_instances_can_render_shadow_cube()) {
 
 				for (int i = 0; i < 2; i++) {
 
-					//using this one ensures that raster deferred will have it
-					RENDER_TIMESTAMP("Culling Shadow Paraboloid" + itos(i));
-
-					float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
-
 					float z = i == 0 ? -1 : 1;
-					Vector<Plane> planes;
-					planes.resize(5);
-					planes.write[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
-					planes.write[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
-					planes.write[2] = light_transform.xform(Plane(Vector3(-1, 0, z).normalized(), radius));
-					planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
-					planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
-
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-					Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
-
-					for (int j = 0; j < cull_count; j++) {
-
-						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-							cull_count--;
-							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-							j--;
-						} else {
-							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-								animated_material_found = true;
-							}
-
-							instance->depth = near_plane.distance_to(instance->transform.origin);
-							instance->depth_layer = 0;
-						}
-					}
-
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, i);
-					VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					pass.pass = i;
+					pass.plane_count = 5;
+					pass.planes[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
+					pass.planes[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
+					pass.planes[2] = light_transform.xform(Plane(Vector3(-1, 0, z).normalized(), radius));
+					pass.planes[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
+					pass.planes[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
+					pass.depth_plane = Plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
+					pass.shadow_projection = CameraMatrix();
+					pass.shadow_transform = light_transform;
+
+					shadow_cull_passes.push_back(pass);
 				}
 			} else { //shadow cube
 
-				float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
 				CameraMatrix cm;
 				cm.set_perspective(90, 1, 0.01, radius);
 
 				for (int i = 0; i < 6; i++) {
 
-					RENDER_TIMESTAMP("Culling Shadow Cube side" + itos(i));
-					//using this one ensures that raster deferred will have it
-
 					static const Vector3 view_normals[6] = {
 						Vector3(+1, 0, 0),
 						Vector3(-1, 0, 0),
@@ -1680,38 +1730,22 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 					Vector<Plane> planes = cm.get_projection_planes(xform);
 
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-
-					Plane near_plane(xform.origin, -xform.basis.get_axis(2));
-					for (int j = 0; j < cull_count; j++) {
-
-						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-							cull_count--;
-							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-							j--;
-						} else {
-							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-								animated_material_found = true;
-							}
-							instance->depth = near_plane.distance_to(instance->transform.origin);
-							instance->depth_layer = 0;
-						}
+					pass.pass = i;
+					pass.plane_count = MIN(planes.size(), 6);
+					for (int j = 0; j < pass.plane_count; j++) {
+						pass.planes[j] = planes[j];
 					}
+					pass.depth_plane = Plane(xform.origin, -xform.basis.get_axis(2));
+					pass.shadow_projection = cm;
+					pass.shadow_transform = xform;
 
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i);
-					VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					shadow_cull_passes.push_back(pass);
 				}
-
-				//restore the regular DP matrix
-				VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, 0);
 			}
 
 		} break;
 		case VS::LIGHT_SPOT: {
 
-			RENDER_TIMESTAMP("Culling Spot Light");
-
 			float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
 			float angle = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_SPOT_ANGLE);
 
@@ -1719,29 +1753,212 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
 			Vector<Plane> planes = cm.get_projection_planes(light_transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
-			Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
+			pass.pass = 0;
+			pass.plane_count = MIN(planes.size(), 6);
+			for (int j = 0; j < pass.plane_count; j++) {
+				pass.planes[j] = planes[j];
+			}
+			pass.depth_plane = Plane(light_transform.origin, -light_transform.basis.get_axis(2));
+			pass.shadow_projection = cm;
+			pass.shadow_transform = light_transform;
+			pass.shadow_range = radius;
+
+			shadow_cull_passes.push_back(pass);
+
+		} break;
+	}
+
+	shadow_light.pass_count = shadow_cull_passes.size() - shadow_light.first_pass;
+
+	if (light_type != VS::LIGHT_DIRECTIONAL) {
+
+		// positional casters only depend on the light and its paired geometry,
+		// so the previous cull is still good if none of them changed
+		bool cached = !light->shadow_casters_dirty && light->shadow_caster_pass_count == shadow_light.pass_count && light->shadow_caster_removed_version == p_scenario->cull_arrays.removed_version;
+
+		ShadowCullPass *passes = shadow_cull_passes.ptrw() + shadow_light.first_pass;
+
+		for (int i = 0; i < shadow_light.pass_count; i++) {
+
+			passes[i].cached = cached;
+			if (cached) {
+				passes[i].result_count = light->shadow_caster_counts[i];
+			} else {
+				light->shadow_casters[i].resize(light->geometries.size());
+			}
+			passes[i].results = light->shadow_casters[i].ptrw();
+		}
+
+		light->shadow_caster_pass_count = shadow_light.pass_count;
+		light->shadow_caster_removed_version = p_scenario->cull_arrays.removed_version;
+		light->shadow_casters_dirty = false;
+	}
+
+	shadow_cull_lights.push_back(shadow_light);
+}
+
+void VisualServerScene::_shadow_cull_pass(uint32_t p_pass, ShadowCullPass *p_passes) {
+
+	ShadowCullPass &pass = p_passes[p_pass];
+
+	if (pass.cached) {
+		return;
+	}
+
+	if (pass.directional) {
+
+		const InstanceCullArrays &arrays = pass.light->scenario->cull_arrays;
+		pass.result_count = _cull_convex_range(arrays, 0, arrays.size(), pass.planes, pass.plane_count, 0xFFFFFFFF, pass.results);
+		return;
+	}
+
+	// positional lights can only shadow geometry they are paired with
+	InstanceLightData *light = static_cast<InstanceLightData *>(pass.light->base_data);
+	int count = 0;
+
+	for (const List<InstanceLightData::PairInfo>::Element *E = light->geometries.front(); E; E = E->next()) {
+
+		Instance *instance = E->get().geometry;
+		const AABB &aabb = instance->transformed_aabb;
+		Vector3 extents = aabb.size * 0.5;
+		Vector3 center = aabb.position + extents;
+
+		bool inside = true;
+		for (int j = 0; j < pass.plane_count; j++) {
+			const Plane &p = pass.planes[j];
+			float radius = Math::abs(p.normal.x) * extents.x + Math::abs(p.normal.y) * extents.y + Math::abs(p.normal.z) * extents.z;
+			if (p.distance_to(center) > radius) {
+				inside = false;
+				break;
+			}
+		}
+
+		if (inside) {
+			pass.results[count++] = instance;
+		}
+	}
+
+	pass.result_count = count;
+	light->shadow_caster_counts[pass.pass] = count;
+}
+
+void VisualServerScene::_light_instances_cull_shadows(Scenario *p_scenario) {
+
+	int pass_count = shadow_cull_passes.size();
+	if (pass_count == 0) {
+		return;
+	}
+
+	ShadowCullPass *passes = shadow_cull_passes.ptrw();
+
+	// directional splits can hit anything in the scenario, each gets its own buffer
+	int directional_count = 0;
+	for (int i = 0; i < pass_count; i++) {
+		if (passes[i].directional) {
+			directional_count++;
+		}
+	}
+
+	if (directional_shadow_casters.size() < directional_count) {
+		directional_shadow_casters.resize(directional_count);
+	}
+
+	for (int i = 0, j = 0; i < pass_count; i++) {
+		if (passes[i].directional) {
+			Vector<Instance *> &buffer = directional_shadow_casters.write[j++];
+			buffer.resize(p_scenario->cull_arrays.size());
+			passes[i].results = buffer.ptrw();
+		}
+	}
+
+	if (pass_count > 1) {
+		cull_thread_pool.do_work(pass_count, this, &VisualServerScene::_shadow_cull_pass, passes);
+	} else {
+		_shadow_cull_pass(0, passes);
+	}
+}
+
+bool VisualServerScene::_light_instance_render_shadow(const ShadowCullLight &p_light, RID p_shadow_atlas) {
+
+	InstanceLightData *light = static_cast<InstanceLightData *>(p_light.instance->base_data);
+	bool animated_material_found = p_light.animated_material_found;
+
+	for (int i = 0; i < p_light.pass_count; i++) {
+
+		const ShadowCullPass &pass = shadow_cull_passes[p_light.first_pass + i];
+
+		// filtered in place, for cached passes this only reorders the cache
+		Instance **cull_result = pass.results;
+		int cull_count = pass.result_count;
+
+		if (pass.directional) {
+
+			Vector3 z_vec = pass.light_transform.basis.get_axis(Vector3::AXIS_Z).normalized();
+			float z_max = pass.z_max;
+
+			for (int j = 0; j < cull_count; j++) {
+
+				float min, max;
+				Instance *instance = cull_result[j];
+				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+					cull_count--;
+					SWAP(cull_result[j], cull_result[cull_count]);
+					j--;
+					continue;
+				}
+
+				instance->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
+				instance->depth = pass.depth_plane.distance_to(instance->transform.origin);
+				instance->depth_layer = 0;
+				if (max > z_max)
+					z_max = max;
+			}
+
+			CameraMatrix ortho_camera;
+			real_t half_x = (pass.x_max_cam - pass.x_min_cam) * 0.5;
+			real_t half_y = (pass.y_max_cam - pass.y_min_cam) * 0.5;
+
+			ortho_camera.set_orthogonal(-half_x, half_x, -half_y, half_y, 0, (z_max - pass.z_min_cam));
+
+			Vector3 x_vec = pass.light_transform.basis.get_axis(Vector3::AXIS_X).normalized();
+			Vector3 y_vec = pass.light_transform.basis.get_axis(Vector3::AXIS_Y).normalized();
+
+			Transform ortho_transform;
+			ortho_transform.basis = pass.light_transform.basis;
+			ortho_transform.origin = x_vec * (pass.x_min_cam + half_x) + y_vec * (pass.y_min_cam + half_y) + z_vec * z_max;
+
+			VSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, 0, pass.split_distance, pass.pass, pass.bias_scale);
+
+		} else {
+
 			for (int j = 0; j < cull_count; j++) {
 
-				Instance *instance = instance_shadow_cull_result[j];
+				Instance *instance = cull_result[j];
 				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
 					cull_count--;
-					SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
+					SWAP(cull_result[j], cull_result[cull_count]);
 					j--;
 				} else {
 					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
 						animated_material_found = true;
 					}
-					instance->depth = near_plane.distance_to(instance->transform.origin);
+
+					instance->depth = pass.depth_plane.distance_to(instance->transform.origin);
 					instance->depth_layer = 0;
 				}
 			}
 
-			VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0);
-			VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+			VSG::scene_render->light_instance_set_shadow_transform(light->instance, pass.shadow_projection, pass.shadow_transform, pass.shadow_range, 0, pass.pass);
+		}
 
-		} break;
+		VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, pass.pass, (RasterizerScene::InstanceBase **)cull_result, cull_count);
+	}
+
+	if (p_light.pass_count == 6) {
+		//shadow cube, restore the regular DP matrix
+		const ShadowCullPass &pass = shadow_cull_passes[p_light.first_pass];
+		VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), pass.light_transform, pass.shadow_range, 0, 0);
 	}
 
 	return animated_material_found;
@@ -1882,6 +2099,184 @@ void VisualServerScene::render_camera(RID p_render_buffers, Ref<ARVRInterface> &
 	_render_scene(p_render_buffers, cam_transform, camera_matrix, false, camera->env, camera->effects, p_scenario, p_shadow_atlas, RID(), -1);
 };
 
+int VisualServerScene::_cull_convex_range(const InstanceCullArrays &p_arrays, int p_from, int p_to, const Plane *p_planes, int p_plane_count, uint32_t p_layer_mask, Instance **r_result) {
+
+	const real_t *cx = p_arrays.center_x.ptr();
+	const real_t *cy = p_arrays.center_y.ptr();
+	const real_t *cz = p_arrays.center_z.ptr();
+	const real_t *ex = p_arrays.extent_x.ptr();
+	const real_t *ey = p_arrays.extent_y.ptr();
+	const real_t *ez = p_arrays.extent_z.ptr();
+	const uint32_t *masks = p_arrays.layer_mask.ptr();
+	Instance *const *instances = p_arrays.instances.ptr();
+
+	int count = 0;
+
+	for (int block = p_from; block < p_to; block += CULL_CHUNK_SIZE) {
+
+		int from = block;
+		int to = MIN(block + CULL_CHUNK_SIZE, p_to);
+
+		// first pass, branchless so the compiler can vectorize it
+		uint8_t visible[CULL_CHUNK_SIZE];
+
+		for (int i = from; i < to; i++) {
+			visible[i - from] = (masks[i] & p_layer_mask) != 0;
+		}
+
+		for (int j = 0; j < p_plane_count; j++) {
+
+			const Plane &p = p_planes[j];
+			real_t nx = p.normal.x;
+			real_t ny = p.normal.y;
+			real_t nz = p.normal.z;
+			real_t ax = Math::abs(nx);
+			real_t ay = Math::abs(ny);
+			real_t az = Math::abs(nz);
+			real_t d = p.d;
+
+			for (int i = from; i < to; i++) {
+				// outside if the box is entirely over the plane
+				real_t dist = nx * cx[i] + ny * cy[i] + nz * cz[i] - d;
+				real_t radius = ax * ex[i] + ay * ey[i] + az * ez[i];
+				visible[i - from] &= dist <= radius;
+			}
+		}
+
+		// second pass, compact the survivors
+		for (int i = from; i < to; i++) {
+			if (visible[i - from]) {
+				r_result[count++] = instances[i];
+			}
+		}
+	}
+
+	return count;
+}
+
+void VisualServerScene::_cull_frustum_chunk(uint32_t p_chunk, FrustumCullData *p_data) {
+
+	int from = p_chunk * CULL_CHUNK_SIZE;
+	int to = MIN(from + CULL_CHUNK_SIZE, p_data->arrays->size());
+
+	// each chunk writes to its own slice of the result buffer
+	p_data->counts[p_chunk] = _cull_convex_range(*p_data->arrays, from, to, p_data->planes, p_data->plane_count, p_data->layer_mask, p_data->results + from);
+}
+
+int VisualServerScene::_cull_frustum(Scenario *p_scenario, const Vector<Plane> &p_planes, uint32_t p_layer_mask, Instance **r_result, int p_result_max) {
+
+	const InstanceCullArrays &arrays = p_scenario->cull_arrays;
+	int chunk_count = (arrays.size() + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+	if (chunk_count == 0) {
+		return 0;
+	}
+
+	if (cull_chunk_results.size() < arrays.size()) {
+		cull_chunk_results.resize(arrays.size());
+	}
+	cull_chunk_counts.resize(chunk_count);
+
+	FrustumCullData data;
+	data.arrays = &arrays;
+	data.planes = p_planes.ptr();
+	data.plane_count = p_planes.size();
+	data.layer_mask = p_layer_mask;
+	data.results = cull_chunk_results.ptrw();
+	data.counts = cull_chunk_counts.ptrw();
+
+	if (chunk_count > 1) {
+		cull_thread_pool.do_work(chunk_count, this, &VisualServerScene::_cull_frustum_chunk, &data);
+	} else {
+		_cull_frustum_chunk(0, &data);
+	}
+
+	// merge the chunks in order, so results don't depend on thread scheduling
+	int count = 0;
+	for (int i = 0; i < chunk_count && count < p_result_max; i++) {
+
+		Instance *const *chunk = data.results + i * CULL_CHUNK_SIZE;
+		int chunk_result_count = MIN((int)data.counts[i], p_result_max - count);
+		for (int j = 0; j < chunk_result_count; j++) {
+			r_result[count++] = chunk[j];
+		}
+	}
+
+	return count;
+}
+
+int VisualServerScene::_cull_occlusion(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, uint32_t p_layer_mask, Instance **r_result, int p_result_count) {
+
+	if (occlusion_max_occluders <= 0) {
+		return p_result_count;
+	}
+
+	Plane near_plane(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2).normalized());
+	int occluder_count = 0;
+
+	for (int i = 0; i < p_result_count && occluder_count < MAX_OCCLUDERS_CULLED; i++) {
+
+		Instance *ins = r_result[i];
+
+		if (!ins->occluder || !ins->visible || !(p_layer_mask & ins->layer_mask) || !((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK)) {
+			continue;
+		}
+
+		if (ins->cast_shadows == VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+			continue; // not drawn, so it can't hide anything
+		}
+
+		AABB box = ins->transform.xform(ins->occluder_box);
+		if (box.has_point(p_cam_transform.origin)) {
+			continue; // camera is inside, the box would hide everything
+		}
+
+		OccluderSort &occluder = occluder_cull_result[occluder_count++];
+		occluder.instance = ins;
+		occluder.depth = near_plane.distance_to(box.position + box.size * 0.5);
+	}
+
+	if (occluder_count == 0) {
+		return p_result_count;
+	}
+
+	// nearest occluders hide the most, keep those when over the limit
+	SortArray<OccluderSort> sorter;
+	sorter.sort(occluder_cull_result, occluder_count);
+	occluder_count = MIN(occluder_count, occlusion_max_occluders);
+
+	int width = occlusion_buffer_width;
+	int height = CLAMP(int(width / p_cam_projection.get_aspect()), 1, width * 4);
+	occlusion_buffer.resize(width, height);
+
+	occlusion_buffer.begin(p_cam_transform, p_cam_projection);
+	for (int i = 0; i < occluder_count; i++) {
+		Instance *ins = occluder_cull_result[i].instance;
+		occlusion_buffer.rasterize_box(ins->transform, ins->occluder_box);
+	}
+	occlusion_buffer.end();
+
+	int count = p_result_count;
+	for (int i = 0; i < count; i++) {
+
+		Instance *ins = r_result[i];
+
+		if (!((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK)) {
+			continue; // lights and probes may still affect visible geometry
+		}
+
+		if (occlusion_buffer.is_occluded(ins->transformed_aabb)) {
+			count--;
+			SWAP(r_result[i], r_result[count]);
+			i--;
+		}
+	}
+
+	occlusion_stats.occluders += occluder_count;
+	occlusion_stats.occluded_objects += p_result_count - count;
+
+	return count;
+}
+
 void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, RID p_force_camera_effects, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_using_shadows) {
 	// Note, in stereo rendering:
 	// - p_cam_transform will be a transform in the middle of our two eyes
@@ -1904,7 +2299,7 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	instance_cull_count = _cull_frustum(scenario, planes, camera_layer_mask, instance_cull_result, MAX_INSTANCE_CULL);
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -1919,8 +2314,10 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	print_line("OTP: "+itos(p_scenario->octree.get_pair_count()));
 	*/
 
-	/* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
-	//removed, will replace with culling
+	/* STEP 3 - OCCLUSION CULLING */
+
+	RENDER_TIMESTAMP("Occlusion Culling");
+	instance_cull_count = _cull_occlusion(p_cam_transform, p_cam_projection, camera_layer_mask, instance_cull_result, instance_cull_count);
 
 	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
 
@@ -2078,6 +2475,9 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	RID *directional_light_ptr = &light_instance_cull_result[light_cull_count];
 	directional_light_count = 0;
 
+	shadow_cull_passes.resize(0);
+	shadow_cull_lights.resize(0);
+
 	// directional lights
 	{
 
@@ -2110,14 +2510,12 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 		for (int i = 0; i < directional_shadow_count; i++) {
 
-			RENDER_TIMESTAMP(">Rendering Directional Light " + itos(i));
-
-			_light_instance_update_shadow(lights_with_shadow[i], p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
-
-			RENDER_TIMESTAMP("<Rendering Directional Light " + itos(i));
+			_light_instance_queue_shadow(lights_with_shadow[i], p_cam_transform, p_cam_projection, p_cam_orthogonal, scenario);
 		}
 	}
 
+	int directional_shadow_lights = shadow_cull_lights.size();
+
 	if (p_using_shadows) { //setup shadow maps
 
 		//SortArray<Instance*,_InstanceLightsort> sorter;
@@ -2213,12 +2611,29 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 			if (redraw) {
 				//must redraw!
-				RENDER_TIMESTAMP(">Rendering Light " + itos(i));
-				light->shadow_dirty = _light_instance_update_shadow(ins, p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
-				RENDER_TIMESTAMP("<Rendering Light " + itos(i));
+				_light_instance_queue_shadow(ins, p_cam_transform, p_cam_projection, p_cam_orthogonal, scenario);
 			}
 		}
 	}
+
+	RENDER_TIMESTAMP("Culling Shadow Casters");
+	_light_instances_cull_shadows(scenario);
+
+	for (int i = 0; i < shadow_cull_lights.size(); i++) {
+
+		const ShadowCullLight &shadow_light = shadow_cull_lights[i];
+
+		if (i < directional_shadow_lights) {
+			RENDER_TIMESTAMP(">Rendering Directional Light " + itos(i));
+			_light_instance_render_shadow(shadow_light, p_shadow_atlas);
+			RENDER_TIMESTAMP("<Rendering Directional Light " + itos(i));
+		} else {
+			RENDER_TIMESTAMP(">Rendering Light " + itos(i - directional_shadow_lights));
+			InstanceLightData *light = static_cast<InstanceLightData *>(shadow_light.instance->base_data);
+			light->shadow_dirty = _light_instance_render_shadow(shadow_light, p_shadow_atlas);
+			RENDER_TIMESTAMP("<Rendering Light " + itos(i - directional_shadow_lights));
+		}
+	}
 }
 
 void VisualServerScene::_render_scene(RID p_render_buffers, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, RID p_force_camera_effects, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {
@@ -2749,6 +3164,7 @@ void VisualServerScene::_update_dirty_instance(Instance *p_instance) {
 				for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
 					InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
 					light->shadow_dirty = true;
+					light->shadow_casters_dirty = true;
 				}
 
 				geom->can_cast_shadows = can_cast_shadows;
@@ -2772,13 +3188,112 @@ void VisualServerScene::_update_dirty_instance(Instance *p_instance) {
 	p_instance->update_dependencies = false;
 }
 
+bool VisualServerScene::_instance_can_update_transform_only(const Instance *p_instance) const {
+
+	if (p_instance->update_aabb || p_instance->update_dependencies) {
+		return false;
+	}
+
+	if (!((1 << p_instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || p_instance->base_type == VS::INSTANCE_PARTICLES) {
+		return false; // these need the storage or other instances notified on move
+	}
+
+	return p_instance->scenario && p_instance->octree_id != 0 && !p_instance->aabb.has_no_surface();
+}
+
+void VisualServerScene::_update_instance_transform_chunk(uint32_t p_chunk, TransformUpdateData *p_data) {
+
+	int from = p_chunk * TRANSFORM_UPDATE_CHUNK_SIZE;
+	int to = MIN(from + TRANSFORM_UPDATE_CHUNK_SIZE, p_data->count);
+
+	// only touches the instance itself, so chunks are independent
+	for (int i = from; i < to; i++) {
+
+		Instance *instance = p_data->instances[i];
+
+		instance->version++;
+		instance->mirror = instance->transform.basis.determinant() < 0.0;
+
+		AABB new_aabb = instance->transform.xform(instance->aabb);
+		p_data->moved[i] = new_aabb != instance->transformed_aabb;
+		instance->transformed_aabb = new_aabb;
+	}
+}
+
+void VisualServerScene::_update_instance_transforms() {
+
+	int count = transform_update_instances.size();
+	if (count == 0) {
+		return;
+	}
+
+	transform_update_moved.resize(count);
+
+	TransformUpdateData data;
+	data.instances = transform_update_instances.ptrw();
+	data.moved = transform_update_moved.ptrw();
+	data.count = count;
+
+	int chunk_count = (count + TRANSFORM_UPDATE_CHUNK_SIZE - 1) / TRANSFORM_UPDATE_CHUNK_SIZE;
+
+	if (chunk_count > 1) {
+		cull_thread_pool.do_work(chunk_count, this, &VisualServerScene::_update_instance_transform_chunk, &data);
+	} else {
+		_update_instance_transform_chunk(0, &data);
+	}
+
+	// what follows touches lights and the octree, which are shared
+	for (int i = 0; i < count; i++) {
+
+		Instance *instance = data.instances[i];
+		InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(instance->base_data);
+
+		if (geom->can_cast_shadows) {
+			for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
+				InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+				light->shadow_dirty = true;
+				light->shadow_casters_dirty = true;
+			}
+		}
+
+		if (data.moved[i]) {
+			// same bounds keep the same octants and pairs, nothing to move
+			instance->scenario->octree.move(instance->octree_id, instance->transformed_aabb);
+			instance->scenario->cull_arrays.update(instance);
+		}
+
+		// after the move, so captures see the pairs it made or broke
+		if (!instance->lightmap_capture && geom->lightmap_captures.size()) {
+			_update_instance_lightmap_captures(instance);
+		} else if (!instance->lightmap_capture_data.empty()) {
+			instance->lightmap_capture_data.resize(0); //not in use, clear capture data
+		}
+	}
+
+	transform_update_instances.resize(0);
+}
+
 void VisualServerScene::update_dirty_instances() {
 
 	VSG::storage->update_dirty_resources();
 
+	// octree moves in the batched sweep can pair and queue more instances,
+	// keep going until nothing is left for this frame
 	while (_instance_update_list.first()) {
 
-		_update_dirty_instance(_instance_update_list.first()->self());
+		while (_instance_update_list.first()) {
+
+			Instance *instance = _instance_update_list.first()->self();
+
+			if (_instance_can_update_transform_only(instance)) {
+				_instance_update_list.remove(&instance->update_item);
+				transform_update_instances.push_back(instance);
+			} else {
+				_update_dirty_instance(instance);
+			}
+		}
+
+		_update_instance_transforms();
 	}
 }
 
@@ -2829,11 +3344,39 @@ bool VisualServerScene::free(RID p_rid) {
 
 VisualServerScene *VisualServerScene::singleton = NULL;
 
+void VisualServerScene::occlusion_begin_frame() {
+
+	occlusion_last_frame_stats = occlusion_stats;
+	occlusion_stats.occluders = 0;
+	occlusion_stats.occluded_objects = 0;
+}
+
+int VisualServerScene::get_render_info(VS::RenderInfo p_info) const {
+
+	switch (p_info) {
+		case VS::INFO_OCCLUDERS_IN_FRAME: return occlusion_last_frame_stats.occluders;
+		case VS::INFO_OCCLUDED_OBJECTS_IN_FRAME: return occlusion_last_frame_stats.occluded_objects;
+		default: {
+		}
+	}
+
+	return 0;
+}
+
 VisualServerScene::VisualServerScene() {
 
 	render_pass = 1;
 	singleton = this;
+	cull_thread_pool.init();
+
+	occlusion_max_occluders = GLOBAL_GET("rendering/occlusion_culling/max_occluders");
+	occlusion_buffer_width = MAX(16, int(GLOBAL_GET("rendering/occlusion_culling/buffer_width")));
+	occlusion_stats.occluders = 0;
+	occlusion_stats.occluded_objects = 0;
+	occlusion_last_frame_stats = occlusion_stats;
 }
 
 VisualServerScene::~VisualServerScene() {
+
+	cull_thread_pool.finish();
 }
@@ -32,6 +32,7 @@
 #define VISUALSERVERSCENE_H
 
 #include "servers/visual/rasterizer.h"
+#include "servers/visual/visual_server_occlusion.h"
 
 #include "core/math/geometry.h"
 #include "core/math/octree.h"
@@ -39,6 +40,7 @@
 #include "core/os/thread.h"
 #include "core/rid_owner.h"
 #include "core/self_list.h"
+#include "core/thread_work_pool.h"
 #include "servers/arvr/arvr_interface.h"
 
 class VisualServerScene {
@@ -51,6 +53,9 @@ public:
 		MAX_GI_PROBES_CULLED = 4096,
 		MAX_ROOM_CULL = 32,
 		MAX_EXTERIOR_PORTALS = 128,
+		CULL_CHUNK_SIZE = 4096, // instances tested per work item when frustum culling
+		MAX_OCCLUDERS_CULLED = 1024,
+		TRANSFORM_UPDATE_CHUNK_SIZE = 1024, // moved instances handled per work item
 	};
 
 	uint64_t render_pass;
@@ -107,12 +112,32 @@ public:
 
 	struct Instance;
 
+	// flat copy of the instance bounds in a scenario, stored as separate arrays
+	// so frustum tests run over contiguous memory and can be vectorized
+	struct InstanceCullArrays {
+
+		Vector<Instance *> instances;
+		Vector<real_t> center_x, center_y, center_z;
+		Vector<real_t> extent_x, extent_y, extent_z;
+		Vector<uint32_t> layer_mask;
+		uint64_t removed_version; // increased when an instance leaves, so cached pointers can be dropped
+
+		_FORCE_INLINE_ int size() const { return instances.size(); }
+
+		void add(Instance *p_instance);
+		void update(Instance *p_instance);
+		void remove(Instance *p_instance);
+
+		InstanceCullArrays() { removed_version = 0; }
+	};
+
 	struct Scenario {
 
 		VS::ScenarioDebugMode debug;
 		RID self;
 
 		Octree<Instance, true> octree;
+		InstanceCullArrays cull_arrays;
 
 		List<Instance *> directional_lights;
 		RID environment;
@@ -151,6 +176,8 @@ public:
 		RID self;
 		//scenario stuff
 		OctreeElementID octree_id;
+		int cull_index; // index in the scenario cull arrays, -1 if not in them
+		bool occluder; // occluder_box has volume
 		Scenario *scenario;
 		SelfList<Instance> scenario_item;
 
@@ -162,7 +189,8 @@ public:
 
 		AABB *custom_aabb; // <Zylann> would using aabb directly with a bool be better?
 		float extra_margin;
-		uint32_t object_id;
+		AABB occluder_box; // local space, drawn into the occlusion buffer as a solid box
+		ObjectID object_id;
 
 		float lod_begin;
 		float lod_end;
@@ -196,6 +224,8 @@ public:
 				update_item(this) {
 
 			octree_id = 0;
+			cull_index = -1;
+			occluder = false;
 			scenario = NULL;
 
 			update_aabb = false;
@@ -295,6 +325,18 @@ public:
 
 		bool shadow_dirty;
 
+		// casters found by the last positional shadow cull, reused while
+		// neither the light nor any geometry around it has changed
+		enum {
+			MAX_SHADOW_PASSES = 6
+		};
+
+		Vector<Instance *> shadow_casters[MAX_SHADOW_PASSES];
+		int shadow_caster_counts[MAX_SHADOW_PASSES];
+		int shadow_caster_pass_count; // 0 when nothing is cached
+		uint64_t shadow_caster_removed_version;
+		bool shadow_casters_dirty;
+
 		List<PairInfo> geometries;
 
 		Instance *baked_light;
@@ -305,6 +347,10 @@ public:
 			D = NULL;
 			last_version = 0;
 			baked_light = NULL;
+
+			shadow_caster_pass_count = 0;
+			shadow_caster_removed_version = 0;
+			shadow_casters_dirty = true;
 		}
 	};
 
@@ -369,6 +415,48 @@ public:
 		}
 	};
 
+	struct FrustumCullData {
+
+		const InstanceCullArrays *arrays;
+		const Plane *planes;
+		int plane_count;
+		uint32_t layer_mask;
+		Instance **results; // CULL_CHUNK_SIZE slots per chunk
+		uint32_t *counts;
+	};
+
+	ThreadWorkPool cull_thread_pool;
+	Vector<Instance *> cull_chunk_results;
+	Vector<uint32_t> cull_chunk_counts;
+
+	static int _cull_convex_range(const InstanceCullArrays &p_arrays, int p_from, int p_to, const Plane *p_planes, int p_plane_count, uint32_t p_layer_mask, Instance **r_result);
+	void _cull_frustum_chunk(uint32_t p_chunk, FrustumCullData *p_data);
+	int _cull_frustum(Scenario *p_scenario, const Vector<Plane> &p_planes, uint32_t p_layer_mask, Instance **r_result, int p_result_max);
+
+	struct OccluderSort {
+
+		Instance *instance;
+		float depth;
+
+		_FORCE_INLINE_ bool operator<(const OccluderSort &p_sort) const { return depth < p_sort.depth; }
+	};
+
+	OcclusionBufferSW occlusion_buffer;
+	OccluderSort occluder_cull_result[MAX_OCCLUDERS_CULLED];
+	int occlusion_max_occluders;
+	int occlusion_buffer_width;
+
+	struct OcclusionStats {
+
+		int occluders;
+		int occluded_objects;
+	};
+
+	OcclusionStats occlusion_stats; // accumulated over the frame being drawn
+	OcclusionStats occlusion_last_frame_stats;
+
+	int _cull_occlusion(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, uint32_t p_layer_mask, Instance **r_result, int p_result_count);
+
 	int instance_cull_count;
 	Instance *instance_cull_result[MAX_INSTANCE_CULL];
 	Instance *instance_shadow_cull_result[MAX_INSTANCE_CULL]; //used for generating shadowmaps
@@ -410,6 +498,7 @@ public:
 	virtual void instance_geometry_set_flag(RID p_instance, VS::InstanceFlags p_flags, bool p_enabled);
 	virtual void instance_geometry_set_cast_shadows_setting(RID p_instance, VS::ShadowCastingSetting p_shadow_casting_setting);
 	virtual void instance_geometry_set_material_override(RID p_instance, RID p_material);
+	virtual void instance_geometry_set_occluder_box(RID p_instance, const AABB &p_box);
 
 	virtual void instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin);
 	virtual void instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance);
@@ -417,9 +506,67 @@ public:
 	_FORCE_INLINE_ void _update_instance(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_aabb(Instance *p_instance);
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);
+
+	// geometry that only changed transform is updated in bulk: bounds are
+	// computed in parallel, then the octree is touched once per instance
+	struct TransformUpdateData {
+
+		Instance **instances;
+		uint8_t *moved; // transformed bounds differ from the previous ones
+		int count;
+	};
+
+	Vector<Instance *> transform_update_instances;
+	Vector<uint8_t> transform_update_moved;
+
+	_FORCE_INLINE_ bool _instance_can_update_transform_only(const Instance *p_instance) const;
+	void _update_instance_transform_chunk(uint32_t p_chunk, TransformUpdateData *p_data);
+	void _update_instance_transforms();
 	_FORCE_INLINE_ void _update_instance_lightmap_captures(Instance *p_instance);
 
-	_FORCE_INLINE_ bool _light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
+	// shadow casters are culled for every queued pass at once on the worker
+	// pool, then each light's passes are rendered in order on this thread
+	struct ShadowCullPass {
+
+		Instance *light;
+		int pass;
+		Plane planes[6];
+		int plane_count;
+		bool directional; // culls the whole scenario instead of the light's paired geometry
+		bool cached; // results come from the light's caster cache, nothing to cull
+		Plane depth_plane; // casters are sorted by their distance to it
+		Transform light_transform;
+
+		Instance **results;
+		int result_count;
+
+		// positional lights
+		CameraMatrix shadow_projection;
+		Transform shadow_transform;
+		float shadow_range;
+
+		// directional splits, finished once casters are known
+		float x_min_cam, x_max_cam, y_min_cam, y_max_cam, z_min_cam, z_max;
+		float split_distance;
+		float bias_scale;
+	};
+
+	struct ShadowCullLight {
+
+		Instance *instance;
+		int first_pass;
+		int pass_count;
+		bool animated_material_found;
+	};
+
+	Vector<ShadowCullPass> shadow_cull_passes;
+	Vector<ShadowCullLight> shadow_cull_lights;
+	Vector<Vector<Instance *> > directional_shadow_casters;
+
+	void _shadow_cull_pass(uint32_t p_pass, ShadowCullPass *p_passes);
+	void _light_instance_queue_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, Scenario *p_scenario);
+	void _light_instances_cull_shadows(Scenario *p_scenario);
+	bool _light_instance_render_shadow(const ShadowCullLight &p_light, RID p_shadow_atlas);
 
 	bool _render_reflection_probe_step(Instance *p_instance, int p_step);
 	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, RID p_force_camera_effects, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_using_shadows = true);
@@ -432,6 +579,9 @@ public:
 
 	void render_probes();
 
+	void occlusion_begin_frame();
+	int get_render_info(VS::RenderInfo p_info) const;
+
 	bool free(RID p_rid);
 
 	VisualServerScene();
@@ -68,8 +68,8 @@ void VisualServerWrapMT::thread_loop() {
 	exit = false;
 	draw_thread_up = true;
 	while (!exit) {
-		// flush commands one by one, until exit is requested
-		command_queue.wait_and_flush_one();
+		// flush pending commands as they arrive, until exit is requested
+		command_queue.wait_and_flush();
 	}
 
 	command_queue.flush_all(); // flush all
@@ -93,6 +93,10 @@ void VisualServerWrapMT::sync() {
 
 void VisualServerWrapMT::draw(bool p_swap_buffers, double frame_step) {
 
+	uint64_t sync_count = command_queue.get_sync_count();
+	sync_calls_in_frame = sync_count - sync_count_at_draw;
+	sync_count_at_draw = sync_count;
+
 	if (create_thread) {
 
 		atomic_increment(&draw_pending);
@@ -179,6 +183,8 @@ VisualServerWrapMT::VisualServerWrapMT(VisualServer *p_contained, bool p_create_
 	create_thread = p_create_thread;
 	thread = NULL;
 	draw_pending = 0;
+	sync_count_at_draw = 0;
+	sync_calls_in_frame = 0;
 	draw_thread_up = false;
 	alloc_mutex = Mutex::create();
 	pool_max_size = GLOBAL_GET("memory/limits/multithreaded_server/rid_pool_prealloc");
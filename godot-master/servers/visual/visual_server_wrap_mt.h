@@ -52,6 +52,8 @@ class VisualServerWrapMT : public VisualServer {
 	bool create_thread;
 
 	uint64_t draw_pending;
+	uint64_t sync_count_at_draw;
+	int sync_calls_in_frame;
 	void thread_draw(bool p_swap_buffers, double frame_step);
 	void thread_flush();
 
@@ -498,6 +500,7 @@ public:
 	FUNC3(instance_geometry_set_flag, RID, InstanceFlags, bool)
 	FUNC2(instance_geometry_set_cast_shadows_setting, RID, ShadowCastingSetting)
 	FUNC2(instance_geometry_set_material_override, RID, RID)
+	FUNC2(instance_geometry_set_occluder_box, RID, const AABB &)
 
 	FUNC5(instance_geometry_set_draw_range, RID, float, float, float, float)
 	FUNC2(instance_geometry_set_as_instance_lod, RID, RID)
@@ -618,6 +621,8 @@ public:
 
 	//this passes directly to avoid stalling
 	virtual int get_render_info(RenderInfo p_info) {
+		if (p_info == INFO_SYNC_CALLS_IN_FRAME)
+			return sync_calls_in_frame;
 		return visual_server->get_render_info(p_info);
 	}
 
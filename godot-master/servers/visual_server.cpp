@@ -1857,6 +1857,7 @@ void VisualServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("instance_geometry_set_flag", "instance", "flag", "enabled"), &VisualServer::instance_geometry_set_flag);
 	ClassDB::bind_method(D_METHOD("instance_geometry_set_cast_shadows_setting", "instance", "shadow_casting_setting"), &VisualServer::instance_geometry_set_cast_shadows_setting);
 	ClassDB::bind_method(D_METHOD("instance_geometry_set_material_override", "instance", "material"), &VisualServer::instance_geometry_set_material_override);
+	ClassDB::bind_method(D_METHOD("instance_geometry_set_occluder_box", "instance", "box"), &VisualServer::instance_geometry_set_occluder_box);
 	ClassDB::bind_method(D_METHOD("instance_geometry_set_draw_range", "instance", "min", "max", "min_margin", "max_margin"), &VisualServer::instance_geometry_set_draw_range);
 	ClassDB::bind_method(D_METHOD("instance_geometry_set_as_instance_lod", "instance", "as_lod_of_instance"), &VisualServer::instance_geometry_set_as_instance_lod);
 
@@ -2145,6 +2146,12 @@ void VisualServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(INFO_VIDEO_MEM_USED);
 	BIND_ENUM_CONSTANT(INFO_TEXTURE_MEM_USED);
 	BIND_ENUM_CONSTANT(INFO_VERTEX_MEM_USED);
+	BIND_ENUM_CONSTANT(INFO_OCCLUDERS_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_OCCLUDED_OBJECTS_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_STATE_CHANGES_SKIPPED_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_UPLOAD_BYTES_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_UPLOAD_STALLS_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_SYNC_CALLS_IN_FRAME);
 
 	BIND_ENUM_CONSTANT(FEATURE_SHADERS);
 	BIND_ENUM_CONSTANT(FEATURE_MULTITHREADED);
@@ -2331,6 +2338,11 @@ VisualServer::VisualServer() {
 	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/filters/screen_space_roughness_limiter", PropertyInfo(Variant::INT, "rendering/quality/filters/screen_space_roughness_limiter", PROPERTY_HINT_ENUM, "Disabled,Enabled (Small Cost)"));
 	GLOBAL_DEF("rendering/quality/filters/screen_space_roughness_limiter_curve", 1.0);
 	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/filters/screen_space_roughness_limiter_curve", PropertyInfo(Variant::REAL, "rendering/quality/filters/screen_space_roughness_limiter_curve", PROPERTY_HINT_EXP_EASING, "0.01,8,0.01"));
+
+	GLOBAL_DEF_RST("rendering/occlusion_culling/max_occluders", 64);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/occlusion_culling/max_occluders", PropertyInfo(Variant::INT, "rendering/occlusion_culling/max_occluders", PROPERTY_HINT_RANGE, "0,1024,1"));
+	GLOBAL_DEF_RST("rendering/occlusion_culling/buffer_width", 256);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/occlusion_culling/buffer_width", PropertyInfo(Variant::INT, "rendering/occlusion_culling/buffer_width", PROPERTY_HINT_RANGE, "16,1024,1"));
 }
 
 VisualServer::~VisualServer() {
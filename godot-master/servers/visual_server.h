@@ -879,6 +879,7 @@ public:
 	virtual void instance_geometry_set_flag(RID p_instance, InstanceFlags p_flags, bool p_enabled) = 0;
 	virtual void instance_geometry_set_cast_shadows_setting(RID p_instance, ShadowCastingSetting p_shadow_casting_setting) = 0;
 	virtual void instance_geometry_set_material_override(RID p_instance, RID p_material) = 0;
+	virtual void instance_geometry_set_occluder_box(RID p_instance, const AABB &p_box) = 0;
 
 	virtual void instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin) = 0;
 	virtual void instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance) = 0;
@@ -1056,6 +1057,12 @@ public:
 		INFO_VIDEO_MEM_USED,
 		INFO_TEXTURE_MEM_USED,
 		INFO_VERTEX_MEM_USED,
+		INFO_OCCLUDERS_IN_FRAME,
+		INFO_OCCLUDED_OBJECTS_IN_FRAME,
+		INFO_STATE_CHANGES_SKIPPED_IN_FRAME,
+		INFO_UPLOAD_BYTES_IN_FRAME,
+		INFO_UPLOAD_STALLS_IN_FRAME,
+		INFO_SYNC_CALLS_IN_FRAME,
 	};
 
 	virtual int get_render_info(RenderInfo p_info) = 0;